@@ -0,0 +1,118 @@
+#include "ast_arena.h"
+
+#include <algorithm>
+#include <new>
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+constexpr size_t ALIGNMENT = alignof(max_align_t);
+
+// Заголовок перед каждым узлом: арена узла или nullptr для узла из общей кучи
+struct alignas(ALIGNMENT) NodeHeader {
+    Arena* arena;
+};
+
+constexpr size_t RoundUp(size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+// Арена, в которой размещаются узлы, создаваемые текущим потоком
+thread_local Arena* current_arena = nullptr;
+
+NodeHeader* HeaderOf(const void* node) {
+    return static_cast<NodeHeader*>(const_cast<void*>(node)) - 1;
+}
+
+}  // namespace
+
+const Arena* Arena::Of(const runtime::Executable* node) {
+    return HeaderOf(node)->arena;
+}
+
+size_t Arena::Footprint() const {
+    return footprint_;
+}
+
+void* Arena::Allocate(size_t size) {
+    size = RoundUp(size);
+    // крупный узел получает отдельный блок, чтобы не оставлять пустым остаток текущего
+    if (size > BLOCK_SIZE / 4) {
+        footprint_ += size;
+        return blocks_.emplace_back(new byte[size]).get();
+    }
+    if (static_cast<size_t>(end_ - next_) < size) {
+        const size_t block_size = max(next_block_size_, size);
+        next_ = blocks_.emplace_back(new byte[block_size]).get();
+        end_ = next_ + block_size;
+        footprint_ += block_size;
+        next_block_size_ = min(next_block_size_ * 2, BLOCK_SIZE);
+    }
+    void* result = next_;
+    next_ += size;
+    return result;
+}
+
+void Arena::AddRef() {
+    refs_.fetch_add(1, memory_order_relaxed);
+}
+
+void Arena::Release() {
+    if (refs_.fetch_sub(1, memory_order_acq_rel) == 1) {
+        delete this;
+    }
+}
+
+ArenaScope::ArenaScope()
+    : arena_(new Arena)
+    , previous_(current_arena) {
+    current_arena = arena_;
+}
+
+ArenaScope::ArenaScope(const Arena* arena)
+    : arena_(const_cast<Arena*>(arena))  // NOLINT
+    , previous_(current_arena) {
+    if (arena_ != nullptr) {
+        arena_->AddRef();
+    }
+    current_arena = arena_;
+}
+
+ArenaScope::~ArenaScope() {
+    current_arena = previous_;
+    if (arena_ != nullptr) {
+        arena_->Release();
+    }
+}
+
+}  // namespace ast
+
+namespace runtime {
+
+void* Executable::operator new(size_t size) {
+    ast::Arena* arena = ast::current_arena;
+    void* memory = arena != nullptr ? arena->Allocate(sizeof(ast::NodeHeader) + size)
+                                    : ::operator new(sizeof(ast::NodeHeader) + size);
+    auto* header = new (memory) ast::NodeHeader{arena};
+    if (arena != nullptr) {
+        arena->AddRef();
+    }
+    return header + 1;
+}
+
+void Executable::operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    ast::NodeHeader* header = ast::HeaderOf(ptr);
+    if (header->arena != nullptr) {
+        header->arena->Release();
+    } else {
+        ::operator delete(header);
+    }
+}
+
+}  // namespace runtime
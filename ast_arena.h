@@ -0,0 +1,80 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ast {
+
+/*
+ * Арена для узлов дерева программы. Узлы, созданные одним разбором, размещаются подряд
+ * в блоках памяти, поэтому обход дерева идёт по соседним адресам, а память всех
+ * узлов освобождается одним действием. Первый блок небольшой, каждый следующий вдвое
+ * больше предыдущего, но не больше BLOCK_SIZE, так что арена короткого разбора,
+ * например одной инструкции, занимает немного памяти.
+ *
+ * Арена считает размещённые в ней узлы и освобождает блоки вместе с последним из них,
+ * так что дерево программы, методы классов и отдельные инструкции (см. ParseStatements)
+ * могут жить сколько угодно долго. Удаление отдельного узла память не возвращает:
+ * она освобождается вместе с остальными узлами того же разбора
+ */
+class Arena {
+public:
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Возвращает арену, в которой размещён узел node, или nullptr для узла из общей кучи
+    [[nodiscard]] static const Arena* Of(const runtime::Executable* node);
+
+    // Возвращает объём памяти, занятый блоками арены
+    [[nodiscard]] size_t Footprint() const;
+
+    // Размер первого блока памяти арены и наибольший размер блока
+    static constexpr size_t FIRST_BLOCK_SIZE = 1024;
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+private:
+    friend class ArenaScope;
+    friend class runtime::Executable;
+
+    Arena() = default;
+    ~Arena() = default;
+
+    void* Allocate(size_t size);
+    void AddRef();
+    void Release();
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+    std::byte* next_ = nullptr;
+    std::byte* end_ = nullptr;
+    size_t next_block_size_ = FIRST_BLOCK_SIZE;
+    size_t footprint_ = 0;
+    // количество живых узлов и областей ArenaScope, использующих арену
+    std::atomic<size_t> refs_{1};
+};
+
+/*
+ * Пока объект существует, узлы, создаваемые в текущем потоке, размещаются в новой арене
+ * (либо в указанной при создании области).
+ * Области могут быть вложенными; по выходу из области восстанавливается прежняя арена
+ */
+class ArenaScope {
+public:
+    ArenaScope();
+    // Узлы размещаются в существующей арене arena, например при достраивании дерева,
+    // разобранного ранее. Если arena равен nullptr, узлы размещаются в общей куче
+    explicit ArenaScope(const Arena* arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* arena_;
+    Arena* previous_;
+};
+
+}  // namespace ast
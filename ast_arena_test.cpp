@@ -0,0 +1,115 @@
+#include "ast_arena.h"
+#include "lexer.h"
+#include "parse.h"
+#include "statement.h"
+#include "test_runner_p.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+ptrdiff_t Distance(const runtime::Executable* from, const runtime::Executable* to) {
+    return reinterpret_cast<const char*>(to) - reinterpret_cast<const char*>(from);
+}
+
+void TestNodesOutsideScopeUseHeap() {
+    auto node = make_unique<NumericConst>(runtime::Number(1));
+    ASSERT(Arena::Of(node.get()) == nullptr);
+}
+
+void TestNodesInScopeAreAdjacent() {
+    unique_ptr<Statement> first;
+    unique_ptr<Statement> second;
+    unique_ptr<Statement> inner;
+    {
+        ArenaScope scope;
+        first = make_unique<NumericConst>(runtime::Number(1));
+        second = make_unique<StringConst>(runtime::String("two"s));
+        {
+            ArenaScope nested;
+            inner = make_unique<NumericConst>(runtime::Number(3));
+        }
+        ASSERT(Arena::Of(first.get()) != nullptr);
+        ASSERT(Arena::Of(first.get()) == Arena::Of(second.get()));
+        ASSERT(Arena::Of(inner.get()) != Arena::Of(first.get()));
+
+        const ptrdiff_t distance = Distance(first.get(), second.get());
+        ASSERT(distance > 0);
+        ASSERT(distance <= static_cast<ptrdiff_t>(sizeof(NumericConst) + 2 * sizeof(max_align_t)));
+    }
+
+    // узлы остаются действительными после выхода из области
+    runtime::Closure closure;
+    runtime::DummyContext context;
+    ASSERT_EQUAL(first->Execute(closure, context).TryAs<runtime::Number>()->GetValue(), 1);
+    ASSERT_EQUAL(inner->Execute(closure, context).TryAs<runtime::Number>()->GetValue(), 3);
+    first.reset();
+    ASSERT_EQUAL(second->Execute(closure, context).TryAs<runtime::String>()->GetValue(), "two"s);
+}
+
+void TestBlocksGrowGeometrically() {
+    vector<unique_ptr<Statement>> nodes;
+    ArenaScope scope;
+    nodes.push_back(make_unique<NumericConst>(runtime::Number(0)));
+    const Arena* arena = Arena::Of(nodes.front().get());
+    // арена из одного узла занимает только первый блок
+    ASSERT_EQUAL(arena->Footprint(), Arena::FIRST_BLOCK_SIZE);
+
+    size_t blocks = 1;
+    size_t expected = Arena::FIRST_BLOCK_SIZE;
+    size_t last_block = Arena::FIRST_BLOCK_SIZE;
+    while (last_block < Arena::BLOCK_SIZE || blocks < 10) {
+        const size_t before = arena->Footprint();
+        while (arena->Footprint() == before) {
+            nodes.push_back(make_unique<NumericConst>(runtime::Number(1)));
+        }
+        last_block = min(last_block * 2, Arena::BLOCK_SIZE);
+        expected += last_block;
+        ++blocks;
+        ASSERT_EQUAL(arena->Footprint(), expected);
+    }
+}
+
+void TestParsedProgramIsAllocatedInArena() {
+    const string source = R"(
+class Counter:
+  def inc(n):
+    return n + 1
+
+c = Counter()
+print c.inc(41)
+)"s;
+    parse::Lexer lexer(string_view{source});
+    auto program = ParseProgram(lexer);
+    ASSERT(Arena::Of(program.get()) != nullptr);
+
+    runtime::Closure closure;
+    runtime::DummyContext context;
+    program->Execute(closure, context);
+    ASSERT_EQUAL(context.output.str(), "42\n"s);
+
+    // методы класса продолжают работать после удаления дерева программы
+    program.reset();
+    auto* counter = closure.at(runtime::Symbol("c"s)).TryAs<runtime::ClassInstance>();
+    auto result = counter->Call(runtime::Symbol("inc"s),
+                                {runtime::ObjectHolder::Own(runtime::Number(1))}, context);
+    ASSERT_EQUAL(result.TryAs<runtime::Number>()->GetValue(), 2);
+}
+
+}  // namespace
+
+void RunArenaTests(TestRunner& tr) {
+    RUN_TEST(tr, TestNodesOutsideScopeUseHeap);
+    RUN_TEST(tr, TestNodesInScopeAreAdjacent);
+    RUN_TEST(tr, TestBlocksGrowGeometrically);
+    RUN_TEST(tr, TestParsedProgramIsAllocatedInArena);
+}
+
+}  // namespace ast
@@ -0,0 +1,88 @@
+#include "ast_fold.h"
+
+#include "statement.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+bool IsMinusOne(const Statement& node) {
+    const auto* num = dynamic_cast<const NumericConst*>(&node);
+    return num && num->GetValue().GetValue() == -1;
+}
+
+// Возвращает константу со значением value либо nullptr, если у значения нет константы
+unique_ptr<Statement> MakeConstant(const runtime::ObjectHolder& value) {
+    if (!value) {
+        return make_unique<None>();
+    }
+    if (const auto* num = value.TryAs<runtime::Number>()) {
+        return make_unique<NumericConst>(*num);
+    }
+    if (const auto* str = value.TryAs<runtime::String>()) {
+        return make_unique<StringConst>(*str);
+    }
+    if (const auto* boolean = value.TryAs<runtime::Bool>()) {
+        return make_unique<BoolConst>(*boolean);
+    }
+    return nullptr;
+}
+
+// Вычисляет выражение над константами. Если при вычислении возникает ошибка любого
+// типа, возвращает node без изменений: ошибка будет выброшена при выполнении
+unique_ptr<Statement> Evaluate(unique_ptr<Statement> node) {
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    try {
+        if (auto constant = MakeConstant(node->Execute(closure, context))) {
+            return constant;
+        }
+    } catch (...) {
+    }
+    return node;
+}
+
+}  // namespace
+
+unique_ptr<Statement> FoldConstants(unique_ptr<Statement> node) {
+    if (auto* unary = dynamic_cast<UnaryOperation*>(node.get())) {
+        return IsConstant(unary->GetArgument()) ? Evaluate(std::move(node)) : std::move(node);
+    }
+    auto* binary = dynamic_cast<BinaryOperation*>(node.get());
+    if (!binary) {
+        return node;
+    }
+    Statement& lhs = binary->GetLhs();
+    Statement& rhs = binary->GetRhs();
+    if (IsConstant(lhs) && IsConstant(rhs)) {
+        return Evaluate(std::move(node));
+    }
+
+    const bool is_or = dynamic_cast<Or*>(binary) != nullptr;
+    if ((is_or || dynamic_cast<And*>(binary)) && IsConstant(lhs)) {
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        if (runtime::IsTrue(lhs.Execute(closure, context)) == is_or) {
+            return make_unique<BoolConst>(runtime::Bool(is_or));
+        }
+        return node;
+    }
+
+    if (dynamic_cast<Mult*>(binary)) {
+        // Константный операнд вычисляется без побочных эффектов, поэтому порядок
+        // вычисления операндов не важен
+        if (IsMinusOne(rhs)) {
+            return make_unique<Negate>(binary->ReleaseLhs());
+        }
+        if (IsMinusOne(lhs)) {
+            return make_unique<Negate>(binary->ReleaseRhs());
+        }
+    }
+    return node;
+}
+
+}  // namespace ast
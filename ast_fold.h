@@ -0,0 +1,22 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <memory>
+
+namespace ast {
+
+/*
+ * Упрощает узел выражения node, операнды которого уже упрощены:
+ *  - арифметика, сложение строк, сравнения, str, not, and и or над константами
+ *    заменяются константой с результатом, например 60 * 60 * 24 - числом 86400;
+ *  - and и or с константным левым операндом, определяющим результат, заменяются
+ *    константой, правый операнд при этом не вычислялся бы;
+ *  - умножение на -1 заменяется отрицанием ast::Negate.
+ * Операции, выполнение которых приводит к ошибке (например, деление на ноль), не
+ * вычисляются, чтобы ошибка возникла при выполнении программы.
+ * Возвращает node либо узел, которым его следует заменить
+ */
+std::unique_ptr<runtime::Executable> FoldConstants(std::unique_ptr<runtime::Executable> node);
+
+}  // namespace ast
@@ -0,0 +1,140 @@
+#include "ast_fold.h"
+#include "lexer.h"
+#include "parse.h"
+#include "statement.h"
+#include "test_runner_p.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+ParseOptions FoldingOptions() {
+    ParseOptions options;
+    options.fold_constants = true;
+    return options;
+}
+
+unique_ptr<Statement> ParseExpressionFromString(const string& source,
+                                                const ParseOptions& options = FoldingOptions()) {
+    parse::Lexer lexer(string_view{source});
+    return ParseExpression(lexer, options);
+}
+
+runtime::ObjectHolder Evaluate(Statement& node, runtime::Closure& closure) {
+    runtime::DummyContext context;
+    return node.Execute(closure, context);
+}
+
+void TestConstantExpressionsAreFolded() {
+    auto seconds = ParseExpressionFromString("60 * 60 * 24"s);
+    auto* num = dynamic_cast<NumericConst*>(seconds.get());
+    ASSERT(num != nullptr);
+    ASSERT_EQUAL(num->GetValue().GetValue(), 86400);
+
+    auto text = ParseExpressionFromString("'a' + str(12 - 2 * -3) + 'b'"s);
+    auto* str = dynamic_cast<StringConst*>(text.get());
+    ASSERT(str != nullptr);
+    ASSERT_EQUAL(str->GetValue().GetValue(), "a18b"s);
+
+    auto condition = ParseExpressionFromString("1 < 2 and not 'x' == 'y' or None"s);
+    auto* boolean = dynamic_cast<BoolConst*>(condition.get());
+    ASSERT(boolean != nullptr);
+    ASSERT(boolean->GetValue().GetValue());
+
+    // константа, определяющая результат and и or, заменяет всю операцию
+    auto shortcut = ParseExpressionFromString("False and x.missing()"s);
+    boolean = dynamic_cast<BoolConst*>(shortcut.get());
+    ASSERT(boolean != nullptr);
+    ASSERT(!boolean->GetValue().GetValue());
+    ASSERT(dynamic_cast<Or*>(ParseExpressionFromString("False or x"s).get()) != nullptr);
+
+    // константы в составе выражения тоже вычисляются
+    auto partial = ParseExpressionFromString("x + 2 * 3"s);
+    auto* add = dynamic_cast<Add*>(partial.get());
+    ASSERT(add != nullptr);
+    ASSERT(dynamic_cast<NumericConst*>(&add->GetRhs()) != nullptr);
+}
+
+void TestErrorsAreLeftForRuntime() {
+    runtime::Closure closure;
+    for (const string& source : {"1 / 0"s, "'a' + 1"s, "-'a'"s, "1 < None"s}) {
+        auto node = ParseExpressionFromString(source);
+        ASSERT(dynamic_cast<NumericConst*>(node.get()) == nullptr);
+        ASSERT_THROWS(Evaluate(*node, closure), runtime_error);
+    }
+
+    // ошибки любого типа, не только runtime_error, оставляются до выполнения
+    struct OutOfRange : UnaryOperation {
+        using UnaryOperation::UnaryOperation;
+
+        runtime::ObjectHolder Execute(runtime::Closure&, runtime::Context&) override {
+            throw out_of_range("out of range"s);
+        }
+    };
+    auto node = FoldConstants(make_unique<OutOfRange>(make_unique<NumericConst>(1)));
+    ASSERT(dynamic_cast<OutOfRange*>(node.get()) != nullptr);
+    ASSERT_THROWS(Evaluate(*node, closure), out_of_range);
+}
+
+void TestMultiplicationByMinusOneIsNegation() {
+    runtime::Closure closure;
+    closure[runtime::Symbol("x"s)] = runtime::ObjectHolder::Own(runtime::Number(5));
+
+    for (const string& source : {"-x"s, "x * -1"s, "-1 * x"s, "x * (0 - 1)"s}) {
+        auto node = ParseExpressionFromString(source);
+        ASSERT(dynamic_cast<Negate*>(node.get()) != nullptr);
+        ASSERT_EQUAL(Evaluate(*node, closure).TryAs<runtime::Number>()->GetValue(), -5);
+    }
+
+    closure[runtime::Symbol("x"s)] = runtime::ObjectHolder::Own(runtime::String("5"s));
+    ASSERT_THROWS(Evaluate(*ParseExpressionFromString("x * -1"s), closure), runtime_error);
+}
+
+void TestFoldingIsOptIn() {
+    // по умолчанию выражения над константами вычисляются при выполнении
+    auto node = ParseExpressionFromString("60 * 60"s, ParseOptions{});
+    ASSERT(dynamic_cast<Mult*>(node.get()) != nullptr);
+
+    runtime::Closure closure;
+    ASSERT_EQUAL(Evaluate(*node, closure).TryAs<runtime::Number>()->GetValue(), 3600);
+}
+
+void TestFoldedProgramPrintsTheSame() {
+    const string source = R"(
+class Clock:
+  def seconds(days):
+    return days * 60 * 60 * 24 * -1
+
+c = Clock()
+print c.seconds(2), 'a' + 'b' == 'ab', -(-3), not None, 7 / 2 * 2, str(None)
+)"s;
+    string outputs[2];
+    for (int fold = 0; fold < 2; ++fold) {
+        ParseOptions options;
+        options.fold_constants = fold != 0;
+        parse::Lexer lexer(string_view{source});
+        auto program = ParseProgram(lexer, options);
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        program->Execute(closure, context);
+        outputs[fold] = context.output.str();
+    }
+    ASSERT_EQUAL(outputs[0], "-172800 True 3 True 6 None\n"s);
+    ASSERT_EQUAL(outputs[1], outputs[0]);
+}
+
+}  // namespace
+
+void RunFoldTests(TestRunner& tr) {
+    RUN_TEST(tr, TestConstantExpressionsAreFolded);
+    RUN_TEST(tr, TestErrorsAreLeftForRuntime);
+    RUN_TEST(tr, TestMultiplicationByMinusOneIsNegation);
+    RUN_TEST(tr, TestFoldingIsOptIn);
+    RUN_TEST(tr, TestFoldedProgramPrintsTheSame);
+}
+
+}  // namespace ast
@@ -0,0 +1,81 @@
+#include "ast_fuse.h"
+
+#include "statement.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+// Возвращает true, если field - обращение к полю field_name объекта object
+bool IsFieldOf(const Statement& field, const VariableValue& object, runtime::Symbol field_name) {
+    const auto* value = dynamic_cast<const VariableValue*>(&field);
+    if (!value || value->GetSlot() != object.GetSlot() || value->GetName() != object.GetName()) {
+        return false;
+    }
+    const auto& ids = value->GetFieldIds();
+    const auto& object_ids = object.GetFieldIds();
+    return ids.size() == object_ids.size() + 1
+           && equal(object_ids.begin(), object_ids.end(), ids.begin())
+           && ids.back() == field_name;
+}
+
+unique_ptr<Statement> FuseFieldIncrement(unique_ptr<Statement> node, FieldAssignment& assignment) {
+    const auto* add = dynamic_cast<const Add*>(&assignment.GetValue());
+    if (!add || !IsFieldOf(add->GetLhs(), assignment.GetObject(), assignment.GetFieldName())) {
+        return node;
+    }
+    // вычисление константы или переменной не может изменить поля объекта
+    const Statement& increment = add->GetRhs();
+    if (!IsConstant(increment) && !dynamic_cast<const VariableValue*>(&increment)) {
+        return node;
+    }
+    node.release();
+    return make_unique<FieldIncrement>(unique_ptr<FieldAssignment>(&assignment));
+}
+
+unique_ptr<Statement> FuseIfFieldEquals(unique_ptr<Statement> node, IfElse& if_else) {
+    auto* condition = &if_else.GetCondition();
+    if (!dynamic_cast<OperatorComparison<ComparisonOp::EQUAL>*>(condition)
+        && !dynamic_cast<OperatorComparison<ComparisonOp::NOT_EQUAL>*>(condition)) {
+        return node;
+    }
+    const auto& comparison = static_cast<const Comparison&>(*condition);
+    const auto* field = dynamic_cast<const VariableValue*>(&comparison.GetLhs());
+    if (!field || field->GetFieldIds().empty() || !IsConstant(comparison.GetRhs())) {
+        return node;
+    }
+    node.release();
+    return make_unique<IfFieldEquals>(unique_ptr<IfElse>(&if_else));
+}
+
+unique_ptr<Statement> FuseMethodBody(unique_ptr<Statement> node, MethodBody& method_body) {
+    auto* compound = dynamic_cast<Compound*>(&method_body.GetBody());
+    if (method_body.GetResult() || !compound || compound->GetStatements().empty()
+        || !dynamic_cast<Return*>(compound->GetStatements().back().get())) {
+        return node;
+    }
+    auto last = compound->ReleaseLastStatement();
+    auto result = static_cast<Return&>(*last).ReleaseExpression();
+    return make_unique<MethodBody>(method_body.ReleaseBody(), std::move(result));
+}
+
+}  // namespace
+
+unique_ptr<Statement> FuseStatement(unique_ptr<Statement> node) {
+    if (auto* assignment = dynamic_cast<FieldAssignment*>(node.get())) {
+        return FuseFieldIncrement(std::move(node), *assignment);
+    }
+    if (auto* if_else = dynamic_cast<IfElse*>(node.get())) {
+        return FuseIfFieldEquals(std::move(node), *if_else);
+    }
+    if (auto* method_body = dynamic_cast<MethodBody*>(node.get())) {
+        return FuseMethodBody(std::move(node), *method_body);
+    }
+    return node;
+}
+
+}  // namespace ast
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <memory>
+
+namespace ast {
+
+/*
+ * Заменяет инструкцию node, части которой уже построены, объединённым узлом, если
+ * инструкция имеет один из распространённых видов:
+ *  - object.field = object.field + increment, где increment - константа или переменная,
+ *    заменяется ast::FieldIncrement;
+ *  - if object.field == constant (или !=) заменяется ast::IfFieldEquals;
+ *  - тело метода, последняя инструкция которого - return, заменяется телом,
+ *    вычисляющим результат без исключения (например, return self.m(a - 1)).
+ * Поведение программы при этом не меняется.
+ * Возвращает node либо узел, которым его следует заменить
+ */
+std::unique_ptr<runtime::Executable> FuseStatement(std::unique_ptr<runtime::Executable> node);
+
+}  // namespace ast
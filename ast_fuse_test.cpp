@@ -0,0 +1,139 @@
+#include "ast_fuse.h"
+#include "lexer.h"
+#include "parse.h"
+#include "statement.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+string RunProgram(const string& source, bool fuse) {
+    ParseOptions options;
+    options.fuse_statements = fuse;
+    parse::Lexer lexer(string_view{source});
+    auto program = ParseProgram(lexer, options);
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    program->Execute(closure, context);
+    return context.output.str();
+}
+
+unique_ptr<Statement> SelfField(const string& field) {
+    return make_unique<VariableValue>(vector<string>{"self"s, field});
+}
+
+void TestStatementsAreFused() {
+    auto increment = FuseStatement(make_unique<FieldAssignment>(
+        VariableValue{runtime::Symbol("self"s)}, runtime::Symbol("x"s),
+        make_unique<Add>(SelfField("x"s), make_unique<NumericConst>(1))));
+    ASSERT(dynamic_cast<FieldIncrement*>(increment.get()) != nullptr);
+
+    // правый операнд с возможными побочными эффектами и другое поле не объединяются
+    auto call = FuseStatement(make_unique<FieldAssignment>(
+        VariableValue{runtime::Symbol("self"s)}, runtime::Symbol("x"s),
+        make_unique<Add>(SelfField("x"s),
+                         make_unique<MethodCall>(
+                             make_unique<VariableValue>(runtime::Symbol("self"s)),
+                             runtime::Symbol("f"s),
+                                                 vector<unique_ptr<Statement>>{}))));
+    ASSERT(dynamic_cast<FieldAssignment*>(call.get()) != nullptr);
+    auto other = FuseStatement(make_unique<FieldAssignment>(
+        VariableValue{runtime::Symbol("self"s)}, runtime::Symbol("x"s),
+        make_unique<Add>(SelfField("y"s), make_unique<NumericConst>(1))));
+    ASSERT(dynamic_cast<FieldAssignment*>(other.get()) != nullptr);
+
+    auto test = FuseStatement(make_unique<IfElse>(
+        MakeComparison(ComparisonOp::NOT_EQUAL, SelfField("f"s), make_unique<StringConst>("a"s)),
+        make_unique<Compound>(), nullptr));
+    ASSERT(dynamic_cast<IfFieldEquals*>(test.get()) != nullptr);
+    auto less = FuseStatement(make_unique<IfElse>(
+        MakeComparison(ComparisonOp::LESS, SelfField("f"s), make_unique<NumericConst>(1)),
+        make_unique<Compound>(), nullptr));
+    ASSERT(dynamic_cast<IfElse*>(less.get()) != nullptr);
+
+    auto body = FuseStatement(make_unique<MethodBody>(make_unique<Compound>(
+        make_unique<Assignment>(runtime::Symbol("a"s), make_unique<NumericConst>(1)),
+        make_unique<Return>(make_unique<VariableValue>(runtime::Symbol("a"s))))));
+    auto* method_body = dynamic_cast<MethodBody*>(body.get());
+    ASSERT(method_body != nullptr && method_body->GetResult() != nullptr);
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    ASSERT_EQUAL(body->Execute(closure, context).TryAs<runtime::Number>()->GetValue(), 1);
+}
+
+void TestFusedProgramPrintsTheSame() {
+    const string source = R"(
+class Counter:
+  def __init__():
+    self.count = 0
+    self.name = 'c'
+    self.state = 'idle'
+
+  def tick(k):
+    self.count = self.count + 1
+    self.count = self.count + k
+    self.name = self.name + '!'
+    if self.state == 'idle':
+      self.state = 'busy'
+    else:
+      self.state = 'idle'
+    if self.count != 3:
+      return self.count
+    return 'three'
+
+  def down(a):
+    if a == 0:
+      return 0
+    return self.down(a - 1) + 1
+
+  def nothing():
+    self.count = self.count + 0
+
+class Money:
+  def __init__(v):
+    self.v = v
+
+  def __add__(amount):
+    return self.v + amount
+
+class Wallet:
+  def __init__():
+    self.money = Money(5)
+    self.flag = False
+
+  def add(x):
+    self.money = self.money + x
+    if self.flag == False:
+      self.flag = True
+    return self.money
+
+c = Counter()
+print c.tick(2), c.tick(0), c.count, c.name, c.state, c.down(50), c.nothing()
+w = Wallet()
+print w.add(3), w.add(4), w.flag
+)"s;
+    const string expected = "three 4 4 c!! idle 50 None\n8 12 True\n"s;
+    ASSERT_EQUAL(RunProgram(source, false), expected);
+    ASSERT_EQUAL(RunProgram(source, true), expected);
+
+    // при ошибках объединённые узлы ведут себя как исходные инструкции
+    for (const string& error : {"c = 1\nc.x = c.x + 1\n"s,
+                                "class A:\n  def f():\n    return 1\na = A()\na.x = a.x + 1\n"s,
+                                "class A:\n  def f():\n    return 1\na = A()\na.x = 'a'\n"
+                                "a.x = a.x + 1\n"s}) {
+        ASSERT_THROWS(RunProgram(error, false), runtime_error);
+        ASSERT_THROWS(RunProgram(error, true), runtime_error);
+    }
+}
+
+}  // namespace
+
+void RunFuseTests(TestRunner& tr) {
+    RUN_TEST(tr, TestStatementsAreFused);
+    RUN_TEST(tr, TestFusedProgramPrintsTheSame);
+}
+
+}  // namespace ast
@@ -0,0 +1,188 @@
+#include "ast_inline.h"
+
+#include "statement.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+const runtime::Symbol SELF{"self"s};
+
+bool IsSelf(const VariableValue& value) {
+    return !value.GetSlot() && value.GetSymbol() == SELF;
+}
+
+}  // namespace
+
+InlinedCall::InlinedCall(const runtime::Method& method, const runtime::Class& cls,
+                         const InlineLimits& limits)
+    : InlinedCall(method, cls, limits, 0) {
+}
+
+InlinedCall::InlinedCall(const runtime::Method& method, const runtime::Class& cls,
+                         const InlineLimits& limits, size_t forwarding_depth)
+    : method_(method) {
+    if (limits.max_body_nodes > 0) {
+        Analyze(cls, limits, forwarding_depth);
+    }
+    if (kind_ == Kind::NONE) {
+        fields_.clear();
+        arguments_.clear();
+    }
+}
+
+void InlinedCall::Analyze(const runtime::Class& cls, const InlineLimits& limits,
+                          size_t forwarding_depth) {
+    Statement* body = method_.body.get();
+    if (auto* lazy = dynamic_cast<LazyMethodBody*>(body)) {
+        body = &lazy->GetBody();
+    }
+    auto* method_body = dynamic_cast<MethodBody*>(body);
+    auto* compound = method_body ? dynamic_cast<Compound*>(&method_body->GetBody()) : nullptr;
+    if (!compound) {
+        return;
+    }
+    const auto& statements = compound->GetStatements();
+    if (Statement* result = method_body->GetResult()) {
+        if (statements.empty()) {
+            AnalyzeResult(*result, cls, limits, forwarding_depth);
+        }
+        return;
+    }
+    if (statements.size() != 1) {
+        return;
+    }
+    if (auto* return_statement = dynamic_cast<Return*>(statements.front().get())) {
+        AnalyzeResult(return_statement->GetExpression(), cls, limits, forwarding_depth);
+        return;
+    }
+
+    // self.поле... = параметр или константа
+    auto* assignment = dynamic_cast<FieldAssignment*>(statements.front().get());
+    if (!assignment || !IsSelf(assignment->GetObject())) {
+        return;
+    }
+    const auto& object_fields = assignment->GetObject().GetFieldIds();
+    if (object_fields.size() + 3 > limits.max_body_nodes || !AddArgument(assignment->GetValue())) {
+        return;
+    }
+    fields_ = object_fields;
+    fields_.push_back(assignment->GetFieldName());
+    kind_ = Kind::SETTER;
+}
+
+void InlinedCall::AnalyzeResult(Statement& result, const runtime::Class& cls,
+                                const InlineLimits& limits, size_t forwarding_depth) {
+    if (auto* value = dynamic_cast<VariableValue*>(&result)) {
+        const auto& ids = value->GetFieldIds();
+        if (IsSelf(*value) && !ids.empty() && ids.size() + 1 <= limits.max_body_nodes) {
+            fields_ = ids;
+            kind_ = Kind::GETTER;
+        } else if (ids.empty() && AddArgument(result)) {
+            kind_ = Kind::PARAMETER;
+        }
+        return;
+    }
+    if (IsConstant(result)) {
+        AddArgument(result);
+        kind_ = Kind::CONSTANT;
+        return;
+    }
+
+    // self.метод(параметры и константы)
+    auto* call = dynamic_cast<MethodCall*>(&result);
+    if (!call || forwarding_depth >= limits.max_forwarding_depth) {
+        return;
+    }
+    auto* object = dynamic_cast<VariableValue*>(&call->GetObject());
+    const auto& args = call->GetArgs();
+    if (!object || !IsSelf(*object) || !object->GetFieldIds().empty()
+        || args.size() + 2 > limits.max_body_nodes) {
+        return;
+    }
+    const runtime::Method* target = cls.GetMethod(call->GetMethod());
+    if (!target || target->formal_params.size() != args.size()) {
+        return;
+    }
+    for (const auto& arg : args) {
+        if (!AddArgument(*arg)) {
+            return;
+        }
+    }
+    target_.reset(new InlinedCall(*target, cls, limits, forwarding_depth + 1));
+    kind_ = Kind::FORWARD;
+}
+
+bool InlinedCall::AddArgument(Statement& node) {
+    if (IsConstant(node)) {
+        arguments_.push_back({Argument::CONSTANT, EvaluateConstant(node)});
+        return true;
+    }
+    const auto* value = dynamic_cast<const VariableValue*>(&node);
+    if (!value || value->GetSlot() || !value->GetFieldIds().empty() || IsSelf(*value)) {
+        return false;
+    }
+    const auto& params = method_.formal_params;
+    auto it = find(params.begin(), params.end(), value->GetSymbol());
+    if (it == params.end()) {
+        return false;
+    }
+    arguments_.push_back({static_cast<size_t>(it - params.begin()), {}});
+    return true;
+}
+
+runtime::ClassInstance* InlinedCall::FollowFields(runtime::ClassInstance& instance) const {
+    runtime::ClassInstance* owner = &instance;
+    for (size_t i = 0; i + 1 < fields_.size(); ++i) {
+        auto field = owner->Fields().find(fields_[i]);
+        if (field == owner->Fields().end()) {
+            return nullptr;
+        }
+        owner = field->second.TryAsExact<runtime::ClassInstance>();
+        if (!owner) {
+            return nullptr;
+        }
+    }
+    return owner;
+}
+
+runtime::ObjectHolder InlinedCall::Call(runtime::ClassInstance& instance,
+                                        const std::vector<runtime::ObjectHolder>& args,
+                                        runtime::Context& context) const {
+    switch (kind_) {
+        case Kind::CONSTANT:
+        case Kind::PARAMETER:
+            return arguments_.front().Get(args);
+        case Kind::GETTER:
+            if (auto* owner = FollowFields(instance)) {
+                auto field = owner->Fields().find(fields_.back());
+                if (field != owner->Fields().end()) {
+                    return field->second;
+                }
+            }
+            break;
+        case Kind::SETTER:
+            if (auto* owner = FollowFields(instance)) {
+                owner->Fields()[fields_.back()] = arguments_.front().Get(args);
+                return runtime::ObjectHolder::None();
+            }
+            break;
+        case Kind::FORWARD: {
+            std::vector<runtime::ObjectHolder> values;
+            values.reserve(arguments_.size());
+            for (const auto& argument : arguments_) {
+                values.push_back(argument.Get(args));
+            }
+            return target_->Call(instance, values, context);
+        }
+        case Kind::NONE:
+            break;
+    }
+    return instance.Call(method_, args, context);
+}
+
+}  // namespace ast
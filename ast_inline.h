@@ -0,0 +1,103 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ast {
+
+// Ограничения размера методов, которые встраиваются в место вызова (см. ast::InlinedCall)
+struct InlineLimits {
+    // Наибольшее количество узлов тела встраиваемого метода: обращение к переменной
+    // или константа - один узел, каждое поле в цепочке полей и каждый вызов - ещё один.
+    // Значение 0 отключает встраивание
+    size_t max_body_nodes = 8;
+    // Наибольшее количество пересылающих методов, встраиваемых друг в друга
+    size_t max_forwarding_depth = 3;
+};
+
+/*
+ * Метод класса, тело которого вызов выполняет сам, без таблицы параметров и исключения,
+ * которым из метода выходит инструкция return. Встраиваются небольшие методы вида:
+ *
+ * def get_x():          # CONSTANT, PARAMETER или GETTER
+ *   return self.x
+ * def set_x(value):     # SETTER
+ *   self.x = value
+ * def area(scale):      # FORWARD: вызов метода того же объекта с параметрами и константами
+ *   return self.compute(scale, 2)
+ *
+ * Результат действителен, пока не изменилось определение класса (см. Class::GetVersion).
+ * Если при выполнении объект не подходит для быстрого пути, например поле отсутствует,
+ * метод вызывается обычным образом, так что ошибки остаются прежними
+ */
+class InlinedCall {
+public:
+    enum class Kind : uint8_t {
+        NONE,       // метод не встраивается
+        CONSTANT,   // return константа
+        PARAMETER,  // return параметр
+        GETTER,     // return self.поле.поле...
+        SETTER,     // self.поле... = параметр или константа
+        FORWARD,    // return self.метод(параметры и константы)
+    };
+
+    // Анализирует метод method класса cls. Тело метода при этом разбирается,
+    // если его разбор был отложен
+    InlinedCall(const runtime::Method& method, const runtime::Class& cls,
+                const InlineLimits& limits);
+
+    // Вызывает метод у объекта instance класса, для которого он проанализирован.
+    // Количество аргументов должно совпадать с количеством параметров метода
+    runtime::ObjectHolder Call(runtime::ClassInstance& instance,
+                               const std::vector<runtime::ObjectHolder>& args,
+                               runtime::Context& context) const;
+
+    [[nodiscard]] Kind GetKind() const {
+        return kind_;
+    }
+
+    // Для FORWARD возвращает встроенный вызов метода, которому пересылается вызов
+    [[nodiscard]] const InlinedCall* GetTarget() const {
+        return target_.get();
+    }
+
+private:
+    // Значение параметра с номером parameter либо константа value
+    struct Argument {
+        static constexpr size_t CONSTANT = static_cast<size_t>(-1);
+
+        size_t parameter = CONSTANT;
+        runtime::ObjectHolder value;
+
+        [[nodiscard]] const runtime::ObjectHolder& Get(
+            const std::vector<runtime::ObjectHolder>& args) const {
+            return parameter == CONSTANT ? value : args[parameter];
+        }
+    };
+
+    InlinedCall(const runtime::Method& method, const runtime::Class& cls,
+                const InlineLimits& limits, size_t forwarding_depth);
+
+    void Analyze(const runtime::Class& cls, const InlineLimits& limits, size_t forwarding_depth);
+    // Разбирает выражение, значение которого возвращает метод
+    void AnalyzeResult(runtime::Executable& result, const runtime::Class& cls,
+                       const InlineLimits& limits, size_t forwarding_depth);
+    // Добавляет аргумент, если node - параметр метода или константа
+    bool AddArgument(runtime::Executable& node);
+
+    // Возвращает объект, которому принадлежит последнее поле цепочки fields_, либо nullptr,
+    // если объекты цепочки - не экземпляры пользовательских классов или поля отсутствуют
+    [[nodiscard]] runtime::ClassInstance* FollowFields(runtime::ClassInstance& instance) const;
+
+    const runtime::Method& method_;
+    Kind kind_ = Kind::NONE;
+    std::vector<runtime::Symbol> fields_;
+    // результат CONSTANT и PARAMETER, значение SETTER, аргументы FORWARD
+    std::vector<Argument> arguments_;
+    std::unique_ptr<InlinedCall> target_;
+};
+
+}  // namespace ast
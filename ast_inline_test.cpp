@@ -0,0 +1,214 @@
+#include "ast_inline.h"
+#include "lexer.h"
+#include "parse.h"
+#include "statement.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+const string CLASSES = R"(
+class Inner:
+  def __init__():
+    self.value = 7
+
+class Point:
+  def __init__(x):
+    self.x = x
+    self.inner = Inner()
+
+  def get_x():
+    return self.x
+
+  def get_inner_value():
+    return self.inner.value
+
+  def set_x(value):
+    self.x = value
+
+  def set_inner(value):
+    self.inner.value = value
+
+  def scale():
+    return 10
+
+  def same(value):
+    return value
+
+  def shift(dx, dy):
+    self.x = self.x + dx
+    return self.x + dy
+
+  def moved(dx):
+    return self.shift(dx, 1)
+
+  def moved_twice(dx):
+    return self.moved(dx)
+
+  def get_missing():
+    return self.missing
+
+p = Point(3)
+)"s;
+
+// Разбирает и выполняет объявления классов CLASSES, оставляя объект p в closure.
+// Узлы методов принадлежат возвращаемой программе
+unique_ptr<Statement> RunClasses(runtime::Closure& closure, runtime::Context& context) {
+    parse::Lexer lexer(string_view{CLASSES});
+    auto program = ParseProgram(lexer);
+    program->Execute(closure, context);
+    return program;
+}
+
+runtime::ObjectHolder Call(MethodCall& call, runtime::Closure& closure) {
+    runtime::DummyContext context;
+    return call.Execute(closure, context);
+}
+
+unique_ptr<MethodCall> MakeCall(const string& method, vector<unique_ptr<Statement>> args,
+                                InlineLimits limits = {}) {
+    return make_unique<MethodCall>(make_unique<VariableValue>(runtime::Symbol("p"s)),
+                                   runtime::Symbol(method), std::move(args),
+                                   limits);
+}
+
+int AsInt(const runtime::ObjectHolder& object) {
+    return object.TryAs<runtime::Number>()->GetValue();
+}
+
+void TestSmallMethodsAreInlined() {
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    auto program = RunClasses(closure, context);
+
+    const pair<string, InlinedCall::Kind> getters[] = {
+        {"get_x"s, InlinedCall::Kind::GETTER},
+        {"get_inner_value"s, InlinedCall::Kind::GETTER},
+        {"scale"s, InlinedCall::Kind::CONSTANT},
+    };
+    for (const auto& [method, kind] : getters) {
+        auto call = MakeCall(method, {});
+        Call(*call, closure);
+        ASSERT(call->GetInlinedCall()->GetKind() == kind);
+    }
+
+    vector<unique_ptr<Statement>> args;
+    args.push_back(make_unique<NumericConst>(5));
+    auto set_x = MakeCall("set_x"s, std::move(args));
+    ASSERT(!Call(*set_x, closure));
+    ASSERT(set_x->GetInlinedCall()->GetKind() == InlinedCall::Kind::SETTER);
+    auto get_x = MakeCall("get_x"s, {});
+    ASSERT_EQUAL(AsInt(Call(*get_x, closure)), 5);
+
+    args.push_back(make_unique<NumericConst>(8));
+    auto set_inner = MakeCall("set_inner"s, std::move(args));
+    Call(*set_inner, closure);
+    ASSERT(set_inner->GetInlinedCall()->GetKind() == InlinedCall::Kind::SETTER);
+    auto get_inner = MakeCall("get_inner_value"s, {});
+    ASSERT_EQUAL(AsInt(Call(*get_inner, closure)), 8);
+
+    args.push_back(make_unique<NumericConst>(4));
+    auto same = MakeCall("same"s, std::move(args));
+    ASSERT_EQUAL(AsInt(Call(*same, closure)), 4);
+    ASSERT(same->GetInlinedCall()->GetKind() == InlinedCall::Kind::PARAMETER);
+
+    // пересылающий метод встраивается, метод shift из двух инструкций - нет
+    args.push_back(make_unique<NumericConst>(2));
+    auto moved = MakeCall("moved_twice"s, std::move(args));
+    ASSERT_EQUAL(AsInt(Call(*moved, closure)), 8);
+    ASSERT_EQUAL(AsInt(Call(*get_x, closure)), 7);
+    const InlinedCall* inlined = moved->GetInlinedCall();
+    ASSERT(inlined->GetKind() == InlinedCall::Kind::FORWARD);
+    ASSERT(inlined->GetTarget()->GetKind() == InlinedCall::Kind::FORWARD);
+    ASSERT(inlined->GetTarget()->GetTarget()->GetKind() == InlinedCall::Kind::NONE);
+}
+
+void TestInliningLimits() {
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    auto program = RunClasses(closure, context);
+
+    InlineLimits small;
+    small.max_body_nodes = 2;
+    small.max_forwarding_depth = 1;
+    auto get_x = MakeCall("get_x"s, {}, small);
+    auto get_inner = MakeCall("get_inner_value"s, {}, small);
+    ASSERT_EQUAL(AsInt(Call(*get_x, closure)), 3);
+    ASSERT_EQUAL(AsInt(Call(*get_inner, closure)), 7);
+    ASSERT(get_x->GetInlinedCall()->GetKind() == InlinedCall::Kind::GETTER);
+    ASSERT(get_inner->GetInlinedCall()->GetKind() == InlinedCall::Kind::NONE);
+
+    small.max_body_nodes = 4;
+    vector<unique_ptr<Statement>> args;
+    args.push_back(make_unique<NumericConst>(1));
+    auto moved = MakeCall("moved_twice"s, std::move(args), small);
+    ASSERT_EQUAL(AsInt(Call(*moved, closure)), 5);
+    const InlinedCall* inlined = moved->GetInlinedCall();
+    ASSERT(inlined->GetKind() == InlinedCall::Kind::FORWARD);
+    ASSERT(inlined->GetTarget()->GetKind() == InlinedCall::Kind::NONE);
+
+    InlineLimits disabled;
+    disabled.max_body_nodes = 0;
+    auto scale = MakeCall("scale"s, {}, disabled);
+    ASSERT_EQUAL(AsInt(Call(*scale, closure)), 10);
+    ASSERT(scale->GetInlinedCall()->GetKind() == InlinedCall::Kind::NONE);
+}
+
+void TestInlinedMethodsFallBack() {
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    auto program = RunClasses(closure, context);
+
+    // ошибка встроенного метода совпадает с ошибкой обычного вызова
+    auto missing = MakeCall("get_missing"s, {});
+    ASSERT_THROWS(Call(*missing, closure), runtime_error);
+    ASSERT(missing->GetInlinedCall()->GetKind() == InlinedCall::Kind::GETTER);
+
+    // поле inner перестало быть объектом пользовательского класса
+    auto& fields = closure.at(runtime::Symbol("p"s)).TryAs<runtime::ClassInstance>()->Fields();
+    fields[runtime::Symbol("inner"s)] = runtime::ObjectHolder::Own(runtime::Number(1));
+    auto get_inner = MakeCall("get_inner_value"s, {});
+    ASSERT_THROWS(Call(*get_inner, closure), runtime_error);
+    vector<unique_ptr<Statement>> args;
+    args.push_back(make_unique<NumericConst>(8));
+    auto set_inner = MakeCall("set_inner"s, std::move(args));
+    ASSERT_THROWS(Call(*set_inner, closure), runtime_error);
+}
+
+void TestInlinedProgramPrintsTheSame() {
+    const string source = CLASSES + R"(
+print p.get_x(), p.scale(), p.same('s'), p.moved_twice(2), p.get_x()
+p.set_x('a')
+p.set_inner(p.get_x())
+print p.get_x(), p.get_inner_value()
+p.moved(-1)
+)"s;
+    string outputs[2];
+    for (int enabled = 0; enabled < 2; ++enabled) {
+        ParseOptions options;
+        options.inline_limits.max_body_nodes = enabled != 0 ? 8 : 0;
+        options.lazy_methods = enabled != 0;
+        parse::Lexer lexer(string_view{source});
+        auto program = ParseProgram(lexer, options);
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        ASSERT_THROWS(program->Execute(closure, context), runtime_error);
+        outputs[enabled] = context.output.str();
+    }
+    ASSERT_EQUAL(outputs[0], "3 10 s 6 5\na a\n"s);
+    ASSERT_EQUAL(outputs[1], outputs[0]);
+}
+
+}  // namespace
+
+void RunInlineTests(TestRunner& tr) {
+    RUN_TEST(tr, TestSmallMethodsAreInlined);
+    RUN_TEST(tr, TestInliningLimits);
+    RUN_TEST(tr, TestInlinedMethodsFallBack);
+    RUN_TEST(tr, TestInlinedProgramPrintsTheSame);
+}
+
+}  // namespace ast
@@ -0,0 +1,549 @@
+#include "batch.h"
+
+#include "compiled_program.h"
+#include "simd.h"
+#include "statement.h"
+
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+using runtime::ObjectHolder;
+using Kind = BatchColumn::Kind;
+
+// Операции над столбцами 32-битных чисел
+enum class Op { ADD, SUB, MUL, DIV, EQ, NE, LT, LE, GT, GE, AND, OR };
+
+int WrapAdd(int a, int b) {
+    return static_cast<int>(static_cast<unsigned>(a) + static_cast<unsigned>(b));
+}
+
+int WrapSub(int a, int b) {
+    return static_cast<int>(static_cast<unsigned>(a) - static_cast<unsigned>(b));
+}
+
+int WrapMul(int a, int b) {
+    return static_cast<int>(static_cast<unsigned>(a) * static_cast<unsigned>(b));
+}
+
+int ScalarApply(Op op, int a, int b) {
+    switch (op) {
+        case Op::ADD:
+            return WrapAdd(a, b);
+        case Op::SUB:
+            return WrapSub(a, b);
+        case Op::MUL:
+            return WrapMul(a, b);
+        case Op::DIV:
+            if (b == 0) {
+                throw runtime_error("Div operation. Divide by zero.");
+            }
+            return b == -1 ? WrapSub(0, a) : a / b;
+        case Op::EQ:
+            return a == b;
+        case Op::NE:
+            return a != b;
+        case Op::LT:
+            return a < b;
+        case Op::LE:
+            return a <= b;
+        case Op::GT:
+            return a > b;
+        case Op::GE:
+            return a >= b;
+        case Op::AND:
+            return a != 0 && b != 0;
+        case Op::OR:
+            return a != 0 || b != 0;
+    }
+    return 0;
+}
+
+#if defined(MYTHON_SIMD_AVX2)
+
+using Vec = __m256i;
+constexpr size_t LANES = 8;
+
+inline Vec Load(const int* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const Vec*>(p));
+}
+inline void Store(int* p, Vec v) {
+    _mm256_storeu_si256(reinterpret_cast<Vec*>(p), v);
+}
+inline Vec Set1(int v) {
+    return _mm256_set1_epi32(v);
+}
+inline Vec AddV(Vec a, Vec b) {
+    return _mm256_add_epi32(a, b);
+}
+inline Vec SubV(Vec a, Vec b) {
+    return _mm256_sub_epi32(a, b);
+}
+inline Vec MulV(Vec a, Vec b) {
+    return _mm256_mullo_epi32(a, b);
+}
+inline Vec EqV(Vec a, Vec b) {
+    return _mm256_cmpeq_epi32(a, b);
+}
+inline Vec GtV(Vec a, Vec b) {
+    return _mm256_cmpgt_epi32(a, b);
+}
+inline Vec AndV(Vec a, Vec b) {
+    return _mm256_and_si256(a, b);
+}
+inline Vec OrV(Vec a, Vec b) {
+    return _mm256_or_si256(a, b);
+}
+inline Vec XorV(Vec a, Vec b) {
+    return _mm256_xor_si256(a, b);
+}
+
+#elif defined(MYTHON_SIMD_SSE2)
+
+using Vec = __m128i;
+constexpr size_t LANES = 4;
+
+inline Vec Load(const int* p) {
+    return _mm_loadu_si128(reinterpret_cast<const Vec*>(p));
+}
+inline void Store(int* p, Vec v) {
+    _mm_storeu_si128(reinterpret_cast<Vec*>(p), v);
+}
+inline Vec Set1(int v) {
+    return _mm_set1_epi32(v);
+}
+inline Vec AddV(Vec a, Vec b) {
+    return _mm_add_epi32(a, b);
+}
+inline Vec SubV(Vec a, Vec b) {
+    return _mm_sub_epi32(a, b);
+}
+// В SSE2 нет умножения 32-битных дорожек: чётные и нечётные дорожки умножаются отдельно
+inline Vec MulV(Vec a, Vec b) {
+    const Vec even = _mm_mul_epu32(a, b);
+    const Vec odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+inline Vec EqV(Vec a, Vec b) {
+    return _mm_cmpeq_epi32(a, b);
+}
+inline Vec GtV(Vec a, Vec b) {
+    return _mm_cmpgt_epi32(a, b);
+}
+inline Vec AndV(Vec a, Vec b) {
+    return _mm_and_si128(a, b);
+}
+inline Vec OrV(Vec a, Vec b) {
+    return _mm_or_si128(a, b);
+}
+inline Vec XorV(Vec a, Vec b) {
+    return _mm_xor_si128(a, b);
+}
+
+#endif
+
+#if defined(MYTHON_SIMD_AVX2) || defined(MYTHON_SIMD_SSE2)
+
+// Векторная версия операции. Маски сравнений (0 или -1) приводятся к 0 или 1
+inline Vec VectorApply(Op op, Vec a, Vec b) {
+    const Vec ones = Set1(-1);
+    const Vec one = Set1(1);
+    const Vec zero = Set1(0);
+    switch (op) {
+        case Op::ADD:
+            return AddV(a, b);
+        case Op::SUB:
+            return SubV(a, b);
+        case Op::MUL:
+            return MulV(a, b);
+        case Op::EQ:
+            return AndV(EqV(a, b), one);
+        case Op::NE:
+            return AndV(XorV(EqV(a, b), ones), one);
+        case Op::LT:
+            return AndV(GtV(b, a), one);
+        case Op::LE:
+            return AndV(XorV(GtV(a, b), ones), one);
+        case Op::GT:
+            return AndV(GtV(a, b), one);
+        case Op::GE:
+            return AndV(XorV(GtV(b, a), ones), one);
+        case Op::AND:
+            return AndV(AndV(XorV(EqV(a, zero), ones), XorV(EqV(b, zero), ones)), one);
+        case Op::OR:
+            return AndV(XorV(AndV(EqV(a, zero), EqV(b, zero)), ones), one);
+        case Op::DIV:
+            break;
+    }
+    return zero;
+}
+
+#endif
+
+void ApplyColumns(Op op, const int* a, const int* b, int* out, size_t size) {
+    size_t i = 0;
+#if defined(MYTHON_SIMD_AVX2) || defined(MYTHON_SIMD_SSE2)
+    // Целочисленного деления в SSE2/AVX2 нет
+    if (op != Op::DIV) {
+        for (; i + LANES <= size; i += LANES) {
+            Store(out + i, VectorApply(op, Load(a + i), Load(b + i)));
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        out[i] = ScalarApply(op, a[i], b[i]);
+    }
+}
+
+void NotColumn(const int* a, int* out, size_t size) {
+    size_t i = 0;
+#if defined(MYTHON_SIMD_AVX2) || defined(MYTHON_SIMD_SSE2)
+    const Vec zero = Set1(0);
+    const Vec one = Set1(1);
+    for (; i + LANES <= size; i += LANES) {
+        Store(out + i, AndV(EqV(Load(a + i), zero), one));
+    }
+#endif
+    for (; i < size; ++i) {
+        out[i] = a[i] == 0;
+    }
+}
+
+// Определяет операцию сравнения узла ast::Comparison. Сравнения, заданные
+// произвольной функцией, вычисляются общим путём
+std::optional<Op> ComparisonOp(const ast::Comparison& comparison) {
+    const auto op = comparison.GetOperator();
+    if (!op) {
+        return std::nullopt;
+    }
+    switch (*op) {
+        case ast::ComparisonOp::EQUAL:
+            return Op::EQ;
+        case ast::ComparisonOp::NOT_EQUAL:
+            return Op::NE;
+        case ast::ComparisonOp::LESS:
+            return Op::LT;
+        case ast::ComparisonOp::LESS_OR_EQUAL:
+            return Op::LE;
+        case ast::ComparisonOp::GREATER:
+            return Op::GT;
+        case ast::ComparisonOp::GREATER_OR_EQUAL:
+            return Op::GE;
+    }
+    return std::nullopt;
+}
+
+std::optional<Op> ArithmeticOp(ast::Statement& node) {
+    if (dynamic_cast<ast::Add*>(&node)) {
+        return Op::ADD;
+    }
+    if (dynamic_cast<ast::Sub*>(&node)) {
+        return Op::SUB;
+    }
+    if (dynamic_cast<ast::Mult*>(&node)) {
+        return Op::MUL;
+    }
+    if (dynamic_cast<ast::Div*>(&node)) {
+        return Op::DIV;
+    }
+    return std::nullopt;
+}
+
+class BatchEvaluator {
+public:
+    BatchEvaluator(const vector<BatchColumn>& inputs, size_t rows, runtime::Context& context)
+        : inputs_(inputs)
+        , rows_(rows)
+        , context_(context) {
+    }
+
+    BatchColumn Evaluate(ast::Statement& node) {
+        if (Classify(node) != Kind::OBJECT) {
+            return EvaluateVector(node);
+        }
+        auto* logical = dynamic_cast<ast::BinaryOperation*>(&node);
+        const bool is_and = dynamic_cast<ast::And*>(&node) != nullptr;
+        const bool is_or = dynamic_cast<ast::Or*>(&node) != nullptr;
+        if ((is_and || is_or) && Classify(logical->GetLhs()) != Kind::OBJECT) {
+            return EvaluateShortCircuit(logical->GetLhs(), logical->GetRhs(), is_and);
+        }
+        return EvaluatePerRow(node);
+    }
+
+private:
+    // Тип результата узла, если узел вычисляется целиком по столбцам, иначе OBJECT
+    Kind Classify(ast::Statement& node) {
+        if (auto it = kinds_.find(&node); it != kinds_.end()) {
+            return it->second;
+        }
+        Kind kind = ClassifyImpl(node);
+        kinds_[&node] = kind;
+        return kind;
+    }
+
+    Kind ClassifyImpl(ast::Statement& node) {
+        if (dynamic_cast<ast::NumericConst*>(&node)) {
+            return Kind::INT;
+        }
+        if (dynamic_cast<ast::BoolConst*>(&node)) {
+            return Kind::BOOL;
+        }
+        if (auto* var = dynamic_cast<ast::VariableValue*>(&node)) {
+            auto slot = var->GetSlot();
+            if (!slot || !var->GetFieldIds().empty()) {
+                return Kind::OBJECT;
+            }
+            return inputs_.at(*slot).GetKind();
+        }
+        if (ArithmeticOp(node)) {
+            auto& binary = static_cast<ast::BinaryOperation&>(node);
+            return Classify(binary.GetLhs()) == Kind::INT && Classify(binary.GetRhs()) == Kind::INT
+                       ? Kind::INT
+                       : Kind::OBJECT;
+        }
+        if (auto* comparison = dynamic_cast<ast::Comparison*>(&node)) {
+            const Kind lhs = Classify(comparison->GetLhs());
+            const Kind rhs = Classify(comparison->GetRhs());
+            return ComparisonOp(*comparison) && lhs != Kind::OBJECT && lhs == rhs ? Kind::BOOL
+                                                                                  : Kind::OBJECT;
+        }
+        if (dynamic_cast<ast::And*>(&node) || dynamic_cast<ast::Or*>(&node)) {
+            auto& binary = static_cast<ast::BinaryOperation&>(node);
+            // Правый операнд вычисляется не для всех строк, поэтому он не должен
+            // выбрасывать исключений (деление на ноль)
+            return Classify(binary.GetLhs()) != Kind::OBJECT
+                           && Classify(binary.GetRhs()) != Kind::OBJECT
+                           && !ContainsDiv(binary.GetRhs())
+                       ? Kind::BOOL
+                       : Kind::OBJECT;
+        }
+        if (auto* not_op = dynamic_cast<ast::Not*>(&node)) {
+            return Classify(not_op->GetArgument()) != Kind::OBJECT ? Kind::BOOL : Kind::OBJECT;
+        }
+        if (auto* negate = dynamic_cast<ast::Negate*>(&node)) {
+            return Classify(negate->GetArgument()) == Kind::INT ? Kind::INT : Kind::OBJECT;
+        }
+        return Kind::OBJECT;
+    }
+
+    // Проверяет, содержит ли векторизуемое поддерево деление
+    bool ContainsDiv(ast::Statement& node) {
+        if (dynamic_cast<ast::Div*>(&node)) {
+            return true;
+        }
+        if (auto* binary = dynamic_cast<ast::BinaryOperation*>(&node)) {
+            return ContainsDiv(binary->GetLhs()) || ContainsDiv(binary->GetRhs());
+        }
+        if (auto* unary = dynamic_cast<ast::UnaryOperation*>(&node)) {
+            return ContainsDiv(unary->GetArgument());
+        }
+        return false;
+    }
+
+    // Вычисляет узел, для которого Classify вернул INT или BOOL
+    BatchColumn EvaluateVector(ast::Statement& node) {
+        if (auto* num = dynamic_cast<ast::NumericConst*>(&node)) {
+            return BatchColumn::FromInts(vector<int>(rows_, num->GetValue().GetValue()));
+        }
+        if (auto* boolean = dynamic_cast<ast::BoolConst*>(&node)) {
+            return BatchColumn::FromBools(vector<bool>(rows_, boolean->GetValue().GetValue()));
+        }
+        if (auto* var = dynamic_cast<ast::VariableValue*>(&node)) {
+            return inputs_.at(*var->GetSlot());
+        }
+        if (auto* not_op = dynamic_cast<ast::Not*>(&node)) {
+            auto argument = EvaluateVector(not_op->GetArgument());
+            vector<int> result(rows_);
+            NotColumn(argument.GetInts().data(), result.data(), rows_);
+            return MakeColumn(Kind::BOOL, std::move(result));
+        }
+        if (auto* negate = dynamic_cast<ast::Negate*>(&node)) {
+            auto argument = EvaluateVector(negate->GetArgument());
+            const vector<int> zeros(rows_);
+            vector<int> result(rows_);
+            ApplyColumns(Op::SUB, zeros.data(), argument.GetInts().data(), result.data(), rows_);
+            return MakeColumn(Kind::INT, std::move(result));
+        }
+
+        auto& binary = static_cast<ast::BinaryOperation&>(node);
+        Op op = Op::AND;
+        Kind kind = Kind::BOOL;
+        if (auto arithmetic = ArithmeticOp(node)) {
+            op = *arithmetic;
+            kind = Kind::INT;
+        } else if (auto* comparison = dynamic_cast<ast::Comparison*>(&node)) {
+            op = *ComparisonOp(*comparison);
+        } else if (dynamic_cast<ast::Or*>(&node)) {
+            op = Op::OR;
+        }
+        auto lhs = EvaluateVector(binary.GetLhs());
+        auto rhs = EvaluateVector(binary.GetRhs());
+        vector<int> result(rows_);
+        ApplyColumns(op, lhs.GetInts().data(), rhs.GetInts().data(), result.data(), rows_);
+        return MakeColumn(kind, std::move(result));
+    }
+
+    // and/or с векторизуемым левым операндом: правый операнд интерпретируется
+    // только в строках, где левого операнда недостаточно для результата
+    BatchColumn EvaluateShortCircuit(ast::Statement& lhs, ast::Statement& rhs, bool is_and) {
+        auto lhs_column = EvaluateVector(lhs);
+        const auto& lhs_values = lhs_column.GetInts();
+        vector<int> result(rows_);
+        for (size_t row = 0; row < rows_; ++row) {
+            const bool lhs_true = lhs_values[row] != 0;
+            if (lhs_true != is_and) {
+                result[row] = lhs_true;
+            } else {
+                result[row] = runtime::IsTrue(EvaluateRow(rhs, row));
+            }
+        }
+        return MakeColumn(Kind::BOOL, std::move(result));
+    }
+
+    BatchColumn EvaluatePerRow(ast::Statement& node) {
+        vector<ObjectHolder> result;
+        result.reserve(rows_);
+        for (size_t row = 0; row < rows_; ++row) {
+            result.push_back(EvaluateRow(node, row));
+        }
+        return BatchColumn::FromObjects(std::move(result));
+    }
+
+    ObjectHolder EvaluateRow(ast::Statement& node, size_t row) {
+        row_slots_.clear();
+        for (const auto& input : inputs_) {
+            row_slots_.push_back(input.At(row));
+        }
+        runtime::SlotContext slot_context(context_, row_slots_.data());
+        return node.Execute(closure_, slot_context);
+    }
+
+    static BatchColumn MakeColumn(Kind kind, vector<int> values) {
+        if (kind == Kind::INT) {
+            return BatchColumn::FromInts(std::move(values));
+        }
+        return BatchColumn::FromBoolMask(std::move(values));
+    }
+
+    const vector<BatchColumn>& inputs_;
+    size_t rows_;
+    runtime::Context& context_;
+    runtime::Closure closure_;
+    vector<ObjectHolder> row_slots_;
+    unordered_map<const ast::Statement*, Kind> kinds_;
+};
+
+// Если все значения - числа или все - логические значения, переводит столбец в INT или BOOL
+BatchColumn Narrow(BatchColumn column) {
+    if (column.GetKind() != Kind::OBJECT) {
+        return column;
+    }
+    const auto& objects = column.GetObjects();
+    vector<int> values;
+    values.reserve(objects.size());
+    bool all_numbers = true;
+    bool all_bools = true;
+    for (const auto& object : objects) {
+        if (auto p = object.TryAs<runtime::Number>()) {
+            all_bools = false;
+            values.push_back(p->GetValue());
+        } else if (auto p = object.TryAs<runtime::Bool>()) {
+            all_numbers = false;
+            values.push_back(p->GetValue());
+        } else {
+            return column;
+        }
+        if (!all_numbers && !all_bools) {
+            return column;
+        }
+    }
+    if (all_numbers) {
+        return BatchColumn::FromInts(std::move(values));
+    }
+    return BatchColumn::FromBoolMask(std::move(values));
+}
+
+}  // namespace
+
+BatchColumn::BatchColumn(Kind kind, std::shared_ptr<const std::vector<int>> ints,
+                         std::shared_ptr<const std::vector<runtime::ObjectHolder>> objects)
+    : kind_(kind)
+    , ints_(std::move(ints))
+    , objects_(std::move(objects)) {
+}
+
+BatchColumn BatchColumn::FromInts(std::vector<int> values) {
+    return BatchColumn(Kind::INT, make_shared<const vector<int>>(std::move(values)), nullptr);
+}
+
+BatchColumn BatchColumn::FromBools(const std::vector<bool>& values) {
+    return BatchColumn(Kind::BOOL, make_shared<const vector<int>>(values.begin(), values.end()),
+                       nullptr);
+}
+
+BatchColumn BatchColumn::FromBoolMask(std::vector<int> values) {
+    return BatchColumn(Kind::BOOL, make_shared<const vector<int>>(std::move(values)), nullptr);
+}
+
+BatchColumn BatchColumn::FromObjects(std::vector<runtime::ObjectHolder> values) {
+    return BatchColumn(Kind::OBJECT, nullptr,
+                       make_shared<const vector<ObjectHolder>>(std::move(values)));
+}
+
+BatchColumn::Kind BatchColumn::GetKind() const {
+    return kind_;
+}
+
+size_t BatchColumn::Size() const {
+    return kind_ == Kind::OBJECT ? objects_->size() : ints_->size();
+}
+
+const std::vector<int>& BatchColumn::GetInts() const {
+    if (kind_ == Kind::OBJECT) {
+        throw logic_error("BatchColumn. Column holds objects");
+    }
+    return *ints_;
+}
+
+const std::vector<runtime::ObjectHolder>& BatchColumn::GetObjects() const {
+    if (kind_ != Kind::OBJECT) {
+        throw logic_error("BatchColumn. Column holds unboxed values");
+    }
+    return *objects_;
+}
+
+runtime::ObjectHolder BatchColumn::At(size_t row) const {
+    switch (kind_) {
+        case Kind::INT:
+            return ObjectHolder::Own(runtime::Number(ints_->at(row)));
+        case Kind::BOOL:
+            return ObjectHolder::Own(runtime::Bool(ints_->at(row) != 0));
+        case Kind::OBJECT:
+            break;
+    }
+    return objects_->at(row);
+}
+
+BatchColumn EvaluateBatch(const CompiledProgram& expression, const std::vector<BatchColumn>& inputs,
+                          runtime::Context& context) {
+    if (!expression.IsExpression()) {
+        throw invalid_argument("Batch evaluation requires a compiled expression"s);
+    }
+    if (inputs.size() != expression.GetSlotCount()) {
+        throw invalid_argument("Expected "s + to_string(expression.GetSlotCount())
+                               + " input columns, got "s + to_string(inputs.size()));
+    }
+    const size_t rows = inputs.empty() ? 1 : inputs.front().Size();
+    for (const auto& column : inputs) {
+        if (column.Size() != rows) {
+            throw invalid_argument("Input columns have different sizes"s);
+        }
+    }
+    BatchEvaluator evaluator(inputs, rows, context);
+    return Narrow(evaluator.Evaluate(expression.GetRoot()));
+}
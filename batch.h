@@ -0,0 +1,63 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <memory>
+#include <vector>
+
+class CompiledProgram;
+
+// Столбец значений для пакетного выполнения выражения
+class BatchColumn {
+public:
+    enum class Kind {
+        INT,     // числа, хранятся без упаковки
+        BOOL,    // логические значения, хранятся как 0 и 1
+        OBJECT,  // произвольные объекты Mython
+    };
+
+    // Создаёт столбец чисел
+    static BatchColumn FromInts(std::vector<int> values);
+    // Создаёт столбец логических значений
+    static BatchColumn FromBools(const std::vector<bool>& values);
+    // Создаёт столбец логических значений из значений 0 (False) и 1 (True)
+    static BatchColumn FromBoolMask(std::vector<int> values);
+    // Создаёт столбец произвольных объектов
+    static BatchColumn FromObjects(std::vector<runtime::ObjectHolder> values);
+
+    [[nodiscard]] Kind GetKind() const;
+    [[nodiscard]] size_t Size() const;
+
+    // Возвращает значения столбца INT или BOOL
+    [[nodiscard]] const std::vector<int>& GetInts() const;
+    // Возвращает значения столбца OBJECT
+    [[nodiscard]] const std::vector<runtime::ObjectHolder>& GetObjects() const;
+    // Возвращает значение строки row в виде объекта Mython
+    [[nodiscard]] runtime::ObjectHolder At(size_t row) const;
+
+private:
+    BatchColumn(Kind kind, std::shared_ptr<const std::vector<int>> ints,
+                std::shared_ptr<const std::vector<runtime::ObjectHolder>> objects);
+
+    Kind kind_;
+    // Данные разделяются между копиями столбца, чтобы входные столбцы не копировались
+    std::shared_ptr<const std::vector<int>> ints_;
+    std::shared_ptr<const std::vector<runtime::ObjectHolder>> objects_;
+};
+
+/*
+ * Вычисляет скомпилированное выражение expression для каждой строки входных столбцов inputs.
+ * Столбец inputs[i] содержит значения входной переменной со слотом i; все столбцы должны
+ * иметь одинаковую длину.
+ *
+ * Поддеревья, состоящие из констант и входных переменных-чисел или логических значений,
+ * соединённых операциями +, -, *, /, сравнения, and, or и not, вычисляются целиком по
+ * столбцам векторными инструкциями. Остальные поддеревья (объекты, поля, вызовы методов)
+ * выполняются интерпретатором построчно, причём правый операнд and/or вычисляется только
+ * для строк, в которых его значение требуется.
+ *
+ * Результат - столбец INT или BOOL, если все значения - числа или логические значения,
+ * иначе столбец OBJECT. Ошибки выполнения приводят к исключению runtime_error
+ */
+BatchColumn EvaluateBatch(const CompiledProgram& expression, const std::vector<BatchColumn>& inputs,
+                          runtime::Context& context);
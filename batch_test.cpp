@@ -0,0 +1,99 @@
+#include "batch.h"
+#include "compiled_program.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace {
+
+// Вычисляет выражение построчно интерпретатором и сравнивает с пакетным результатом
+void AssertBatchMatchesRows(const string& source, const vector<string>& names,
+                            const vector<BatchColumn>& inputs) {
+    auto expression = CompiledProgram::CompileExpression(source, names);
+    runtime::DummyContext context;
+    auto batch = EvaluateBatch(expression, inputs, context);
+
+    const size_t rows = inputs.front().Size();
+    ASSERT_EQUAL(batch.Size(), rows);
+    for (size_t row = 0; row < rows; ++row) {
+        vector<runtime::ObjectHolder> bindings;
+        for (const auto& input : inputs) {
+            bindings.push_back(input.At(row));
+        }
+        auto expected = expression.Evaluate(bindings, context);
+        AssertEqual(runtime::Equal(batch.At(row), expected, context), true,
+                    source + " row "s + to_string(row));
+    }
+}
+
+void TestVectorizedArithmetic() {
+    vector<int> a;
+    vector<int> b;
+    vector<bool> flags;
+    for (int i = 0; i < 37; ++i) {
+        a.push_back(i * 7 - 100);
+        b.push_back((i % 5) + 1);
+        flags.push_back(i % 3 == 0);
+    }
+    vector<BatchColumn> inputs = {BatchColumn::FromInts(a), BatchColumn::FromInts(b),
+                                  BatchColumn::FromBools(flags)};
+    const vector<string> names = {"a"s, "b"s, "f"s};
+
+    for (const string& source :
+         {"a + b * 3"s, "a - b"s, "a * b * -1"s, "-a + b"s, "a / b"s, "(a + 1) * (b - 2)"s}) {
+        AssertBatchMatchesRows(source, names, inputs);
+    }
+    for (const string& source :
+         {"a < b"s, "a <= 0"s, "a > b * 10"s, "a >= -30"s, "a == 5"s, "a != b"s,
+          "a > 0 and b < 3 or f"s, "not f and not a == 2"s, "f == True"s}) {
+        AssertBatchMatchesRows(source, names, inputs);
+    }
+
+    auto expression = CompiledProgram::CompileExpression("a * 2 > b"s, names);
+    runtime::DummyContext context;
+    auto result = EvaluateBatch(expression, inputs, context);
+    ASSERT(result.GetKind() == BatchColumn::Kind::BOOL);
+}
+
+void TestFallbackForObjects() {
+    vector<runtime::ObjectHolder> names;
+    for (const char* name : {"ann", "bob", "christopher", ""}) {
+        names.push_back(runtime::ObjectHolder::Own(runtime::String(name)));
+    }
+    vector<BatchColumn> inputs = {BatchColumn::FromObjects(names),
+                                  BatchColumn::FromInts({1, 2, 3, 4})};
+    const vector<string> vars = {"name"s, "n"s};
+
+    AssertBatchMatchesRows("name + '!'"s, vars, inputs);
+    AssertBatchMatchesRows("len(name) > n * 2"s, vars, inputs);
+    AssertBatchMatchesRows("n > 1 and len(name) > 3"s, vars, inputs);
+
+    auto expression = CompiledProgram::CompileExpression("str(n) + name"s, vars);
+    runtime::DummyContext context;
+    auto result = EvaluateBatch(expression, inputs, context);
+    ASSERT(result.GetKind() == BatchColumn::Kind::OBJECT);
+    ASSERT_EQUAL(result.GetObjects().size(), 4U);
+}
+
+void TestShortCircuitIsPreserved() {
+    vector<BatchColumn> inputs = {BatchColumn::FromInts({0, 2, 0, 5}),
+                                  BatchColumn::FromInts({0, 1, 0, 5})};
+    const vector<string> vars = {"a"s, "b"s};
+    runtime::DummyContext context;
+
+    // Правый операнд не вычисляется в строках, где b == 0
+    auto guarded = CompiledProgram::CompileExpression("b != 0 and a / b > 1"s, vars);
+    auto result = EvaluateBatch(guarded, inputs, context);
+    ASSERT_EQUAL(result.GetInts(), (vector<int>{0, 1, 0, 0}));
+
+    auto unguarded = CompiledProgram::CompileExpression("a / b"s, vars);
+    ASSERT_THROWS(EvaluateBatch(unguarded, inputs, context), runtime_error);
+}
+
+}  // namespace
+
+void TestBatchEvaluation(TestRunner& tr) {
+    RUN_TEST(tr, TestVectorizedArithmetic);
+    RUN_TEST(tr, TestFallbackForObjects);
+    RUN_TEST(tr, TestShortCircuitIsPreserved);
+}
@@ -0,0 +1,73 @@
+#include "builtins.h"
+
+#include "int_array.h"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+
+namespace runtime {
+
+namespace {
+
+ObjectHolder Len(const vector<ObjectHolder>& args, Context& /*context*/) {
+    if (auto p = args[0].TryAs<String>()) {
+        return ObjectHolder::Own(Number(static_cast<int>(p->GetValue().size())));
+    }
+    if (auto p = args[0].TryAs<IntArray>()) {
+        return ObjectHolder::Own(Number(static_cast<int>(p->Size())));
+    }
+    throw runtime_error("len. Invalid argument"s);
+}
+
+ObjectHolder Abs(const vector<ObjectHolder>& args, Context& /*context*/) {
+    if (auto p = args[0].TryAs<Number>()) {
+        return ObjectHolder::Own(Number(std::abs(p->GetValue())));
+    }
+    throw runtime_error("abs. Invalid argument"s);
+}
+
+ObjectHolder Min(const vector<ObjectHolder>& args, Context& context) {
+    return Less(args[1], args[0], context) ? args[1] : args[0];
+}
+
+ObjectHolder Max(const vector<ObjectHolder>& args, Context& context) {
+    return Less(args[0], args[1], context) ? args[1] : args[0];
+}
+
+ObjectHolder MakeIntArray(const vector<ObjectHolder>& args, Context& /*context*/) {
+    auto p = args[0].TryAs<Number>();
+    if (!p || p->GetValue() < 0) {
+        throw runtime_error("IntArray. Invalid size"s);
+    }
+    return ObjectHolder::Own(IntArray(static_cast<size_t>(p->GetValue())));
+}
+
+Builtins MakeDefaultBuiltins() {
+    Builtins result;
+    result.Register("len"s, 1, Len);
+    result.Register("abs"s, 1, Abs);
+    result.Register("min"s, 2, Min);
+    result.Register("max"s, 2, Max);
+    result.Register("IntArray"s, 1, MakeIntArray);
+    return result;
+}
+
+}  // namespace
+
+const Builtins& Builtins::Default() {
+    static const Builtins builtins = MakeDefaultBuiltins();
+    return builtins;
+}
+
+void Builtins::Register(std::string name, size_t arity, BuiltinFunction function) {
+    functions_[name] = Builtin{name, arity, function};
+}
+
+const Builtin* Builtins::Find(const std::string& name) const {
+    auto it = functions_.find(name);
+    return it != functions_.end() ? &it->second : nullptr;
+}
+
+}  // namespace runtime
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace runtime {
+
+// Встроенная функция Mython. Получает уже вычисленные аргументы,
+// количество которых проверено при разборе программы
+using BuiltinFunction = ObjectHolder (*)(const std::vector<ObjectHolder>& args, Context& context);
+
+// Описание встроенной функции
+struct Builtin {
+    // Имя, под которым функция доступна в программе
+    std::string name;
+    // Количество параметров
+    size_t arity = 0;
+    // Реализация
+    BuiltinFunction function = nullptr;
+};
+
+// Реестр встроенных функций, доступных Mython-программе.
+// Встраивающее приложение может дополнять его своими функциями
+class Builtins {
+public:
+    // Создаёт пустой реестр
+    Builtins() = default;
+
+    // Возвращает реестр со стандартными функциями len, abs, min, max и IntArray
+    [[nodiscard]] static const Builtins& Default();
+
+    // Регистрирует функцию name с arity параметрами. Функция с тем же именем заменяется
+    void Register(std::string name, size_t arity, BuiltinFunction function);
+
+    // Возвращает описание функции name или nullptr, если такой функции нет
+    [[nodiscard]] const Builtin* Find(const std::string& name) const;
+
+private:
+    std::unordered_map<std::string, Builtin> functions_;
+};
+
+}  // namespace runtime
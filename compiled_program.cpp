@@ -0,0 +1,90 @@
+#include "compiled_program.h"
+
+#include "builtins.h"
+#include "lexer.h"
+#include "parse.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+CompiledProgram CompiledProgram::Compile(const std::string& source,
+                                         std::vector<std::string> inputs) {
+    return Compile(source, std::move(inputs), runtime::Builtins::Default());
+}
+
+CompiledProgram CompiledProgram::Compile(const std::string& source,
+                                         std::vector<std::string> inputs,
+                                         const runtime::Builtins& builtins) {
+    parse::Lexer lexer(std::string_view{source});
+    ParseOptions options;
+    options.builtins = &builtins;
+    options.inputs = inputs;
+    // копии программы могут выполняться в разных потоках
+    options.type_feedback = false;
+    return CompiledProgram(ParseProgram(lexer, options), std::move(inputs), false);
+}
+
+CompiledProgram CompiledProgram::CompileExpression(const std::string& source,
+                                                   std::vector<std::string> inputs) {
+    return CompileExpression(source, std::move(inputs), runtime::Builtins::Default());
+}
+
+CompiledProgram CompiledProgram::CompileExpression(const std::string& source,
+                                                   std::vector<std::string> inputs,
+                                                   const runtime::Builtins& builtins) {
+    parse::Lexer lexer(std::string_view{source});
+    ParseOptions options;
+    options.builtins = &builtins;
+    options.inputs = inputs;
+    // копии программы могут выполняться в разных потоках
+    options.type_feedback = false;
+    return CompiledProgram(ParseExpression(lexer, options), std::move(inputs), true);
+}
+
+CompiledProgram::CompiledProgram(std::shared_ptr<runtime::Executable> root,
+                                 std::vector<std::string> inputs, bool is_expression)
+    : root_(std::move(root))
+    , inputs_(std::move(inputs))
+    , is_expression_(is_expression) {
+    for (size_t i = 0; i < inputs_.size(); ++i) {
+        slots_[inputs_[i]] = i;
+    }
+}
+
+size_t CompiledProgram::GetSlot(const std::string& name) const {
+    return slots_.at(name);
+}
+
+size_t CompiledProgram::GetSlotCount() const {
+    return inputs_.size();
+}
+
+const std::vector<std::string>& CompiledProgram::GetInputs() const {
+    return inputs_;
+}
+
+bool CompiledProgram::IsExpression() const {
+    return is_expression_;
+}
+
+runtime::ObjectHolder CompiledProgram::Evaluate(const std::vector<runtime::ObjectHolder>& bindings,
+                                                runtime::Closure& closure,
+                                                runtime::Context& context) const {
+    if (bindings.size() != inputs_.size()) {
+        throw invalid_argument("Expected "s + to_string(inputs_.size()) + " bindings, got "s
+                               + to_string(bindings.size()));
+    }
+    runtime::SlotContext slot_context(context, bindings.data());
+    return root_->Execute(closure, slot_context);
+}
+
+runtime::ObjectHolder CompiledProgram::Evaluate(const std::vector<runtime::ObjectHolder>& bindings,
+                                                runtime::Context& context) const {
+    runtime::Closure closure;
+    return Evaluate(bindings, closure, context);
+}
+
+runtime::Executable& CompiledProgram::GetRoot() const {
+    return *root_;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace runtime {
+class Builtins;
+}
+
+/*
+ * Программа или выражение Mython, разобранные один раз для многократного выполнения.
+ * Имена входных переменных при разборе заменяются номерами слотов, поэтому при выполнении
+ * значения передаются вектором в порядке слотов, без поиска по именам:
+ *
+ * auto rule = CompiledProgram::CompileExpression("amount > limit", {"amount", "limit"});
+ * for (const auto& record : records) {
+ *     bool hit = runtime::IsTrue(rule.Evaluate({record.amount, record.limit}, context));
+ * }
+ *
+ * Копии разделяют одно и то же разобранное дерево. Дерево разбирается без обратной связи
+ * по типам (см. ParseOptions::type_feedback) и при выполнении не изменяется, поэтому
+ * программу и её копии можно выполнять одновременно в нескольких потоках, если у каждого
+ * потока свои context и closure
+ */
+class CompiledProgram {
+public:
+    // Разбирает программу source. Ошибки разбора приводят к исключениям ParseError/LexerError
+    static CompiledProgram Compile(const std::string& source, std::vector<std::string> inputs);
+    static CompiledProgram Compile(const std::string& source, std::vector<std::string> inputs,
+                                   const runtime::Builtins& builtins);
+
+    // Разбирает одно выражение source
+    static CompiledProgram CompileExpression(const std::string& source,
+                                             std::vector<std::string> inputs);
+    static CompiledProgram CompileExpression(const std::string& source,
+                                             std::vector<std::string> inputs,
+                                             const runtime::Builtins& builtins);
+
+    // Возвращает номер слота входной переменной name.
+    // Если такой переменной нет, выбрасывает исключение out_of_range
+    [[nodiscard]] size_t GetSlot(const std::string& name) const;
+    // Возвращает количество входных переменных
+    [[nodiscard]] size_t GetSlotCount() const;
+    // Возвращает имена входных переменных в порядке слотов
+    [[nodiscard]] const std::vector<std::string>& GetInputs() const;
+    // Возвращает true, если скомпилировано выражение, а не программа
+    [[nodiscard]] bool IsExpression() const;
+
+    // Выполняет программу со значениями входных переменных bindings, перечисленными
+    // в порядке слотов. Глобальные переменные программы создаются в closure.
+    // Для выражения возвращает его значение, для программы - None
+    runtime::ObjectHolder Evaluate(const std::vector<runtime::ObjectHolder>& bindings,
+                                   runtime::Closure& closure, runtime::Context& context) const;
+    // То же, но с новой пустой таблицей глобальных переменных
+    runtime::ObjectHolder Evaluate(const std::vector<runtime::ObjectHolder>& bindings,
+                                   runtime::Context& context) const;
+
+    // Возвращает корень разобранного дерева
+    [[nodiscard]] runtime::Executable& GetRoot() const;
+
+private:
+    CompiledProgram(std::shared_ptr<runtime::Executable> root, std::vector<std::string> inputs,
+                    bool is_expression);
+
+    std::shared_ptr<runtime::Executable> root_;
+    std::vector<std::string> inputs_;
+    std::unordered_map<std::string, size_t> slots_;
+    bool is_expression_;
+};
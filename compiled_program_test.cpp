@@ -0,0 +1,124 @@
+#include "compiled_program.h"
+#include "lexer.h"
+#include "parse.h"
+#include "test_runner_p.h"
+
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+runtime::ObjectHolder Num(int value) {
+    return runtime::ObjectHolder::Own(runtime::Number(value));
+}
+
+void TestCompiledExpression() {
+    auto rule = CompiledProgram::CompileExpression("price * count > limit and not blocked"s,
+                                                   {"price"s, "count"s, "limit"s, "blocked"s});
+    ASSERT(rule.IsExpression());
+    ASSERT_EQUAL(rule.GetSlotCount(), 4U);
+    ASSERT_EQUAL(rule.GetSlot("limit"s), 2U);
+    ASSERT_THROWS(static_cast<void>(rule.GetSlot("unknown"s)), std::out_of_range);
+
+    runtime::DummyContext context;
+    auto no = runtime::ObjectHolder::Own(runtime::Bool(false));
+    auto yes = runtime::ObjectHolder::Own(runtime::Bool(true));
+
+    ASSERT(runtime::IsTrue(rule.Evaluate({Num(10), Num(3), Num(25), no}, context)));
+    ASSERT(!runtime::IsTrue(rule.Evaluate({Num(10), Num(2), Num(25), no}, context)));
+    ASSERT(!runtime::IsTrue(rule.Evaluate({Num(10), Num(3), Num(25), yes}, context)));
+
+    ASSERT_THROWS(rule.Evaluate({Num(1)}, context), std::invalid_argument);
+}
+
+void TestCompiledProgram() {
+    auto program = CompiledProgram::Compile(R"(
+class Scorer:
+  def score(x):
+    return x * 3
+
+s = Scorer()
+if value > 0:
+  print s.score(value), label
+else:
+  print 'negative', label
+)"s,
+                                            {"value"s, "label"s});
+    ASSERT(!program.IsExpression());
+
+    runtime::DummyContext context;
+    auto label = runtime::ObjectHolder::Own(runtime::String("x"s));
+    program.Evaluate({Num(2), label}, context);
+    program.Evaluate({Num(-1), label}, context);
+
+    ASSERT_EQUAL(context.output.str(), "6 x\nnegative x\n"s);
+}
+
+void TestInputsAreResolvedOnlyAtTopLevel() {
+    // Внутри метода value - параметр метода, а не входная переменная
+    auto program = CompiledProgram::Compile(R"(
+class Echo:
+  def say(value):
+    return value
+
+e = Echo()
+print e.say('param'), value
+)"s,
+                                            {"value"s});
+    runtime::DummyContext context;
+    program.Evaluate({runtime::ObjectHolder::Own(runtime::String("input"s))}, context);
+    ASSERT_EQUAL(context.output.str(), "param input\n"s);
+
+    ASSERT_THROWS(CompiledProgram::Compile("value = 1\n"s, {"value"s}), ParseError);
+    ASSERT_THROWS(CompiledProgram::CompileExpression("1 + 2 3"s, {}), ParseError);
+}
+
+void TestEvaluateFromTwoThreads() {
+    // Потоки выполняют копии одной программы с операндами разных типов. Специализированные
+    // по типам узлы при этом переписывали бы общее дерево
+    const auto program = CompiledProgram::Compile(R"(
+class Pair:
+  def __init__(first):
+    self.first = first
+  def join(second):
+    return self.first + second
+  def less(second):
+    return self.first < second
+
+p = Pair(lhs)
+print p.join(rhs), p.less(rhs), p.first == rhs
+)"s,
+                                                  {"lhs"s, "rhs"s});
+    constexpr int ITERATIONS = 2000;
+    auto run = [](CompiledProgram copy, runtime::ObjectHolder lhs, runtime::ObjectHolder rhs,
+                  string& output) {
+        for (int i = 0; i < ITERATIONS; ++i) {
+            runtime::DummyContext context;
+            copy.Evaluate({lhs, rhs}, context);
+            if (context.output.str() != output) {
+                output = context.output.str();
+                return;
+            }
+        }
+    };
+    string numbers = "5 True False\n"s;
+    string strings = "ab True False\n"s;
+    thread first(run, program, Num(2), Num(3), std::ref(numbers));
+    thread second(run, program, runtime::ObjectHolder::Own(runtime::String("a"s)),
+                  runtime::ObjectHolder::Own(runtime::String("b"s)), std::ref(strings));
+    first.join();
+    second.join();
+
+    ASSERT_EQUAL(numbers, "5 True False\n"s);
+    ASSERT_EQUAL(strings, "ab True False\n"s);
+}
+
+}  // namespace
+
+void TestCompiledPrograms(TestRunner& tr) {
+    RUN_TEST(tr, TestCompiledExpression);
+    RUN_TEST(tr, TestCompiledProgram);
+    RUN_TEST(tr, TestInputsAreResolvedOnlyAtTopLevel);
+    RUN_TEST(tr, TestEvaluateFromTwoThreads);
+}
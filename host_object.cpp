@@ -0,0 +1,127 @@
+#include "host_object.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace runtime {
+
+template <>
+int FromObject<int>(const ObjectHolder& object) {
+    if (auto p = object.TryAs<Number>()) {
+        return p->GetValue();
+    }
+    throw runtime_error("Host binding. Number expected"s);
+}
+
+template <>
+bool FromObject<bool>(const ObjectHolder& object) {
+    if (auto p = object.TryAs<Bool>()) {
+        return p->GetValue();
+    }
+    throw runtime_error("Host binding. Bool expected"s);
+}
+
+template <>
+std::string FromObject<std::string>(const ObjectHolder& object) {
+    if (auto p = object.TryAs<String>()) {
+        return p->GetValue();
+    }
+    throw runtime_error("Host binding. String expected"s);
+}
+
+template <>
+ObjectHolder FromObject<ObjectHolder>(const ObjectHolder& object) {
+    return object;
+}
+
+HostClass::HostClass(std::string name)
+    : name_(std::move(name)) {
+}
+
+HostClass& HostClass::AddField(std::string name, Getter getter, Setter setter) {
+    fields_[std::move(name)] = FieldAccess{getter, setter};
+    return *this;
+}
+
+HostClass& HostClass::AddMethod(std::string name, size_t arity, MethodThunk thunk) {
+    methods_[std::move(name)] = MethodAccess{arity, thunk};
+    return *this;
+}
+
+const std::string& HostClass::GetName() const {
+    return name_;
+}
+
+const HostClass::FieldAccess* HostClass::GetField(const std::string& name) const {
+    auto it = fields_.find(name);
+    return it != fields_.end() ? &it->second : nullptr;
+}
+
+const HostClass::MethodAccess* HostClass::GetMethod(const std::string& name) const {
+    auto it = methods_.find(name);
+    return it != methods_.end() ? &it->second : nullptr;
+}
+
+void HostClass::CheckType(const std::type_info& type) const {
+    if (type_ != typeid(void) && type_ != type) {
+        throw runtime_error("Host binding. Object of another type bound to class "s + name_);
+    }
+}
+
+void HostClass::SetType(const std::type_info& type) {
+    if (type_ == typeid(void)) {
+        type_ = type;
+    } else if (type_ != type) {
+        throw invalid_argument("Host binding. Members of different types registered in class "s
+                               + name_);
+    }
+}
+
+HostObject::HostObject(const HostClass& cls, void* object)
+    : cls_(cls)
+    , object_(object) {
+}
+
+void HostObject::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+    os << cls_.GetName() << ' ' << object_;
+}
+
+ObjectHolder HostObject::GetField(const std::string& name) const {
+    const auto* field = cls_.GetField(name);
+    if (!field) {
+        throw runtime_error("Field "s + name + " not found in "s + cls_.GetName());
+    }
+    return field->getter(object_);
+}
+
+void HostObject::SetField(const std::string& name, const ObjectHolder& value) {
+    const auto* field = cls_.GetField(name);
+    if (!field) {
+        throw runtime_error("Field "s + name + " not found in "s + cls_.GetName());
+    }
+    if (!field->setter) {
+        throw runtime_error("Field "s + name + " is read-only"s);
+    }
+    field->setter(object_, value);
+}
+
+bool HostObject::HasMethod(const std::string& method, size_t argument_count) const {
+    const auto* method_ptr = cls_.GetMethod(method);
+    return method_ptr && method_ptr->arity == argument_count;
+}
+
+ObjectHolder HostObject::Call(const std::string& method,
+                              const std::vector<ObjectHolder>& actual_args, Context& context) {
+    const auto* method_ptr = cls_.GetMethod(method);
+    if (!method_ptr || method_ptr->arity != actual_args.size()) {
+        throw runtime_error("Method not implemented"s);
+    }
+    return method_ptr->thunk(object_, actual_args, context);
+}
+
+const HostClass& HostObject::GetClass() const {
+    return cls_;
+}
+
+}  // namespace runtime
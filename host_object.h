@@ -0,0 +1,242 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace runtime {
+
+// Преобразования значений C++ в объекты Mython и обратно.
+// Поддерживаются int, bool, std::string и ObjectHolder
+inline ObjectHolder ToObject(int value) {
+    return ObjectHolder::Own(Number(value));
+}
+
+inline ObjectHolder ToObject(bool value) {
+    return ObjectHolder::Own(Bool(value));
+}
+
+inline ObjectHolder ToObject(const std::string& value) {
+    return ObjectHolder::Own(String(value));
+}
+
+inline ObjectHolder ToObject(ObjectHolder value) {
+    return value;
+}
+
+template <typename T>
+T FromObject(const ObjectHolder& object);
+
+template <>
+int FromObject<int>(const ObjectHolder& object);
+template <>
+bool FromObject<bool>(const ObjectHolder& object);
+template <>
+std::string FromObject<std::string>(const ObjectHolder& object);
+template <>
+ObjectHolder FromObject<ObjectHolder>(const ObjectHolder& object);
+
+/*
+ * Описание C++-типа, экземпляры которого доступны Mython-программе без копирования.
+ * Поля читаются и записываются через функции-переходники прямо в объекте приложения,
+ * методы вызываются через переходники, получающие указатель на объект:
+ *
+ * HostClass request_class("Request");
+ * request_class.Field<&Request::user_id>("user_id")
+ *              .Method<&Request::Score>("score");
+ * closure["request"] = HostObject::Bind(request_class, request);
+ *
+ * Переходники приводят указатель на объект к типу, члены которого зарегистрированы,
+ * поэтому описание запоминает этот тип, а Bind отказывается привязывать объект другого типа.
+ * Тип сравнивается точно, и объект производного класса тоже отвергается: его нужно
+ * привязывать через ссылку на зарегистрированный базовый класс, чтобы указатель был
+ * приведён к базовому классу при компиляции:
+ *
+ * closure["request"] = HostObject::Bind(request_class, static_cast<Request&>(premium));
+ */
+class HostClass {
+public:
+    using Getter = ObjectHolder (*)(const void* object);
+    using Setter = void (*)(void* object, const ObjectHolder& value);
+    using MethodThunk = ObjectHolder (*)(void* object, const std::vector<ObjectHolder>& args,
+                                         Context& context);
+
+    struct FieldAccess {
+        Getter getter = nullptr;
+        // nullptr для полей, доступных только для чтения
+        Setter setter = nullptr;
+    };
+
+    struct MethodAccess {
+        size_t arity = 0;
+        MethodThunk thunk = nullptr;
+    };
+
+    explicit HostClass(std::string name);
+
+    // Регистрирует поле с заданными переходниками. Переходники сами отвечают
+    // за тип объекта, поэтому тип описания не проверяется и не запоминается
+    HostClass& AddField(std::string name, Getter getter, Setter setter);
+    // Регистрирует метод с заданным переходником
+    HostClass& AddMethod(std::string name, size_t arity, MethodThunk thunk);
+
+    // Регистрирует поле-член класса. Для константных полей запись запрещена
+    template <auto Member>
+    HostClass& Field(std::string name) {
+        using Traits = MemberTraits<decltype(Member)>;
+        Setter setter = nullptr;
+        if constexpr (!std::is_const_v<typename Traits::Type>) {
+            setter = &SetMember<Member>;
+        }
+        SetType(typeid(typename Traits::Class));
+        return AddField(std::move(name), &GetMember<Member>, setter);
+    }
+
+    // Регистрирует метод-член класса. Аргументы и результат преобразуются
+    // функциями FromObject и ToObject, результат void возвращается как None
+    template <auto Fn>
+    HostClass& Method(std::string name) {
+        using Traits = MethodTraits<decltype(Fn)>;
+        SetType(typeid(typename Traits::Class));
+        return AddMethod(std::move(name), Traits::ARITY, &CallMethod<Fn>);
+    }
+
+    [[nodiscard]] const std::string& GetName() const;
+    // Возвращает описание поля или nullptr, если поле не зарегистрировано
+    [[nodiscard]] const FieldAccess* GetField(const std::string& name) const;
+    // Возвращает описание метода или nullptr, если метод не зарегистрирован
+    [[nodiscard]] const MethodAccess* GetMethod(const std::string& name) const;
+
+    // Выбрасывает runtime_error, если члены описания зарегистрированы для типа, отличного
+    // от type. Для описаний, заданных только переходниками, проверка всегда проходит
+    void CheckType(const std::type_info& type) const;
+
+private:
+    // Запоминает тип, члены которого регистрируются. Выбрасывает invalid_argument,
+    // если ранее регистрировались члены другого типа
+    void SetType(const std::type_info& type);
+
+    template <typename M>
+    struct MemberTraits;
+
+    template <typename C, typename T>
+    struct MemberTraits<T C::*> {
+        using Class = C;
+        using Type = T;
+    };
+
+    template <typename M>
+    struct MethodTraits;
+
+    template <typename C, typename R, typename... Args>
+    struct MethodTraits<R (C::*)(Args...)> {
+        using Class = C;
+        static constexpr size_t ARITY = sizeof...(Args);
+    };
+
+    template <typename C, typename R, typename... Args>
+    struct MethodTraits<R (C::*)(Args...) const> {
+        using Class = const C;
+        static constexpr size_t ARITY = sizeof...(Args);
+    };
+
+    template <auto Member>
+    static ObjectHolder GetMember(const void* object) {
+        using C = typename MemberTraits<decltype(Member)>::Class;
+        return ToObject(static_cast<const C*>(object)->*Member);
+    }
+
+    template <auto Member>
+    static void SetMember(void* object, const ObjectHolder& value) {
+        using Traits = MemberTraits<decltype(Member)>;
+        static_cast<typename Traits::Class*>(object)->*Member =
+            FromObject<typename Traits::Type>(value);
+    }
+
+    template <auto Fn, typename C, typename R, typename... Args, size_t... I>
+    static ObjectHolder Invoke(C* object, const std::vector<ObjectHolder>& args,
+                               R (*)(Args...), std::index_sequence<I...>) {
+        if constexpr (std::is_void_v<R>) {
+            (object->*Fn)(FromObject<std::decay_t<Args>>(args[I])...);
+            return ObjectHolder::None();
+        } else {
+            return ToObject((object->*Fn)(FromObject<std::decay_t<Args>>(args[I])...));
+        }
+    }
+
+    template <typename M>
+    struct Signature;
+
+    template <typename C, typename R, typename... Args>
+    struct Signature<R (C::*)(Args...)> {
+        using Type = R (*)(Args...);
+    };
+
+    template <typename C, typename R, typename... Args>
+    struct Signature<R (C::*)(Args...) const> {
+        using Type = R (*)(Args...);
+    };
+
+    template <auto Fn>
+    static ObjectHolder CallMethod(void* object, const std::vector<ObjectHolder>& args,
+                                   Context& /*context*/) {
+        using Traits = MethodTraits<decltype(Fn)>;
+        using C = typename Traits::Class;
+        return Invoke<Fn>(static_cast<C*>(object), args,
+                          static_cast<typename Signature<decltype(Fn)>::Type>(nullptr),
+                          std::make_index_sequence<Traits::ARITY>{});
+    }
+
+    std::string name_;
+    // typeid(void), пока не зарегистрирован ни один член
+    std::type_index type_ = typeid(void);
+    std::unordered_map<std::string, FieldAccess> fields_;
+    std::unordered_map<std::string, MethodAccess> methods_;
+};
+
+// Объект приложения, доступный Mython-программе.
+// Не владеет ни объектом, ни его описанием: приложение отвечает за то, чтобы объект и
+// описание HostClass жили дольше программы и всех ссылающихся на объект ObjectHolder
+class HostObject : public Object {
+public:
+    HostObject(const HostClass& cls, void* object);
+
+    // Возвращает ObjectHolder, ссылающийся на object без копирования его полей.
+    // Если члены cls зарегистрированы для другого типа, выбрасывает runtime_error.
+    // Проверяется статический тип T, а не динамический тип объекта
+    template <typename T>
+    [[nodiscard]] static ObjectHolder Bind(const HostClass& cls, T& object) {
+        cls.CheckType(typeid(T));
+        return ObjectHolder::Own(HostObject(cls, static_cast<void*>(&object)));
+    }
+
+    // Выводит в os имя класса и адрес объекта
+    void Print(std::ostream& os, Context& context) override;
+
+    // Читает поле name. Если поле не зарегистрировано, выбрасывает runtime_error
+    [[nodiscard]] ObjectHolder GetField(const std::string& name) const;
+    // Записывает поле name. Если поле не зарегистрировано или доступно только для чтения,
+    // выбрасывает runtime_error
+    void SetField(const std::string& name, const ObjectHolder& value);
+
+    // Вызывает метод method. Если метода нет или количество аргументов не совпадает,
+    // выбрасывает runtime_error
+    ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
+                      Context& context);
+
+    // Возвращает true, если объект имеет метод method, принимающий argument_count параметров
+    [[nodiscard]] bool HasMethod(const std::string& method, size_t argument_count) const;
+
+    [[nodiscard]] const HostClass& GetClass() const;
+
+private:
+    const HostClass& cls_;
+    void* object_;
+};
+
+}  // namespace runtime
@@ -0,0 +1,145 @@
+#include "host_object.h"
+#include "lexer.h"
+#include "parse.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace runtime {
+
+namespace {
+
+struct Request {
+    int user_id = 0;
+    std::string country;
+    bool premium = false;
+    const int version = 3;
+
+    int Score(int base) const {
+        return premium ? base * 2 : base;
+    }
+
+    void Rename(const std::string& name) {
+        country = name;
+    }
+};
+
+HostClass MakeRequestClass() {
+    HostClass cls("Request"s);
+    cls.Field<&Request::user_id>("user_id"s)
+        .Field<&Request::country>("country"s)
+        .Field<&Request::premium>("premium"s)
+        .Field<&Request::version>("version"s)
+        .Method<&Request::Score>("score"s)
+        .Method<&Request::Rename>("rename"s);
+    return cls;
+}
+
+void TestHostObjectFields() {
+    const HostClass cls = MakeRequestClass();
+    Request request;
+    request.user_id = 7;
+
+    auto holder = HostObject::Bind(cls, request);
+    auto* host = holder.TryAs<HostObject>();
+    ASSERT(host != nullptr);
+
+    ASSERT_EQUAL(host->GetField("user_id"s).TryAs<Number>()->GetValue(), 7);
+    // Объект не копируется: изменения в приложении сразу видны программе
+    request.user_id = 8;
+    ASSERT_EQUAL(host->GetField("user_id"s).TryAs<Number>()->GetValue(), 8);
+
+    host->SetField("country"s, ObjectHolder::Own(String("DE"s)));
+    ASSERT_EQUAL(request.country, "DE"s);
+
+    ASSERT_THROWS(host->SetField("version"s, ObjectHolder::Own(Number(4))), runtime_error);
+    ASSERT_THROWS(host->SetField("user_id"s, ObjectHolder::Own(String("x"s))), runtime_error);
+    ASSERT_THROWS(static_cast<void>(host->GetField("unknown"s)), runtime_error);
+}
+
+void TestHostObjectMethods() {
+    const HostClass cls = MakeRequestClass();
+    Request request;
+    request.premium = true;
+    DummyContext context;
+
+    auto holder = HostObject::Bind(cls, request);
+    auto* host = holder.TryAs<HostObject>();
+    ASSERT(host->HasMethod("score"s, 1U));
+    ASSERT(!host->HasMethod("score"s, 0U));
+
+    auto result = host->Call("score"s, {ObjectHolder::Own(Number(10))}, context);
+    ASSERT_EQUAL(result.TryAs<Number>()->GetValue(), 20);
+
+    ASSERT(!host->Call("rename"s, {ObjectHolder::Own(String("FR"s))}, context));
+    ASSERT_EQUAL(request.country, "FR"s);
+
+    ASSERT_THROWS(host->Call("score"s, {}, context), runtime_error);
+}
+
+struct PremiumRequest : Request {
+    int discount = 10;
+};
+
+struct Session {
+    int user_id = 0;
+};
+
+void TestHostObjectTypeIsChecked() {
+    const HostClass cls = MakeRequestClass();
+    Session session;
+    ASSERT_THROWS(static_cast<void>(HostObject::Bind(cls, session)), runtime_error);
+
+    // Объект производного класса привязывается через ссылку на базовый
+    PremiumRequest premium;
+    premium.user_id = 5;
+    ASSERT_THROWS(static_cast<void>(HostObject::Bind(cls, premium)), runtime_error);
+    auto holder = HostObject::Bind(cls, static_cast<Request&>(premium));
+    ASSERT_EQUAL(holder.TryAs<HostObject>()->GetField("user_id"s).TryAs<Number>()->GetValue(), 5);
+
+    HostClass mixed("Mixed"s);
+    mixed.Field<&Request::user_id>("user_id"s);
+    ASSERT_THROWS(mixed.Field<&Session::user_id>("session_id"s), invalid_argument);
+}
+
+void TestHostObjectInProgram() {
+    const HostClass cls = MakeRequestClass();
+    Request request;
+    request.user_id = 42;
+    request.country = "NL"s;
+
+    istringstream input(R"(
+class Rule:
+  def apply(r):
+    if r.country == 'NL':
+      r.premium = True
+    return r.score(r.user_id)
+
+rule = Rule()
+print rule.apply(request)
+request.user_id = request.version + 1
+request.rename('BE')
+)"s);
+    parse::Lexer lexer(input);
+    auto program = ParseProgram(lexer);
+
+    DummyContext context;
+    Closure closure{{Symbol("request"s), HostObject::Bind(cls, request)}};
+    program->Execute(closure, context);
+
+    ASSERT_EQUAL(context.output.str(), "84\n"s);
+    ASSERT(request.premium);
+    ASSERT_EQUAL(request.user_id, 4);
+    ASSERT_EQUAL(request.country, "BE"s);
+}
+
+}  // namespace
+
+void RunHostObjectTests(TestRunner& tr) {
+    RUN_TEST(tr, runtime::TestHostObjectFields);
+    RUN_TEST(tr, runtime::TestHostObjectMethods);
+    RUN_TEST(tr, runtime::TestHostObjectTypeIsChecked);
+    RUN_TEST(tr, runtime::TestHostObjectInProgram);
+}
+
+}  // namespace runtime
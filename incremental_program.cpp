@@ -0,0 +1,212 @@
+#include "incremental_program.h"
+
+#include "ast_arena.h"
+#include "builtins.h"
+#include "lexer.h"
+#include "parse.h"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <stdexcept>
+#include <unordered_set>
+
+using namespace std;
+
+namespace {
+
+void AddClasses(runtime::Closure& closure, const vector<runtime::ObjectHolder>& classes) {
+    for (const auto& cls : classes) {
+        closure[runtime::Symbol(cls.TryAs<runtime::Class>()->GetName())] = cls;
+    }
+}
+
+void AddClassNames(vector<string>& names, const vector<runtime::ObjectHolder>& classes) {
+    for (const auto& cls : classes) {
+        names.push_back(cls.TryAs<runtime::Class>()->GetName());
+    }
+}
+
+}  // namespace
+
+IncrementalProgram::IncrementalProgram(std::string source)
+    : IncrementalProgram(std::move(source), runtime::Builtins::Default()) {
+}
+
+IncrementalProgram::IncrementalProgram(std::string source, const runtime::Builtins& builtins)
+    : source_(std::move(source))
+    , builtins_(builtins) {
+    Reparse(0, 0, 0);
+}
+
+void IncrementalProgram::Edit(size_t offset, size_t length, std::string_view text) {
+    if (offset > source_.size() || length > source_.size() - offset) {
+        throw out_of_range("Edit range is out of the source text"s);
+    }
+    const size_t old_size = source_.size();
+    size_t old_edit_end = offset + length;
+    source_.replace(offset, length, text);
+    const auto delta = static_cast<ptrdiff_t>(text.size()) - static_cast<ptrdiff_t>(length);
+
+    // инструкция, содержащая начало правки
+    auto it = upper_bound(statements_.begin(), statements_.end(), offset,
+                          [](size_t value, const Statement& statement) {
+                              return value < statement.begin;
+                          });
+    size_t first = it == statements_.begin() ? 0 : static_cast<size_t>(it - statements_.begin()) - 1;
+    // правка отступа или первого слова инструкции может присоединить её к предыдущей,
+    // например как ветвь else
+    if (first > 0
+        && all_of(source_.begin() + static_cast<ptrdiff_t>(statements_[first].begin),
+                  source_.begin() + static_cast<ptrdiff_t>(offset), [](char c) {
+                      return isalnum(static_cast<unsigned char>(c)) || c == '_';
+                  })) {
+        --first;
+    }
+    // участок, не разобранный из-за ошибки, разбирается заново вместе с правкой
+    for (size_t i = 0; i < statements_.size(); ++i) {
+        if (!statements_[i].node) {
+            first = min(first, i);
+            old_edit_end = max(old_edit_end,
+                               i + 1 < statements_.size() ? statements_[i + 1].begin : old_size);
+        }
+    }
+    Reparse(first, old_edit_end, delta);
+}
+
+void IncrementalProgram::Reparse(size_t first, size_t old_edit_end, std::ptrdiff_t delta) {
+    const vector<Statement>& old = statements_;
+    const size_t region_begin = first < old.size() ? old[first].begin : 0;
+    auto shifted_begin = [&old, delta](size_t index) {
+        return static_cast<size_t>(static_cast<ptrdiff_t>(old[index].begin) + delta);
+    };
+
+    runtime::Closure classes;
+    for (size_t i = 0; i < first; ++i) {
+        AddClasses(classes, old[i].classes);
+    }
+    runtime::Closure reused_classes;
+    for (size_t i = first; i < old.size(); ++i) {
+        AddClasses(reused_classes, old[i].classes);
+    }
+
+    ParseOptions options;
+    options.builtins = &builtins_;
+
+    vector<Statement> parsed;
+    size_t statement_begin = region_begin;
+    // первая прежняя инструкция, с начала которой разбор может продолжиться без изменений
+    size_t next_old = min(first + 1, old.size());
+    size_t resync = old.size();
+    exception_ptr error;
+    try {
+        parse::Lexer lexer(string_view(source_).substr(region_begin));
+        ParseStatements(
+            lexer, options, classes, reused_classes,
+            [&](unique_ptr<runtime::Executable> node, vector<runtime::ObjectHolder> declared) {
+                const size_t next = region_begin + lexer.CurrentOffset();
+                parsed.push_back(Statement{statement_begin, std::move(node), std::move(declared)});
+                statement_begin = next;
+
+                while (next_old < old.size()
+                       && (old[next_old].begin < old_edit_end || shifted_begin(next_old) < next)) {
+                    ++next_old;
+                }
+                if (next_old == old.size() || shifted_begin(next_old) != next) {
+                    return true;
+                }
+                // последующие инструкции ссылаются на классы по именам, поэтому
+                // их можно оставить, только если набор объявленных классов не изменился
+                vector<string> old_names;
+                vector<string> new_names;
+                for (size_t i = first; i < next_old; ++i) {
+                    AddClassNames(old_names, old[i].classes);
+                }
+                for (const auto& statement : parsed) {
+                    AddClassNames(new_names, statement.classes);
+                }
+                if (old_names != new_names) {
+                    return true;
+                }
+                resync = next_old;
+                return false;
+            });
+    } catch (...) {
+        error = current_exception();
+        // участок до ближайшей прежней границы за ошибкой сохраняется без дерева
+        while (next_old < old.size()
+               && (old[next_old].begin < old_edit_end
+                   || shifted_begin(next_old) <= statement_begin)) {
+            ++next_old;
+        }
+        Statement failed{region_begin, nullptr, {}};
+        for (size_t i = first; i < next_old; ++i) {
+            failed.classes.insert(failed.classes.end(), old[i].classes.begin(),
+                                  old[i].classes.end());
+        }
+        parsed.clear();
+        parsed.push_back(std::move(failed));
+        resync = next_old;
+    }
+
+    vector<Statement> result;
+    result.reserve(first + parsed.size() + (old.size() - resync));
+    for (size_t i = 0; i < first; ++i) {
+        result.push_back(std::move(statements_[i]));
+    }
+    for (auto& statement : parsed) {
+        result.push_back(std::move(statement));
+    }
+    for (size_t i = resync; i < old.size(); ++i) {
+        const size_t begin = shifted_begin(i);
+        result.push_back(std::move(statements_[i]));
+        result.back().begin = begin;
+    }
+    reparsed_ = error ? 0 : parsed.size();
+    statements_ = std::move(result);
+    if (error) {
+        rethrow_exception(error);
+    }
+}
+
+const std::string& IncrementalProgram::GetSource() const {
+    return source_;
+}
+
+size_t IncrementalProgram::GetStatementCount() const {
+    return statements_.size();
+}
+
+size_t IncrementalProgram::GetReparsedCount() const {
+    return reparsed_;
+}
+
+bool IncrementalProgram::IsValid() const {
+    return all_of(statements_.begin(), statements_.end(), [](const Statement& statement) {
+        return statement.node != nullptr;
+    });
+}
+
+size_t IncrementalProgram::GetArenaFootprint() const {
+    unordered_set<const ast::Arena*> arenas;
+    size_t footprint = 0;
+    for (const auto& statement : statements_) {
+        if (!statement.node) {
+            continue;
+        }
+        const ast::Arena* arena = ast::Arena::Of(statement.node.get());
+        if (arena != nullptr && arenas.insert(arena).second) {
+            footprint += arena->Footprint();
+        }
+    }
+    return footprint;
+}
+
+void IncrementalProgram::Execute(runtime::Closure& closure, runtime::Context& context) const {
+    if (!IsValid()) {
+        throw ParseError("Program contains syntax errors"s);
+    }
+    for (const auto& statement : statements_) {
+        statement.node->Execute(closure, context);
+    }
+}
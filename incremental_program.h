@@ -0,0 +1,84 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace runtime {
+class Builtins;
+}
+
+/*
+ * Программа Mython, текст которой редактируется, а дерево обновляется после каждой правки.
+ * Программа хранится как последовательность инструкций верхнего уровня. Правка разбирается
+ * заново только с начала затронутой инструкции и до первой прежней границы инструкций за
+ * концом правки; лексер при этом читает только эти строки. Деревья остальных инструкций
+ * переиспользуются без изменений:
+ *
+ * IncrementalProgram program(text);
+ * program.Edit(offset, removed_length, typed_text);
+ * program.Execute(closure, context);
+ *
+ * Если правка меняет определение класса, прежний объект класса получает новое определение,
+ * поэтому инструкции, использующие класс, разбирать заново не нужно. Если меняется набор
+ * объявленных классов, заново разбирается и весь текст после правки.
+ *
+ * Дерево после правок может отличаться от дерева, полученного разбором всего текста:
+ * разбор участка не знает классов объектов, присвоенных переменным в предыдущих инструкциях,
+ * поэтому вызовы методов этих объектов не связываются при разборе (см.
+ * ParseOptions::bind_methods), а узлы каждого разобранного участка размещаются в своей арене.
+ * Связывание только заранее заполняет кэш вызова, поэтому результат выполнения программы
+ * и её ошибки от этого не зависят
+ */
+class IncrementalProgram {
+public:
+    // Разбирает текст source целиком. Ошибки разбора приводят к исключениям
+    // ParseError/LexerError
+    explicit IncrementalProgram(std::string source);
+    IncrementalProgram(std::string source, const runtime::Builtins& builtins);
+
+    /*
+     * Заменяет length байтов текста, начиная с offset, на text и обновляет дерево программы.
+     * Если offset и length выходят за пределы текста, выбрасывает out_of_range.
+     * При ошибке разбора текст остаётся изменённым, ошибочный участок запоминается и
+     * разбирается заново при следующей правке, а метод выбрасывает ParseError/LexerError
+     */
+    void Edit(size_t offset, size_t length, std::string_view text);
+
+    [[nodiscard]] const std::string& GetSource() const;
+    // Возвращает количество инструкций верхнего уровня
+    [[nodiscard]] size_t GetStatementCount() const;
+    // Возвращает количество инструкций, разобранных при последней правке
+    [[nodiscard]] size_t GetReparsedCount() const;
+    // Возвращает true, если весь текст разобран без ошибок
+    [[nodiscard]] bool IsValid() const;
+    // Возвращает объём памяти, занятый аренами деревьев инструкций (см. ast::Arena).
+    // Арена разбора освобождается, когда правки заменят все разобранные в ней инструкции
+    [[nodiscard]] size_t GetArenaFootprint() const;
+
+    // Выполняет программу, создавая глобальные переменные в closure.
+    // Если текст содержит ошибки, выбрасывает ParseError
+    void Execute(runtime::Closure& closure, runtime::Context& context) const;
+
+private:
+    struct Statement {
+        // смещение начала инструкции; инструкция продолжается до начала следующей
+        size_t begin = 0;
+        // дерево инструкции или nullptr, если участок текста не разобран из-за ошибки
+        std::unique_ptr<runtime::Executable> node;
+        // классы, объявленные инструкцией
+        std::vector<runtime::ObjectHolder> classes;
+    };
+
+    // Заново разбирает текст с начала инструкции first. Прежние инструкции, начинавшиеся
+    // не раньше old_edit_end, сдвинуты правкой на delta байтов и могут быть переиспользованы
+    void Reparse(size_t first, size_t old_edit_end, std::ptrdiff_t delta);
+
+    std::string source_;
+    const runtime::Builtins& builtins_;
+    std::vector<Statement> statements_;
+    size_t reparsed_ = 0;
+};
@@ -0,0 +1,282 @@
+#include "ast_arena.h"
+#include "incremental_program.h"
+#include "lexer.h"
+#include "parse.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace {
+
+string Run(const IncrementalProgram& program) {
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    program.Execute(closure, context);
+    return context.output.str();
+}
+
+// Применяет правку и проверяет, что результат совпадает с разбором текста целиком
+void EditAndCompare(IncrementalProgram& program, size_t offset, size_t length,
+                    const string& text) {
+    program.Edit(offset, length, text);
+
+    parse::Lexer lexer(string_view{program.GetSource()});
+    auto fresh = ParseProgram(lexer);
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    fresh->Execute(closure, context);
+    ASSERT_EQUAL(Run(program), context.output.str());
+}
+
+// Выполняет run(closure, context) и возвращает вывод, а при ошибке выполнения - вывод
+// и текст ошибки
+template <typename Run>
+string OutputOrError(Run run) {
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    try {
+        run(closure, context);
+    } catch (const runtime_error& error) {
+        return context.output.str() + "error: "s + error.what();
+    }
+    return context.output.str();
+}
+
+// Заменяет первое вхождение from на to
+void Replace(IncrementalProgram& program, const string& from, const string& to) {
+    const size_t offset = program.GetSource().find(from);
+    ASSERT(offset != string::npos);
+    EditAndCompare(program, offset, from.size(), to);
+}
+
+void TestEditsReparseOnlyAffectedStatements() {
+    IncrementalProgram program(R"(x = 1
+y = 2
+if x < y:
+  print 'less'
+else:
+  print 'not less'
+print x + y
+)"s);
+    ASSERT_EQUAL(program.GetStatementCount(), 4U);
+    ASSERT_EQUAL(Run(program), "less\n3\n"s);
+
+    Replace(program, "x + y"s, "x * y + 10"s);
+    ASSERT_EQUAL(Run(program), "less\n12\n"s);
+    ASSERT_EQUAL(program.GetReparsedCount(), 1U);
+
+    // правка первого слова разбирает и предыдущую инструкцию
+    Replace(program, "y = 2"s, "y = 0"s);
+    ASSERT_EQUAL(Run(program), "not less\n10\n"s);
+    ASSERT_EQUAL(program.GetReparsedCount(), 2U);
+
+    Replace(program, "'not less'"s, "'greater or equal'"s);
+    ASSERT_EQUAL(program.GetReparsedCount(), 1U);
+    ASSERT_EQUAL(program.GetStatementCount(), 4U);
+}
+
+void TestStatementsAreInsertedJoinedAndRemoved() {
+    IncrementalProgram program("a = 1\nif a:\n  print 'yes'\nprint 'after'\nprint a\n"s);
+
+    // новая инструкция
+    Replace(program, "print a\n"s, "b = a + 1\nprint a\n"s);
+    ASSERT_EQUAL(program.GetStatementCount(), 5U);
+
+    // инструкция с отступом становится частью блока if
+    Replace(program, "print 'after'"s, "  print 'after'"s);
+    ASSERT_EQUAL(program.GetStatementCount(), 4U);
+    ASSERT_EQUAL(Run(program), "yes\nafter\n1\n"s);
+
+    // ветвь else присоединяется к инструкции if
+    Replace(program, "b = a + 1\n"s, "else:\n  print 'no'\n"s);
+    ASSERT_EQUAL(program.GetStatementCount(), 3U);
+
+    // удаление нескольких инструкций
+    const size_t if_offset = program.GetSource().find("if"s);
+    const size_t print_offset = program.GetSource().find("print a"s);
+    EditAndCompare(program, if_offset, print_offset - if_offset, ""s);
+    ASSERT_EQUAL(program.GetStatementCount(), 2U);
+    ASSERT_EQUAL(Run(program), "1\n"s);
+}
+
+void TestClassesAreUpdatedInPlace() {
+    IncrementalProgram program(R"(class Greeter:
+  def hello():
+    return 'hello'
+
+class Loud(Greeter):
+  def shout():
+    return self.hello() + '!'
+
+g = Loud()
+print g.shout()
+)"s);
+    ASSERT_EQUAL(Run(program), "hello!\n"s);
+
+    // изменение метода не затрагивает инструкции, использующие класс
+    Replace(program, "'hello'"s, "'hi'"s);
+    ASSERT_EQUAL(program.GetReparsedCount(), 1U);
+    ASSERT_EQUAL(Run(program), "hi!\n"s);
+
+    // переименование класса требует разбора всего текста после него
+    ASSERT_THROWS(program.Edit(program.GetSource().find("Greeter"s), 7, "Speaker"s), ParseError);
+    ASSERT(!program.IsValid());
+    ASSERT_THROWS(Run(program), ParseError);
+
+    Replace(program, "Loud(Greeter)"s, "Loud(Speaker)"s);
+    ASSERT(program.IsValid());
+    ASSERT_EQUAL(Run(program), "hi!\n"s);
+}
+
+void TestBoundCallsFollowEdits() {
+    IncrementalProgram program(R"(class A:
+  def f():
+    return 'a'
+
+class B:
+  def f():
+    return 'b'
+
+x = A()
+print x.f()
+)"s);
+    ASSERT_EQUAL(Run(program), "a\n"s);
+
+    // вызов x.f() не разбирается заново, хотя связан при разборе с методом класса A
+    Replace(program, "A()\n"s, "B()\n"s);
+    ASSERT_EQUAL(program.GetReparsedCount(), 1U);
+    ASSERT_EQUAL(Run(program), "b\n"s);
+
+    Replace(program, "return 'b'"s, "return 'c'"s);
+    ASSERT_EQUAL(Run(program), "c\n"s);
+}
+
+void TestEditedProgramMatchesFullParse() {
+    IncrementalProgram program(R"(class A:
+  def f(n):
+    return n + 1
+
+class B:
+  def f(n):
+    return n * 10
+
+x = A()
+y = x
+print 'start'
+)"s);
+    // заменяет первое вхождение from на to и сравнивает выполнение программы с выполнением
+    // текста, разобранного целиком, в том числе ошибки выполнения
+    auto edit = [&program](const string& from, const string& to) {
+        const size_t offset = program.GetSource().find(from);
+        ASSERT(offset != string::npos);
+        program.Edit(offset, from.size(), to);
+
+        parse::Lexer lexer(string_view{program.GetSource()});
+        auto fresh = ParseProgram(lexer);
+        const string expected = OutputOrError([&fresh](auto& closure, auto& context) {
+            fresh->Execute(closure, context);
+        });
+        ASSERT_EQUAL(OutputOrError([&program](auto& closure, auto& context) {
+                         program.Execute(closure, context);
+                     }),
+                     expected);
+        return expected;
+    };
+
+    // при разборе всего текста вызов y.f связывается с методом класса A,
+    // а заново разобранная инструкция не знает класса y
+    ASSERT_EQUAL(edit("print 'start'"s, "print y.f(1)"s), "2\n"s);
+
+    ASSERT(edit("y.f(1)"s, "y.f(1, 2)"s).rfind("error: "s, 0) == 0);
+    ASSERT_EQUAL(edit("print y.f(1, 2)"s, "if False:\n  print y.f(1, 2)\nprint x.f(2)"s),
+                 "3\n"s);
+
+    // класс объекта меняется в предыдущей инструкции
+    ASSERT_EQUAL(edit("= A()"s, "= B()"s), "20\n"s);
+    ASSERT_EQUAL(program.GetReparsedCount(), 1U);
+    ASSERT_EQUAL(edit("return n * 10"s, "return n * 100"s), "200\n"s);
+}
+
+void TestErrorsAreReparsedWithTheNextEdit() {
+    IncrementalProgram program("x = 1\nprint x\ny = 2\nprint y\n"s);
+
+    // ввод инструкции по одному символу
+    const string typed = "print x + y\n"s;
+    size_t offset = program.GetSource().size();
+    for (size_t i = 0; i < typed.size(); ++i) {
+        try {
+            program.Edit(offset + i, 0, typed.substr(i, 1));
+        } catch (const ParseError&) {
+        } catch (const parse::LexerError&) {
+        }
+    }
+    ASSERT(program.IsValid());
+    ASSERT_EQUAL(Run(program), "1\n2\n3\n"s);
+
+    ASSERT_THROWS(program.Edit(0, 1, "1"s), std::runtime_error);
+    ASSERT_EQUAL(program.GetStatementCount(), 5U);
+    ASSERT(!program.IsValid());
+    EditAndCompare(program, 0, 1, "x"s);
+    ASSERT_EQUAL(program.GetStatementCount(), 5U);
+    ASSERT_EQUAL(Run(program), "1\n2\n3\n"s);
+
+    ASSERT_THROWS(program.Edit(program.GetSource().size(), 1, ""s), std::out_of_range);
+}
+
+void TestLargeProgramReparsesOneStatement() {
+    string source = "total = 0\n"s;
+    for (int i = 0; i < 2000; ++i) {
+        source += "if total < "s + to_string(i) + ":\n  total = total + 1\n"s;
+    }
+    source += "print total\n"s;
+    IncrementalProgram program(source);
+    ASSERT_EQUAL(program.GetStatementCount(), 2002U);
+
+    Replace(program, "< 1000:"s, "< 1000 and False:"s);
+    ASSERT_EQUAL(program.GetReparsedCount(), 1U);
+    ASSERT_EQUAL(Run(program), "1998\n"s);
+}
+
+void TestEditsDoNotAccumulateMemory() {
+    // инструкции вида "v07 = 0\n" одинаковой длины
+    constexpr size_t COUNT = 50;
+    constexpr size_t LINE = 8;
+    string source;
+    for (size_t i = 0; i < COUNT; ++i) {
+        source += "v"s + (i < 10 ? "0"s : ""s) + to_string(i) + " = 0\n"s;
+    }
+    IncrementalProgram program(source);
+    ASSERT_EQUAL(program.GetStatementCount(), COUNT);
+
+    auto edit_all = [&program](int value) {
+        for (size_t i = 0; i < COUNT; ++i) {
+            program.Edit(i * LINE + 6, 1, to_string(value));
+            ASSERT_EQUAL(program.GetReparsedCount(), 1U);
+        }
+    };
+    // после первого прохода каждая инструкция разобрана в своей арене,
+    // а арена исходного разбора освобождена
+    edit_all(1);
+    const size_t footprint = program.GetArenaFootprint();
+    ASSERT(footprint > 0);
+    ASSERT(footprint <= COUNT * ast::Arena::FIRST_BLOCK_SIZE);
+
+    for (int round = 2; round < 100; ++round) {
+        edit_all(round % 10);
+    }
+    ASSERT_EQUAL(program.GetArenaFootprint(), footprint);
+    ASSERT_EQUAL(Run(program), ""s);
+}
+
+}  // namespace
+
+void TestIncrementalPrograms(TestRunner& tr) {
+    RUN_TEST(tr, TestEditsReparseOnlyAffectedStatements);
+    RUN_TEST(tr, TestStatementsAreInsertedJoinedAndRemoved);
+    RUN_TEST(tr, TestClassesAreUpdatedInPlace);
+    RUN_TEST(tr, TestBoundCallsFollowEdits);
+    RUN_TEST(tr, TestEditedProgramMatchesFullParse);
+    RUN_TEST(tr, TestErrorsAreReparsedWithTheNextEdit);
+    RUN_TEST(tr, TestLargeProgramReparsesOneStatement);
+    RUN_TEST(tr, TestEditsDoNotAccumulateMemory);
+}
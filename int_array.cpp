@@ -0,0 +1,414 @@
+#include "int_array.h"
+
+#include "simd.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+namespace runtime {
+
+namespace kernels {
+
+namespace {
+
+// Скалярные версии ядер. Используются для хвостов массивов и при отсутствии SIMD.
+// Арифметика выполняется в беззнаковых числах, чтобы переполнение вело себя так же,
+// как в векторных инструкциях (по модулю 2^64)
+inline int64_t WrapAdd(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+inline int64_t WrapMul(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+}
+
+int64_t ScalarSum(const int64_t* data, size_t size, int64_t acc) {
+    for (size_t i = 0; i < size; ++i) {
+        acc = WrapAdd(acc, data[i]);
+    }
+    return acc;
+}
+
+int64_t ScalarDot(const int64_t* lhs, const int64_t* rhs, size_t size, int64_t acc) {
+    for (size_t i = 0; i < size; ++i) {
+        acc = WrapAdd(acc, WrapMul(lhs[i], rhs[i]));
+    }
+    return acc;
+}
+
+#if defined(MYTHON_SIMD_AVX2)
+
+// Младшие 64 бита произведения 64-битных чисел через три умножения 32x32->64
+inline __m256i Mul64(__m256i a, __m256i b) {
+    const __m256i lo = _mm256_mul_epu32(a, b);
+    const __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)),
+                                           _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+inline int64_t HorizontalSum(__m256i v) {
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+    return WrapAdd(WrapAdd(lanes[0], lanes[1]), WrapAdd(lanes[2], lanes[3]));
+}
+
+#elif defined(MYTHON_SIMD_SSE2)
+
+inline __m128i Mul64(__m128i a, __m128i b) {
+    const __m128i lo = _mm_mul_epu32(a, b);
+    const __m128i cross = _mm_add_epi64(_mm_mul_epu32(a, _mm_srli_epi64(b, 32)),
+                                        _mm_mul_epu32(_mm_srli_epi64(a, 32), b));
+    return _mm_add_epi64(lo, _mm_slli_epi64(cross, 32));
+}
+
+inline int64_t HorizontalSum(__m128i v) {
+    alignas(16) int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+    return WrapAdd(lanes[0], lanes[1]);
+}
+
+#endif
+
+}  // namespace
+
+int64_t Sum(const int64_t* data, size_t size) {
+    size_t i = 0;
+    int64_t acc = 0;
+#if defined(MYTHON_SIMD_AVX2)
+    __m256i sum = _mm256_setzero_si256();
+    for (; i + 4 <= size; i += 4) {
+        sum = _mm256_add_epi64(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+    }
+    acc = HorizontalSum(sum);
+#elif defined(MYTHON_SIMD_SSE2)
+    __m128i sum = _mm_setzero_si128();
+    for (; i + 2 <= size; i += 2) {
+        sum = _mm_add_epi64(sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+    }
+    acc = HorizontalSum(sum);
+#endif
+    return ScalarSum(data + i, size - i, acc);
+}
+
+int64_t Min(const int64_t* data, size_t size) {
+    size_t i = 0;
+    int64_t result = data[0];
+#if defined(MYTHON_SIMD_AVX2)
+    if (size >= 4) {
+        __m256i best = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        for (i = 4; i + 4 <= size; i += 4) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            best = _mm256_blendv_epi8(best, v, _mm256_cmpgt_epi64(best, v));
+        }
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+        result = *min_element(lanes, lanes + 4);
+    }
+#elif defined(MYTHON_SIMD_SSE2) && defined(__SSE4_2__)
+    if (size >= 2) {
+        __m128i best = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        for (i = 2; i + 2 <= size; i += 2) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            best = _mm_blendv_epi8(best, v, _mm_cmpgt_epi64(best, v));
+        }
+        alignas(16) int64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), best);
+        result = std::min(lanes[0], lanes[1]);
+    }
+#endif
+    for (; i < size; ++i) {
+        result = std::min(result, data[i]);
+    }
+    return result;
+}
+
+int64_t Max(const int64_t* data, size_t size) {
+    size_t i = 0;
+    int64_t result = data[0];
+#if defined(MYTHON_SIMD_AVX2)
+    if (size >= 4) {
+        __m256i best = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        for (i = 4; i + 4 <= size; i += 4) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            best = _mm256_blendv_epi8(best, v, _mm256_cmpgt_epi64(v, best));
+        }
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+        result = *max_element(lanes, lanes + 4);
+    }
+#elif defined(MYTHON_SIMD_SSE2) && defined(__SSE4_2__)
+    if (size >= 2) {
+        __m128i best = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        for (i = 2; i + 2 <= size; i += 2) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            best = _mm_blendv_epi8(best, v, _mm_cmpgt_epi64(v, best));
+        }
+        alignas(16) int64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), best);
+        result = std::max(lanes[0], lanes[1]);
+    }
+#endif
+    for (; i < size; ++i) {
+        result = std::max(result, data[i]);
+    }
+    return result;
+}
+
+int64_t Dot(const int64_t* lhs, const int64_t* rhs, size_t size) {
+    size_t i = 0;
+    int64_t acc = 0;
+#if defined(MYTHON_SIMD_AVX2)
+    __m256i sum = _mm256_setzero_si256();
+    for (; i + 4 <= size; i += 4) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        sum = _mm256_add_epi64(sum, Mul64(a, b));
+    }
+    acc = HorizontalSum(sum);
+#elif defined(MYTHON_SIMD_SSE2)
+    __m128i sum = _mm_setzero_si128();
+    for (; i + 2 <= size; i += 2) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        sum = _mm_add_epi64(sum, Mul64(a, b));
+    }
+    acc = HorizontalSum(sum);
+#endif
+    return ScalarDot(lhs + i, rhs + i, size - i, acc);
+}
+
+void Add(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size) {
+    size_t i = 0;
+#if defined(MYTHON_SIMD_AVX2)
+    for (; i + 4 <= size; i += 4) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi64(a, b));
+    }
+#elif defined(MYTHON_SIMD_SSE2)
+    for (; i + 2 <= size; i += 2) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi64(a, b));
+    }
+#endif
+    for (; i < size; ++i) {
+        out[i] = WrapAdd(lhs[i], rhs[i]);
+    }
+}
+
+void Mul(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size) {
+    size_t i = 0;
+#if defined(MYTHON_SIMD_AVX2)
+    for (; i + 4 <= size; i += 4) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), Mul64(a, b));
+    }
+#elif defined(MYTHON_SIMD_SSE2)
+    for (; i + 2 <= size; i += 2) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), Mul64(a, b));
+    }
+#endif
+    for (; i < size; ++i) {
+        out[i] = WrapMul(lhs[i], rhs[i]);
+    }
+}
+
+void PrefixSum(const int64_t* data, int64_t* out, size_t size) {
+    size_t i = 0;
+    int64_t carry = 0;
+#if defined(MYTHON_SIMD_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i running = zero;
+    for (; i + 4 <= size; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        // [x0, x1, x2, x3] -> [x0, x0+x1, x1+x2, x2+x3]
+        v = _mm256_add_epi64(
+            v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+        // -> [x0, x0+x1, x0+x1+x2, x0+x1+x2+x3]
+        v = _mm256_add_epi64(
+            v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+        v = _mm256_add_epi64(v, running);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+        running = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    if (i > 0) {
+        carry = out[i - 1];
+    }
+#elif defined(MYTHON_SIMD_SSE2)
+    __m128i running = _mm_setzero_si128();
+    for (; i + 2 <= size; i += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // [x0, x1] -> [x0, x0+x1]
+        v = _mm_add_epi64(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi64(v, running);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+        running = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    if (i > 0) {
+        carry = out[i - 1];
+    }
+#endif
+    for (; i < size; ++i) {
+        carry = WrapAdd(carry, data[i]);
+        out[i] = carry;
+    }
+}
+
+const char* InstructionSet() {
+#if defined(MYTHON_SIMD_AVX2)
+    return "avx2";
+#elif defined(MYTHON_SIMD_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+}  // namespace kernels
+
+namespace {
+
+int64_t ToInt(const ObjectHolder& object) {
+    if (auto p = object.TryAs<Number>()) {
+        return p->GetValue();
+    }
+    throw runtime_error("IntArray. Number expected"s);
+}
+
+const IntArray& ToArray(const ObjectHolder& object, size_t size) {
+    auto p = object.TryAs<IntArray>();
+    if (!p) {
+        throw runtime_error("IntArray. IntArray expected"s);
+    }
+    if (p->Size() != size) {
+        throw runtime_error("IntArray. Size mismatch"s);
+    }
+    return *p;
+}
+
+size_t ToIndex(const ObjectHolder& object, size_t size) {
+    int64_t index = ToInt(object);
+    if (index < 0 || static_cast<size_t>(index) >= size) {
+        throw runtime_error("IntArray. Index out of range"s);
+    }
+    return static_cast<size_t>(index);
+}
+
+// Mython оперирует 32-битными числами. Значение, не помещающееся в int, не усекается:
+// программа получает ошибку вместо неверного результата
+ObjectHolder MakeNumber(int64_t value) {
+    if (value < numeric_limits<int>::min() || value > numeric_limits<int>::max()) {
+        throw runtime_error("IntArray. Value "s + to_string(value) + " does not fit in Number"s);
+    }
+    return ObjectHolder::Own(Number(static_cast<int>(value)));
+}
+
+struct ArrayMethod {
+    const char* name;
+    size_t argument_count;
+};
+
+const ArrayMethod ARRAY_METHODS[] = {
+    {"size", 0}, {"get", 1}, {"set", 2},     {"sum", 0},        {"min", 0},
+    {"max", 0},  {"dot", 1}, {"add", 1},     {"mul", 1},        {"prefix_sum", 0},
+};
+
+}  // namespace
+
+IntArray::IntArray(size_t size)
+    : values_(size, 0) {
+}
+
+IntArray::IntArray(std::vector<int64_t> values)
+    : values_(std::move(values)) {
+}
+
+void IntArray::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+    os << '[';
+    bool first = true;
+    for (int64_t value : values_) {
+        if (!first) {
+            os << ", ";
+        }
+        first = false;
+        os << value;
+    }
+    os << ']';
+}
+
+bool IntArray::HasMethod(const std::string& method, size_t argument_count) const {
+    for (const auto& item : ARRAY_METHODS) {
+        if (method == item.name) {
+            return item.argument_count == argument_count;
+        }
+    }
+    return false;
+}
+
+ObjectHolder IntArray::Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
+                            [[maybe_unused]] Context& context) {
+    if (!HasMethod(method, actual_args.size())) {
+        throw runtime_error("IntArray. Method not implemented"s);
+    }
+    const size_t size = values_.size();
+
+    if (method == "size"s) {
+        return MakeNumber(static_cast<int64_t>(size));
+    }
+    if (method == "get"s) {
+        return MakeNumber(values_[ToIndex(actual_args[0], size)]);
+    }
+    if (method == "set"s) {
+        values_[ToIndex(actual_args[0], size)] = ToInt(actual_args[1]);
+        return ObjectHolder::None();
+    }
+    if (method == "sum"s) {
+        return MakeNumber(kernels::Sum(values_.data(), size));
+    }
+    if (method == "min"s || method == "max"s) {
+        if (size == 0) {
+            throw runtime_error("IntArray. Empty array"s);
+        }
+        return MakeNumber(method == "min"s ? kernels::Min(values_.data(), size)
+                                           : kernels::Max(values_.data(), size));
+    }
+    if (method == "dot"s) {
+        const auto& other = ToArray(actual_args[0], size);
+        return MakeNumber(kernels::Dot(values_.data(), other.values_.data(), size));
+    }
+    if (method == "add"s || method == "mul"s) {
+        const auto& other = ToArray(actual_args[0], size);
+        IntArray result(size);
+        if (method == "add"s) {
+            kernels::Add(values_.data(), other.values_.data(), result.values_.data(), size);
+        } else {
+            kernels::Mul(values_.data(), other.values_.data(), result.values_.data(), size);
+        }
+        return ObjectHolder::Own(std::move(result));
+    }
+    // prefix_sum
+    IntArray result(size);
+    kernels::PrefixSum(values_.data(), result.values_.data(), size);
+    return ObjectHolder::Own(std::move(result));
+}
+
+size_t IntArray::Size() const {
+    return values_.size();
+}
+
+const std::vector<int64_t>& IntArray::Values() const {
+    return values_;
+}
+
+std::vector<int64_t>& IntArray::Values() {
+    return values_;
+}
+
+}  // namespace runtime
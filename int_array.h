@@ -0,0 +1,69 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace runtime {
+
+// Вычислительные ядра над непрерывными массивами 64-битных целых.
+// При сборке с AVX2 или SSE2 используются векторные инструкции, иначе - скалярный код
+namespace kernels {
+
+// Сумма элементов массива
+int64_t Sum(const int64_t* data, size_t size);
+// Минимальный элемент. Массив должен быть непустым
+int64_t Min(const int64_t* data, size_t size);
+// Максимальный элемент. Массив должен быть непустым
+int64_t Max(const int64_t* data, size_t size);
+// Скалярное произведение массивов одинаковой длины
+int64_t Dot(const int64_t* lhs, const int64_t* rhs, size_t size);
+// Поэлементное сложение: out[i] = lhs[i] + rhs[i]
+void Add(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size);
+// Поэлементное умножение: out[i] = lhs[i] * rhs[i]
+void Mul(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size);
+// Префиксная сумма: out[i] = data[0] + ... + data[i]. Допускается out == data
+void PrefixSum(const int64_t* data, int64_t* out, size_t size);
+
+// Название набора инструкций, с которым собраны ядра ("avx2", "sse2" или "scalar")
+const char* InstructionSet();
+
+}  // namespace kernels
+
+// Массив целых чисел, хранящий значения без упаковки в ObjectHolder.
+// Из Mython-программы доступен через методы:
+//   size(), get(i), set(i, value), sum(), min(), max(), dot(other),
+//   add(other), mul(other), prefix_sum()
+class IntArray : public Object {
+public:
+    IntArray() = default;
+    // Создаёт массив из size нулей
+    explicit IntArray(size_t size);
+    explicit IntArray(std::vector<int64_t> values);
+
+    // Выводит массив в виде [1, 2, 3]
+    void Print(std::ostream& os, Context& context) override;
+
+    /*
+     * Вызывает встроенный метод массива method с аргументами actual_args.
+     * Если метода нет, либо аргументы имеют неверный тип или количество,
+     * выбрасывает исключение runtime_error
+     */
+    ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
+                      Context& context);
+
+    // Возвращает true, если у массива есть метод method, принимающий argument_count параметров
+    [[nodiscard]] bool HasMethod(const std::string& method, size_t argument_count) const;
+
+    [[nodiscard]] size_t Size() const;
+    [[nodiscard]] const std::vector<int64_t>& Values() const;
+    [[nodiscard]] std::vector<int64_t>& Values();
+
+private:
+    std::vector<int64_t> values_;
+};
+
+}  // namespace runtime
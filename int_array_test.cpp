@@ -0,0 +1,137 @@
+#include "int_array.h"
+#include "lexer.h"
+#include "parse.h"
+#include "test_runner_p.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+
+namespace runtime {
+
+namespace {
+
+vector<int64_t> MakeValues(size_t size) {
+    vector<int64_t> values(size);
+    for (size_t i = 0; i < size; ++i) {
+        values[i] = static_cast<int64_t>((i * 7919) % 101) - 50;
+    }
+    return values;
+}
+
+void TestKernels() {
+    // Размеры подобраны так, чтобы проверить и векторную часть, и хвосты
+    for (size_t size : {1U, 2U, 3U, 4U, 5U, 7U, 8U, 9U, 31U, 64U, 1001U}) {
+        auto a = MakeValues(size);
+        auto b = MakeValues(size + 3);
+        b.resize(size);
+        const string hint = "size "s + to_string(size);
+
+        AssertEqual(kernels::Sum(a.data(), size), accumulate(a.begin(), a.end(), int64_t{0}),
+                    hint);
+        AssertEqual(kernels::Min(a.data(), size), *min_element(a.begin(), a.end()), hint);
+        AssertEqual(kernels::Max(a.data(), size), *max_element(a.begin(), a.end()), hint);
+        AssertEqual(kernels::Dot(a.data(), b.data(), size),
+                    inner_product(a.begin(), a.end(), b.begin(), int64_t{0}), hint);
+
+        vector<int64_t> out(size);
+        kernels::Add(a.data(), b.data(), out.data(), size);
+        for (size_t i = 0; i < size; ++i) {
+            AssertEqual(out[i], a[i] + b[i], hint);
+        }
+        kernels::Mul(a.data(), b.data(), out.data(), size);
+        for (size_t i = 0; i < size; ++i) {
+            AssertEqual(out[i], a[i] * b[i], hint);
+        }
+
+        vector<int64_t> expected(size);
+        partial_sum(a.begin(), a.end(), expected.begin());
+        kernels::PrefixSum(a.data(), out.data(), size);
+        AssertEqual(out, expected, hint);
+        kernels::PrefixSum(a.data(), a.data(), size);
+        AssertEqual(a, expected, hint);
+    }
+
+    const int64_t big = int64_t{1} << 40;
+    vector<int64_t> lhs = {big, -big, 3, big + 5};
+    vector<int64_t> rhs = {7, int64_t{1} << 20, -2, 11};
+    vector<int64_t> out(4);
+    kernels::Mul(lhs.data(), rhs.data(), out.data(), 4);
+    ASSERT_EQUAL(out, (vector<int64_t>{big * 7, -big * (int64_t{1} << 20), -6, (big + 5) * 11}));
+}
+
+void TestIntArrayMethods() {
+    DummyContext context;
+    IntArray array(vector<int64_t>{3, -1, 4, 1, 5});
+
+    ASSERT(array.HasMethod("sum"s, 0U));
+    ASSERT(!array.HasMethod("sum"s, 1U));
+    ASSERT(!array.HasMethod("unknown"s, 0U));
+
+    auto sum = array.Call("sum"s, {}, context);
+    ASSERT_EQUAL(sum.TryAs<Number>()->GetValue(), 12);
+    ASSERT_EQUAL(array.Call("min"s, {}, context).TryAs<Number>()->GetValue(), -1);
+    ASSERT_EQUAL(array.Call("max"s, {}, context).TryAs<Number>()->GetValue(), 5);
+
+    array.Call("set"s, {ObjectHolder::Own(Number{1}), ObjectHolder::Own(Number{10})}, context);
+    ASSERT_EQUAL(array.Call("get"s, {ObjectHolder::Own(Number{1})}, context)
+                     .TryAs<Number>()
+                     ->GetValue(),
+                 10);
+
+    ASSERT_THROWS(array.Call("get"s, {ObjectHolder::Own(Number{5})}, context), runtime_error);
+    ASSERT_THROWS(array.Call("dot"s, {ObjectHolder::Own(IntArray(2))}, context), runtime_error);
+    ASSERT_THROWS(IntArray().Call("min"s, {}, context), runtime_error);
+
+    // Результаты вычисляются в 64 битах, и значение вне диапазона Number - ошибка
+    const int64_t big = numeric_limits<int>::max();
+    IntArray wide(vector<int64_t>{big, 1, numeric_limits<int>::min()});
+    ASSERT_EQUAL(wide.Call("get"s, {ObjectHolder::Own(Number{0})}, context)
+                     .TryAs<Number>()
+                     ->GetValue(),
+                 numeric_limits<int>::max());
+    ASSERT_EQUAL(wide.Call("sum"s, {}, context).TryAs<Number>()->GetValue(), 0);
+    ASSERT_THROWS(IntArray(vector<int64_t>{big, 1}).Call("sum"s, {}, context), runtime_error);
+    ASSERT_THROWS(wide.Call("dot"s, {ObjectHolder::Own(IntArray(vector<int64_t>{1, 1, 0}))},
+                            context),
+                  runtime_error);
+
+    ostringstream os;
+    array.Print(os, context);
+    ASSERT_EQUAL(os.str(), "[3, 10, 4, 1, 5]"s);
+}
+
+void TestIntArrayProgram() {
+    istringstream input(R"(
+a = IntArray(4)
+b = IntArray(4)
+a.set(0, 1)
+a.set(1, 2)
+a.set(2, 3)
+a.set(3, 4)
+b.set(0, 10)
+b.set(3, 20)
+c = a.mul(b)
+print a.sum(), a.dot(b), a.add(b), c.prefix_sum(), a.size()
+)"s);
+    parse::Lexer lexer(input);
+    auto program = ParseProgram(lexer);
+
+    DummyContext context;
+    Closure closure;
+    program->Execute(closure, context);
+
+    ASSERT_EQUAL(context.output.str(), "10 90 [11, 2, 3, 24] [10, 10, 10, 90] 4\n"s);
+}
+
+}  // namespace
+
+void RunIntArrayTests(TestRunner& tr) {
+    RUN_TEST(tr, runtime::TestKernels);
+    RUN_TEST(tr, runtime::TestIntArrayMethods);
+    RUN_TEST(tr, runtime::TestIntArrayProgram);
+}
+
+}  // namespace runtime
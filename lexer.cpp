@@ -1,14 +1,163 @@
 #include "lexer.h"
 
+#include "text_scan.h"
+
 #include <algorithm>
+#include <array>
+#include <cerrno>
 #include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <unordered_map>
 #include <iostream>
+#include <iterator>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
 namespace parse {
 
+namespace {
+
+// Классы символов исходного текста
+enum CharClass : uint8_t {
+    DIGIT = 1,       // 0-9
+    ALPHABETIC = 2,  // a-z, A-Z, _
+};
+
+constexpr std::array<uint8_t, 256> MakeCharClasses() {
+    std::array<uint8_t, 256> classes{};
+    for (int c = '0'; c <= '9'; ++c) {
+        classes[c] = DIGIT;
+    }
+    for (int c = 'a'; c <= 'z'; ++c) {
+        classes[c] = ALPHABETIC;
+        classes[c - 'a' + 'A'] = ALPHABETIC;
+    }
+    classes['_'] = ALPHABETIC;
+    return classes;
+}
+
+constexpr std::array<uint8_t, 256> CHAR_CLASSES = MakeCharClasses();
+
+constexpr bool HasClass(char c, uint8_t mask) {
+    return (CHAR_CLASSES[static_cast<unsigned char>(c)] & mask) != 0;
+}
+
+template <typename T>
+Token MakeKeyword() {
+    return Token(T{});
+}
+
+struct Keyword {
+    std::string_view word;
+    Token (*make)() = nullptr;
+};
+
+// Совершенный хеш служебных слов: длина, первый и последний символ слова
+// однозначно определяют ячейку таблицы
+constexpr size_t KEYWORD_TABLE_SIZE = 32;
+constexpr size_t MIN_KEYWORD_LENGTH = 2;
+constexpr size_t MAX_KEYWORD_LENGTH = 6;
+
+constexpr size_t KeywordHash(std::string_view word) {
+    return (word.size() + static_cast<unsigned char>(word.front())
+            + static_cast<unsigned char>(word.back()))
+           % KEYWORD_TABLE_SIZE;
+}
+
+constexpr std::array<Keyword, 12> KEYWORDS = {{
+    {"class", MakeKeyword<token_type::Class>},
+    {"return", MakeKeyword<token_type::Return>},
+    {"if", MakeKeyword<token_type::If>},
+    {"else", MakeKeyword<token_type::Else>},
+    {"def", MakeKeyword<token_type::Def>},
+    {"print", MakeKeyword<token_type::Print>},
+    {"and", MakeKeyword<token_type::And>},
+    {"or", MakeKeyword<token_type::Or>},
+    {"not", MakeKeyword<token_type::Not>},
+    {"None", MakeKeyword<token_type::None>},
+    {"True", MakeKeyword<token_type::True>},
+    {"False", MakeKeyword<token_type::False>},
+}};
+
+constexpr std::array<Keyword, KEYWORD_TABLE_SIZE> MakeKeywordTable() {
+    std::array<Keyword, KEYWORD_TABLE_SIZE> table{};
+    for (const Keyword& keyword : KEYWORDS) {
+        table[KeywordHash(keyword.word)] = keyword;
+    }
+    return table;
+}
+
+constexpr std::array<Keyword, KEYWORD_TABLE_SIZE> KEYWORD_TABLE = MakeKeywordTable();
+
+constexpr bool KeywordHashIsPerfect() {
+    for (const Keyword& keyword : KEYWORDS) {
+        if (KEYWORD_TABLE[KeywordHash(keyword.word)].word != keyword.word) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(KeywordHashIsPerfect(), "Keyword hash has collisions");
+
+// Возвращает служебное слово, совпадающее с word, или nullptr
+const Keyword* FindKeyword(std::string_view word) {
+    if (word.size() < MIN_KEYWORD_LENGTH || word.size() > MAX_KEYWORD_LENGTH) {
+        return nullptr;
+    }
+    const Keyword& candidate = KEYWORD_TABLE[KeywordHash(word)];
+    return candidate.word == word ? &candidate : nullptr;
+}
+
+}  // namespace
+
+TokenText::TokenText(std::string text)
+    : owned(std::move(text))
+    , isOwned(true) {
+}
+
+TokenText::TokenText(const char* text)
+    : TokenText(std::string(text)) {
+}
+
+TokenText TokenText::Ref(std::string_view text) {
+    TokenText result;
+    result.view = text;
+    return result;
+}
+
+std::string_view TokenText::View() const {
+    return isOwned ? std::string_view(owned) : view;
+}
+
+bool TokenText::IsOwned() const {
+    return isOwned;
+}
+
+TokenText::operator std::string() const {
+    return std::string(View());
+}
+
+bool operator==(const TokenText& lhs, const TokenText& rhs) {
+    return lhs.View() == rhs.View();
+}
+
+bool operator!=(const TokenText& lhs, const TokenText& rhs) {
+    return !(lhs == rhs);
+}
+
+std::ostream& operator<<(std::ostream& os, const TokenText& rhs) {
+    return os << rhs.View();
+}
+
 bool operator==(const Token& lhs, const Token& rhs) {
     using namespace token_type;
 
@@ -76,124 +225,290 @@ std::ostream& operator<<(std::ostream& os, const Token& rhs) {
     return os << "Unknown token :("sv;
 }
 
-Lexer::Lexer(std::istream& input):in(input) {
-    emptyLine = true;
-    newOffset = 0;
-    offsetSpace = 0;
+MappedFile::MappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file "s + path);
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat file "s + path);
+    }
+    size = static_cast<size_t>(info.st_size);
+    // пустой файл отобразить нельзя, для него текст остаётся пустым
+    if (size > 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Cannot map file "s + path);
+        }
+        // текст читается лексером один раз от начала до конца
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapped);
+    }
+    close(fd);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(std::exchange(other.data, nullptr))
+    , size(std::exchange(other.size, 0)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    Unmap();
+}
+
+std::string_view MappedFile::Text() const {
+    return {data, size};
+}
+
+void MappedFile::Unmap() {
+    if (data != nullptr) {
+        munmap(const_cast<char*>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+Lexer::Lexer(std::istream& input, size_t buffer_size)
+    : buffer(std::max<size_t>(buffer_size, 1), '\0')
+    , input(&input)
+    , inputDone(false) {
+    begin = tokenStart = pos = end = buffer.data();
     NextToken();
 }
 
-const Token& Lexer::CurrentToken() const {
-    return currentToken;
+Lexer::Lexer(int fd, size_t buffer_size)
+    : buffer(std::max<size_t>(buffer_size, 1), '\0')
+    , inputFd(fd)
+    , inputDone(false) {
+    begin = tokenStart = pos = end = buffer.data();
+    NextToken();
+}
+
+Lexer::Lexer(int fd, size_t buffer_size, int interrupt_fd)
+    : buffer(std::max<size_t>(buffer_size, 1), '\0')
+    , inputFd(fd)
+    , interruptFd(interrupt_fd)
+    , inputDone(false) {
+    begin = tokenStart = pos = end = buffer.data();
+    NextToken();
 }
 
-Token Lexer::NextToken() {
-    currentToken = ReadToken(in);
+Lexer::Lexer(std::string_view source)
+    : begin(source.data())
+    , pos(source.data())
+    , end(source.data() + source.size()) {
+    NextToken();
+}
+
+const Token& Lexer::NextToken() {
+    currentToken = ReadToken();
     return currentToken;
 }
-    
-Token Lexer::ReadToken(std::istream& input) {
-    // выравниваем смещение
-    if (newOffset > offsetSpace) {
-        offsetSpace += 2;
-        return Token(token_type::Indent());
+
+size_t Lexer::CurrentOffset() const {
+    return bufferOffset + static_cast<size_t>(tokenStart - begin);
+}
+
+size_t Lexer::BufferSize() const {
+    return buffer.size();
+}
+
+bool Lexer::NeedsInput() const {
+    return pos == end && !inputDone;
+}
+
+bool Lexer::AtEnd() {
+    return pos == end && !Refill();
+}
+
+bool Lexer::Refill() {
+    if (inputDone) {
+        return false;
     }
-    
-    if (newOffset < offsetSpace) {
-        offsetSpace -= 2;
-        return Token(token_type::Dedent());
+    // Лексемы не переходят через конец строки, а end стоит сразу после перевода строки,
+    // поэтому обычно сохранять нечего, кроме начала следующей недочитанной строки
+    char* data = buffer.data();
+    const size_t keepFrom = static_cast<size_t>(tokenStart - data);
+    const size_t position = static_cast<size_t>(pos - tokenStart);
+    size_t scanned = static_cast<size_t>(end - tokenStart);
+    std::memmove(data, data + keepFrom, filled - keepFrom);
+    filled -= keepFrom;
+    bufferOffset += keepFrom;
+
+    size_t linesEnd = 0;
+    while (true) {
+        // перевод строки может найтись только в ещё не просмотренной части [scanned, filled)
+        const auto first = std::make_reverse_iterator(buffer.data() + filled);
+        const auto last = std::make_reverse_iterator(buffer.data() + scanned);
+        if (auto newline = std::find(first, last, '\n'); newline != last) {
+            linesEnd = static_cast<size_t>(newline.base() - buffer.data());
+            break;
+        }
+        scanned = filled;
+        if (filled == buffer.size()) {
+            // строка не помещается в буфер
+            buffer.resize(buffer.size() * 2);
+        }
+        const size_t count = ReadInput(buffer.data() + filled, buffer.size() - filled);
+        if (count == 0) {
+            inputDone = true;
+            linesEnd = filled;
+            break;
+        }
+        filled += count;
     }
-    
-    // проверка на конец потока
-    if (input.eof()) {
-        if (!emptyLine) {
-            emptyLine = true;
-            return Token(token_type::Newline());
+
+    begin = tokenStart = buffer.data();
+    pos = begin + position;
+    end = begin + linesEnd;
+    return pos != end;
+}
+
+size_t Lexer::ReadInput(char* dst, size_t size) {
+    if (input != nullptr) {
+        input->read(dst, static_cast<std::streamsize>(size));
+        return static_cast<size_t>(input->gcount());
+    }
+    while (true) {
+        if (interruptFd >= 0) {
+            std::array<pollfd, 2> fds{pollfd{inputFd, POLLIN, 0}, pollfd{interruptFd, POLLIN, 0}};
+            if (poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("Cannot wait for program text: "s + std::strerror(errno));
+            }
+            if (fds[1].revents != 0) {
+                return 0;
+            }
+        }
+        const ssize_t count = read(inputFd, dst, size);
+        if (count >= 0) {
+            return static_cast<size_t>(count);
+        }
+        if (errno != EINTR) {
+            throw std::runtime_error("Cannot read program text: "s + std::strerror(errno));
         }
-        return Token(token_type::Eof());
     }
+}
     
-    // если пустая строка - считываем смещение
-    if (emptyLine) {
-        
-        int tmpOffset = ReadOffset(input);
-        if (input.eof()) {
-            //if (offsetSpace > 0) {}
-            newOffset = tmpOffset;
-            return ReadToken(input);
+Token Lexer::ReadToken() {
+    // Разбор идёт циклом: пустые строки, комментарии и незначащие символы пропускаются
+    // переходом к следующей итерации, поэтому глубина стека не зависит от текста.
+    // Состояние автомата - emptyLine (начало строки или её середина) и отступы
+    while (true) {
+        tokenStart = pos;
+        // выравниваем смещение
+        if (newOffset > offsetSpace) {
+            offsetSpace += 2;
+            return Token(token_type::Indent());
         }
-        // если строка пустая - пропускаем
-        if (input.peek()=='\n') {
-            input.get();
-            return ReadToken(input);
+        
+        if (newOffset < offsetSpace) {
+            offsetSpace -= 2;
+            return Token(token_type::Dedent());
         }
-        newOffset = tmpOffset;
         
-        // пропуск комментария
-        if (input.peek() == '#') {
-            SkipComment(input);
-        } else {
-            emptyLine = false;
+        // проверка на конец текста
+        if (AtEnd()) {
+            if (!emptyLine) {
+                emptyLine = true;
+                return Token(token_type::Newline());
+            }
+            // в конце текста закрываются все открытые блоки
+            if (offsetSpace > 0) {
+                newOffset = 0;
+                continue;
+            }
+            return Token(token_type::Eof());
         }
         
-        return ReadToken(input);
-    }
-    
-    // конец не пустой строки
-    if ((input.peek()=='\n') && (!emptyLine)) {
-        input.get();
-        emptyLine = true;
-        return Token(token_type::Newline());
-    }
-    
-    char c = input.get();
-    switch (c) {
-        case '=':
-        case '>':
-        case '<':
-        case '!':
-            emptyLine = false;
-            if (input.peek() == '=') {
-                return ReadMultiplyChar(c, input);
-            } else {
-                return ReadSingleChar(c);
+        // если пустая строка - считываем смещение
+        if (emptyLine) {
+            int tmpOffset = ReadOffset();
+            if (AtEnd()) {
+                continue;
             }
-            //break;
-        case '.':
-        case ',':
-        case '(':
-        case ')':
-        case ':':    
-        case '+':
-        case '-':
-        case '*':
-        case '/':
-            emptyLine = false;
-            return ReadSingleChar(c);
-        case '\'':
-        case '\"':
-            emptyLine = false;
-            return ReadString(c, input);
-        case '#':
-            SkipComment(input);
-            return ReadToken(input);
-        default:
-            if (IsDigit(c)) {
-                emptyLine = false;
-                return ReadNumber(c, input);
+            // если строка пустая - пропускаем
+            if (*pos == '\n') {
+                ++pos;
+                continue;
             }
-            
-            if (IsAplhabetic(c)) {
+            // строка из одного комментария пропускается и не меняет отступ
+            if (*pos == '#') {
+                SkipComment();
+            } else {
+                newOffset = tmpOffset;
                 emptyLine = false;
-                return ReadSymbolToken(c, input);
             }
+            continue;
+        }
+        
+        // конец не пустой строки
+        if (*pos == '\n') {
+            ++pos;
+            emptyLine = true;
+            return Token(token_type::Newline());
+        }
+        
+        char c = *pos++;
+        switch (c) {
+            case ' ':
+                // пробелы между лексемами пропускаются целыми отрезками
+                pos = scan::SkipSpaces(pos, end);
+                continue;
+            case '=':
+            case '>':
+            case '<':
+            case '!':
+                if (!AtEnd() && *pos == '=') {
+                    return ReadMultiplyChar(c);
+                } else {
+                    return ReadSingleChar(c);
+                }
+            case '.':
+            case ',':
+            case '(':
+            case ')':
+            case ':':    
+            case '+':
+            case '-':
+            case '*':
+            case '/':
+                return ReadSingleChar(c);
+            case '\'':
+            case '\"':
+                return ReadString(c);
+            case '#':
+                SkipComment();
+                continue;
+            default:
+                if (IsDigit(c)) {
+                    return ReadNumber(pos - 1);
+                }
+                
+                if (IsAplhabetic(c)) {
+                    return ReadSymbolToken(pos - 1);
+                }
+        }
+        // незначащие символы внутри строки пропускаются
     }
-    
-    return ReadToken(input);
 }    
 
-Token Lexer::ReadMultiplyChar(char c, std::istream& input) {
-    input.get();
+Token Lexer::ReadMultiplyChar(char c) {
+    ++pos;
     switch (c) {
         case '=':
             return Token(token_type::Eq());
@@ -209,50 +524,62 @@ Token Lexer::ReadMultiplyChar(char c, std::istream& input) {
 }
 
 bool Lexer::IsDigit(char c) {
-    return (c >= '0') && (c <= '9');
+    return HasClass(c, DIGIT);
 }
     
 bool Lexer::IsAplhabetic(char c) {
-    return ((c >= 'a') && (c <= 'z')) ||
-        ((c >= 'A') && (c <= 'Z')) ||
-        (c == '_');
+    return HasClass(c, ALPHABETIC);
 }
     
 bool Lexer::IsAplhabeticOrDigit(char c) {
-    return IsDigit(c) || IsAplhabetic(c);
+    return HasClass(c, DIGIT | ALPHABETIC);
 }    
     
 Token Lexer::ReadSingleChar(char c) {
     return Token(token_type::Char{c});
 }
 
-Token Lexer::ReadNumber(char first, std::istream& input) {
-    string s;
-    s.push_back(first);
-    while (IsDigit(input.peek())) {
-        s.push_back(input.get());
+Token Lexer::ReadNumber(const char* first) {
+    while (!AtEnd() && IsDigit(*pos)) {
+        ++pos;
     }
-    return Token(token_type::Number{stoi(s)});
+    int value = 0;
+    auto [ptr, ec] = std::from_chars(first, pos, value);
+    if (ec != std::errc()) {
+        throw LexerError("Number is out of range: "s + std::string(first, pos));
+    }
+    return Token(token_type::Number{value});
 }    
 
-Token Lexer::ReadString(char first, std::istream& input) {
-    auto it = std::istreambuf_iterator<char>(input);
-    auto end = std::istreambuf_iterator<char>();
-    std::string s;
+Token Lexer::ReadString(char first) {
+    // строка без escape-последовательностей возвращается срезом исходного текста
+    const char* begin = pos;
+    pos = scan::FindStringStop(pos, end, first);
+    if (!AtEnd() && *pos == first) {
+        std::string_view text(begin, pos - begin);
+        ++pos;
+        // буфер ввода перезаписывается, поэтому из него текст копируется
+        if (!buffer.empty()) {
+            return Token(token_type::String{std::string(text)});
+        }
+        return Token(token_type::String{TokenText::Ref(text)});
+    }
+
+    std::string s(begin, pos);
     while (true) {
-        if (it == end) {
+        if (AtEnd()) {
             throw LexerError("String parsing error");
         }
-        const char ch = *it;
+        const char ch = *pos;
         if (ch == first) {
-            ++it;
+            ++pos;
             break;
         } else if (ch == '\\') {
-            ++it;
-            if (it == end) {
+            ++pos;
+            if (AtEnd()) {
                 throw LexerError("String parsing error");
             }
-            const char escaped_char = *(it);
+            const char escaped_char = *pos;
             switch (escaped_char) {
                 case 'n':
                     s.push_back('\n');
@@ -275,90 +602,42 @@ Token Lexer::ReadString(char first, std::istream& input) {
                 default:
                     throw LexerError("Unrecognized escape sequence \\"s + escaped_char);
             }
-        } else if (ch == '\n' || ch == '\r') {
-            throw LexerError("Unexpected end of line"s);
+            ++pos;
         } else {
-            s.push_back(ch);
+            throw LexerError("Unexpected end of line"s);
         }
-        ++it;
+        // обычные символы копируются целым отрезком до следующего особого символа
+        const char* stop = scan::FindStringStop(pos, end, first);
+        s.append(pos, stop);
+        pos = stop;
     }
     
-    return Token(token_type::String{s});
+    return Token(token_type::String{std::move(s)});
 }
     
-int Lexer::ReadOffset(std::istream& input) {
-    int offset = 0;
-    while ((!input.eof()) && (input.peek() == ' ')) {
-        input.get();
-        offset++;
-    }
-    return offset;
+int Lexer::ReadOffset() {
+    const char* begin = pos;
+    pos = scan::SkipSpaces(pos, end);
+    return static_cast<int>(pos - begin);
 }
     
-Token Lexer::ReadSymbolToken(char first, std::istream& input) {
-    string s;
-    s.push_back(first);
-    while ((!input.eof()) && IsAplhabeticOrDigit(input.peek())) {
-        char c = input.get();
-        s.push_back(c);
+Token Lexer::ReadSymbolToken(const char* first) {
+    while (!AtEnd() && IsAplhabeticOrDigit(*pos)) {
+        ++pos;
     }
+    std::string_view s(first, pos - first);
     
-    using namespace std::literals;
-    if (s == "class"s) {
-        return Token(token_type::Class()); 
+    if (const Keyword* keyword = FindKeyword(s)) {
+        return keyword->make();
     }
     
-    if (s == "return"s) {
-        return Token(token_type::Return()); 
-    }
-    
-    if (s == "if"s) {
-        return Token(token_type::If()); 
-    }
-    
-    if (s == "else"s) {
-        return Token(token_type::Else()); 
-    }
-    
-    if (s == "def"s) {
-        return Token(token_type::Def()); 
-    }
-    
-    if (s == "print"s) {
-        return Token(token_type::Print()); 
-    }
-    
-    if (s == "and"s) {
-        return Token(token_type::And()); 
-    }
-    
-    if (s == "or"s) {
-        return Token(token_type::Or()); 
-    }
-    
-    if (s == "not"s) {
-        return Token(token_type::Not()); 
-    }
-    
-    if (s == "None"s) {
-        return Token(token_type::None()); 
-    }
-    
-    if (s == "True"s) {
-        return Token(token_type::True()); 
-    }
-    
-    if (s == "False"s) {
-        return Token(token_type::False()); 
-    }
-    
-    return Token(token_type::Id{s});    
+    const runtime::Symbol symbol(s);
+    // имя в таблице символов не перемещается, в отличие от текста в буфере ввода
+    return Token(token_type::Id{TokenText::Ref(buffer.empty() ? s : symbol.GetName()), symbol});
 }
     
-void Lexer::SkipComment(std::istream& input) {
-    while ((!input.eof()) && (input.peek() != '\n')) {
-        input.get();
-    }
+void Lexer::SkipComment() {
+    pos = scan::FindNewline(pos, end);
 }
     
 }  // namespace parse
\ No newline at end of file
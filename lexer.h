@@ -1,21 +1,55 @@
 #pragma once
 
+#include "symbol.h"
+
+#include <cstddef>
 #include <iosfwd>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <variant>
 
 namespace parse {
 
+// Текст лексемы: срез исходного текста либо собственная строка.
+// Собственная строка создаётся только для строковых констант с escape-последовательностями
+// и для лексем, созданных вне лексического анализатора
+class TokenText {
+public:
+    TokenText() = default;
+    TokenText(std::string text);
+    TokenText(const char* text);
+
+    // Создаёт текст, ссылающийся на срез text без копирования.
+    // Срез должен оставаться действительным, пока используется лексема
+    static TokenText Ref(std::string_view text);
+
+    [[nodiscard]] std::string_view View() const;
+    // Возвращает true, если текст хранится в собственной строке
+    [[nodiscard]] bool IsOwned() const;
+
+    operator std::string() const;
+
+private:
+    std::string owned;
+    std::string_view view;
+    bool isOwned = false;
+};
+
+bool operator==(const TokenText& lhs, const TokenText& rhs);
+bool operator!=(const TokenText& lhs, const TokenText& rhs);
+std::ostream& operator<<(std::ostream& os, const TokenText& rhs);
+
 namespace token_type {
 struct Number {  // Лексема «число»
     int value;   // число
 };
 
-struct Id {             // Лексема «идентификатор»
-    std::string value;  // Имя идентификатора
+struct Id {                    // Лексема «идентификатор»
+    TokenText value;           // Имя идентификатора
+    runtime::Symbol symbol{};  // Имя, интернированное лексером (в сравнении не участвует)
 };
 
 struct Char {    // Лексема «символ»
@@ -23,7 +57,7 @@ struct Char {    // Лексема «символ»
 };
 
 struct String {  // Лексема «строковая константа»
-    std::string value;
+    TokenText value;
 };
 
 struct Class {};    // Лексема «class»
@@ -85,15 +119,39 @@ public:
     using std::runtime_error::runtime_error;
 };
 
-class Lexer {
+// Исходный текст программы, отображённый в память только для чтения
+class MappedFile {
 public:
-    explicit Lexer(std::istream& input);
+    // Отображает файл path в память. При ошибке выбрасывает std::runtime_error
+    explicit MappedFile(const std::string& path);
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    [[nodiscard]] std::string_view Text() const;
+
+private:
+    void Unmap();
+
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+// Источник токенов для синтаксического анализатора: лексер или буфер заранее
+// разобранных токенов (см. TokenBuffer)
+class TokenSource {
+public:
+    virtual ~TokenSource() = default;
 
     // Возвращает ссылку на текущий токен или token_type::Eof, если поток токенов закончился
-    [[nodiscard]] const Token& CurrentToken() const;
+    [[nodiscard]] const Token& CurrentToken() const {
+        return currentToken;
+    }
 
     // Возвращает следующий токен, либо token_type::Eof, если поток токенов закончился
-    Token NextToken();
+    virtual const Token& NextToken() = 0;
 
     // Если текущий токен имеет тип T, метод возвращает ссылку на него.
     // В противном случае метод выбрасывает исключение LexerError
@@ -128,50 +186,102 @@ public:
     // В противном случае метод выбрасывает исключение LexerError
     template <typename T>
     const T& ExpectNext() {
-        using namespace std::literals;
         NextToken();
-        if (currentToken.Is<T>()) {
-            return currentToken.As<T>();
-        } else {
-            throw LexerError("Not implemented"s);
-        }
+        return Expect<T>();
     }
 
     // Метод проверяет, что следующий токен имеет тип T, а сам токен содержит значение value.
     // В противном случае метод выбрасывает исключение LexerError
     template <typename T, typename U>
     void ExpectNext(const U& value) {
-        using namespace std::literals;
         NextToken();
-        if (currentToken.Is<T>()) {
-            auto p = currentToken.TryAs<T>();
-            if (p && (static_cast<U>(p->value) == value)) {
-                return;
-            } else {
-                throw LexerError("Not implemented"s);
-            }
-        } else {
-            throw LexerError("Not implemented"s);
-        }
+        Expect<T>(value);
     }
 
-private:
+protected:
     Token currentToken = token_type::Eof();
-    std::istream& in;
+};
+
+class Lexer : public TokenSource {
+public:
+    // Размер буфера ввода по умолчанию при чтении из потока или файлового дескриптора
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    /*
+     * Читает текст из потока input блоками в буфер размера buffer_size, который
+     * заполняется заново по мере разбора. Память не зависит от длины текста: буфер
+     * увеличивается, только если в нём не помещается одна строка программы.
+     * Токены Id и String не ссылаются на буфер
+     */
+    explicit Lexer(std::istream& input, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    // Читает текст из файлового дескриптора fd вызовами read(2), как и лексер потока.
+    // Дескриптор не закрывается
+    explicit Lexer(int fd, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    // То же, но ожидание ввода прерывается, как только дескриптор interrupt_fd станет
+    // доступен для чтения: текст считается законченным
+    Lexer(int fd, size_t buffer_size, int interrupt_fd);
+    // Разбирает текст source без копирования. Токены Id и String ссылаются на source,
+    // поэтому source должен оставаться действительным, пока используются токены
+    explicit Lexer(std::string_view source);
+
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
+
+    const Token& NextToken() override;
+
+    // Возвращает смещение начала текущего токена от начала текста
+    [[nodiscard]] size_t CurrentOffset() const;
+
+    // Возвращает размер буфера ввода (0, если текст передан целиком)
+    [[nodiscard]] size_t BufferSize() const;
+
+    // Возвращает true, если прочитанный текст разобран и следующий токен может
+    // потребовать чтения ввода, которое заблокирует поток
+    [[nodiscard]] bool NeedsInput() const;
+
+private:
+    // буфер ввода, если лексер читает поток или файловый дескриптор
+    std::string buffer;
+    std::istream* input = nullptr;
+    int inputFd = -1;
+    // дескриптор, прерывающий ожидание ввода из inputFd
+    int interruptFd = -1;
+    // количество прочитанных в буфер байтов
+    size_t filled = 0;
+    // смещение начала буфера от начала текста
+    size_t bufferOffset = 0;
+    // весь текст прочитан
+    bool inputDone = true;
+    // начало текста в буфере, начало текущего токена, текущая позиция и конец
+    // прочитанных целиком строк
+    const char* begin = nullptr;
+    const char* tokenStart = nullptr;
+    const char* pos = nullptr;
+    const char* end = nullptr;
     bool emptyLine = true;
-    int newOffset, offsetSpace = 0;
+    int newOffset = 0, offsetSpace = 0;
+
+    // проверка на конец текста; при необходимости дочитывает текст в буфер
+    [[nodiscard]] bool AtEnd();
+
+    // Сдвигает начало текущего токена в начало буфера и дочитывает в буфер текст до
+    // конца хотя бы одной строки. Возвращает false, если текст закончился
+    bool Refill();
+
+    // чтение очередного блока текста в dst; 0 означает конец текста
+    size_t ReadInput(char* dst, size_t size);
 
-    // чтение токена из потока
-    Token ReadToken(std::istream& input);
+    // чтение токена из текста
+    Token ReadToken();
     
     // чтение двойных символов (сравнение)
-    Token ReadMultiplyChar(char c, std::istream& input);
+    Token ReadMultiplyChar(char c);
     
     // чтение одиночных символов (сравнение)
     Token ReadSingleChar(char c);
     
     // чтение чисел
-    Token ReadNumber(char first, std::istream& input);
+    Token ReadNumber(const char* first);
     
     //проверка на цифровой символ
     bool IsDigit(char c);
@@ -183,16 +293,16 @@ private:
     bool IsAplhabeticOrDigit(char c);
     
     // чтение строк 
-    Token ReadString(char first, std::istream& input);
+    Token ReadString(char first);
     
     // чтение начального отступа
-    int ReadOffset(std::istream& input);
+    int ReadOffset();
     
     // чтение символьного токена (идентификатор или служебное слово)
-    Token ReadSymbolToken(char first, std::istream& input);
+    Token ReadSymbolToken(const char* first);
     
     // пропуск комментария
-    void SkipComment(std::istream& input);
+    void SkipComment();
     
 };
 
@@ -1,8 +1,13 @@
 #include "lexer.h"
 #include "test_runner_p.h"
 
+#include <cstdio>
+#include <fstream>
 #include <sstream>
 #include <string>
+#include <thread>
+
+#include <unistd.h>
 
 using namespace std;
 
@@ -40,6 +45,20 @@ void TestKeywords() {
     ASSERT_EQUAL(lexer.NextToken(), Token(token_type::False{}));
 }
 
+void TestIdsSimilarToKeywords() {
+    // Слова с той же длиной, первой и последней буквой, что и служебные слова
+    const string source = "cross rein it ease dad plant aid on nut Nine Tape Fable classes"s;
+    Lexer lexer(string_view{source});
+
+    istringstream words(source);
+    string word;
+    words >> word;
+    ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{word}));
+    while (words >> word) {
+        ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{word}));
+    }
+}
+
 void TestNumbers() {
     istringstream input("42 15 -53"s);
     Lexer lexer(input);
@@ -351,6 +370,211 @@ abc#
         ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
     }
 }
+
+void TestTokensReferToSourceBuffer() {
+    const string source = "name = 'plain' + \"esc\\taped\"\n"s;
+    Lexer lexer(string_view{source});
+
+    const auto& id = lexer.Expect<token_type::Id>().value;
+    ASSERT(!id.IsOwned());
+    ASSERT_EQUAL(id.View().data(), source.data());
+    ASSERT_EQUAL(id, "name"s);
+
+    lexer.ExpectNext<token_type::Char>('=');
+    const auto& plain = lexer.ExpectNext<token_type::String>().value;
+    ASSERT(!plain.IsOwned());
+    ASSERT_EQUAL(plain.View().data(), source.data() + source.find("plain"s));
+
+    lexer.ExpectNext<token_type::Char>('+');
+    const auto& escaped = lexer.ExpectNext<token_type::String>().value;
+    ASSERT(escaped.IsOwned());
+    ASSERT_EQUAL(escaped, "esc\taped"s);
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
+}
+
+void TestBufferAndStreamProduceSameTokens() {
+    const string source = R"(
+class Counter:
+  def add(self, n):
+    # comment
+    if n >= 10 and not n == 15:
+      return 'big'
+    return "small"
+
+print Counter().add(12345)
+)"s;
+    istringstream input(source);
+    Lexer stream_lexer(input);
+    Lexer buffer_lexer(string_view{source});
+
+    while (true) {
+        ASSERT_EQUAL(buffer_lexer.CurrentToken(), stream_lexer.CurrentToken());
+        if (buffer_lexer.CurrentToken().Is<token_type::Eof>()) {
+            break;
+        }
+        buffer_lexer.NextToken();
+        stream_lexer.NextToken();
+    }
+}
+
+void TestBlocksAreClosedAtEndOfText() {
+    Lexer lexer(string_view{"if x:\n  y"});
+
+    ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::If{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{"x"s}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{':'}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Indent{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{"y"s}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Dedent{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
+}
+
+void TestMappedFile() {
+    const string path = "mython_lexer_test.my"s;
+    {
+        ofstream out(path);
+        out << "x = 'mapped'\n"s;
+    }
+    {
+        MappedFile file(path);
+        Lexer lexer(file.Text());
+        ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{"x"s}));
+        ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{'='}));
+        ASSERT_EQUAL(lexer.NextToken(), Token(token_type::String{"mapped"s}));
+        ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
+        ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
+    }
+    std::remove(path.c_str());
+
+    ASSERT_THROWS(MappedFile("no_such_mython_file.my"s), std::runtime_error);
+}
+
+void TestLongRunsOfBlankLinesAndComments() {
+    // Пропуск строк не использует рекурсию, поэтому стек не переполняется
+    string source = "x = 1\n"s;
+    for (int i = 0; i < 500000; ++i) {
+        source += (i % 2 == 0) ? "\n"s : "    # comment\n"s;
+    }
+    source += "y\n"s;
+    Lexer lexer(string_view{source});
+
+    ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{"x"s}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{'='}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{1}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{"y"s}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
+}
+
+// Проверяет, что лексер lexer выдаёт те же токены с теми же смещениями, что и разбор
+// текста source целиком
+void AssertSameTokensAsSource(Lexer& lexer, const string& source) {
+    Lexer reference(string_view{source});
+    while (true) {
+        ASSERT_EQUAL(lexer.CurrentToken(), reference.CurrentToken());
+        ASSERT_EQUAL(lexer.CurrentOffset(), reference.CurrentOffset());
+        if (reference.CurrentToken().Is<token_type::Eof>()) {
+            break;
+        }
+        reference.NextToken();
+        lexer.NextToken();
+    }
+}
+
+void TestStreamingWithSmallBuffer() {
+    const string source = R"(class Counter:
+  def add(n):
+    # comment longer than the input buffer
+    if n >= 10 and not n == 15:
+      return 'big' + "esc\"aped"
+
+print Counter().add(12345), a_very_long_identifier_name
+  x = 'last line without newline')"s;
+    for (size_t buffer_size : {1U, 4U, 7U, 64U}) {
+        istringstream input(source);
+        Lexer lexer(input, buffer_size);
+        AssertSameTokensAsSource(lexer, source);
+    }
+}
+
+void TestStreamingTokensOwnTheirText() {
+    istringstream input("name = 'text'\n"s);
+    Lexer lexer(input, 4);
+
+    const Token name = lexer.CurrentToken();
+    lexer.ExpectNext<token_type::Char>('=');
+    const Token text = lexer.NextToken();
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
+
+    // токены остаются действительными после того, как буфер перезаписан
+    ASSERT_EQUAL(name, Token(token_type::Id{"name"s}));
+    ASSERT_EQUAL(name.As<token_type::Id>().symbol, runtime::Symbol("name"sv));
+    ASSERT(text.As<token_type::String>().value.IsOwned());
+    ASSERT_EQUAL(text, Token(token_type::String{"text"s}));
+}
+
+// Поток, генерирующий lines одинаковых строк программы без хранения всего текста
+class GeneratedProgram : public std::streambuf {
+public:
+    GeneratedProgram(string line, size_t lines)
+        : line_(std::move(line))
+        , lines_(lines) {
+    }
+
+protected:
+    int_type underflow() override {
+        if (lines_ == 0) {
+            return traits_type::eof();
+        }
+        --lines_;
+        setg(line_.data(), line_.data(), line_.data() + line_.size());
+        return traits_type::to_int_type(line_.front());
+    }
+
+private:
+    string line_;
+    size_t lines_;
+};
+
+void TestStreamingMemoryIsBounded() {
+    constexpr size_t LINES = 100000;
+    GeneratedProgram program("counter = counter + 'step'\n"s, LINES);
+    istream input(&program);
+    Lexer lexer(input, 256);
+
+    size_t newlines = 0;
+    while (!lexer.CurrentToken().Is<token_type::Eof>()) {
+        newlines += lexer.CurrentToken().Is<token_type::Newline>() ? 1 : 0;
+        lexer.NextToken();
+    }
+    ASSERT_EQUAL(newlines, LINES);
+    ASSERT_EQUAL(lexer.BufferSize(), 256U);
+}
+
+void TestLexerReadsFileDescriptor() {
+    const string source = "x = 'from pipe'\nif x:\n  print x\n"s;
+    int fds[2];
+    ASSERT_EQUAL(pipe(fds), 0);
+    std::thread writer([&source, fd = fds[1]] {
+        // текст пишется частями, как при чтении из конвейера
+        for (char c : source) {
+            if (write(fd, &c, 1) != 1) {
+                break;
+            }
+        }
+        close(fd);
+    });
+
+    Lexer lexer(fds[0], 8);
+    AssertSameTokensAsSource(lexer, source);
+    writer.join();
+    close(fds[0]);
+}
 }  // namespace
 
 void RunOpenLexerTests(TestRunner& tr) {
@@ -358,6 +582,7 @@ void RunOpenLexerTests(TestRunner& tr) {
     RUN_TEST(tr, parse::TestKeywords);
     RUN_TEST(tr, parse::TestNumbers);
     RUN_TEST(tr, parse::TestIds);
+    RUN_TEST(tr, parse::TestIdsSimilarToKeywords);
     RUN_TEST(tr, parse::TestStrings);
     RUN_TEST(tr, parse::TestOperations);
     RUN_TEST(tr, parse::TestIndentsAndNewlines);
@@ -367,6 +592,15 @@ void RunOpenLexerTests(TestRunner& tr) {
     RUN_TEST(tr, parse::TestMythonProgram);
     RUN_TEST(tr, parse::TestAlwaysEmitsNewlineAtTheEndOfNonemptyLine);
     RUN_TEST(tr, parse::TestCommentsAreIgnored);
+    RUN_TEST(tr, parse::TestTokensReferToSourceBuffer);
+    RUN_TEST(tr, parse::TestBufferAndStreamProduceSameTokens);
+    RUN_TEST(tr, parse::TestBlocksAreClosedAtEndOfText);
+    RUN_TEST(tr, parse::TestMappedFile);
+    RUN_TEST(tr, parse::TestLongRunsOfBlankLinesAndComments);
+    RUN_TEST(tr, parse::TestStreamingWithSmallBuffer);
+    RUN_TEST(tr, parse::TestStreamingTokensOwnTheirText);
+    RUN_TEST(tr, parse::TestStreamingMemoryIsBounded);
+    RUN_TEST(tr, parse::TestLexerReadsFileDescriptor);
 }
 
 }  // namespace parse
\ No newline at end of file
@@ -3,34 +3,70 @@
 #include "runtime.h"
 #include "statement.h"
 #include "test_runner_p.h"
+#include "token_buffer.h"
+#include "token_cache.h"
+#include "token_pipeline.h"
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
+
+#include <unistd.h>
 
 using namespace std;
 
 namespace parse {
 void RunOpenLexerTests(TestRunner& tr);
+void RunTokenBufferTests(TestRunner& tr);
+void RunTokenCacheTests(TestRunner& tr);
+void RunTokenPipelineTests(TestRunner& tr);
+namespace scan {
+void RunTextScanTests(TestRunner& tr);
+}  // namespace scan
 }  // namespace parse
 
 namespace ast {
 void RunUnitTests(TestRunner& tr);
+void RunArenaTests(TestRunner& tr);
+void RunFoldTests(TestRunner& tr);
+void RunFuseTests(TestRunner& tr);
+void RunInlineTests(TestRunner& tr);
 }
 namespace runtime {
 void RunObjectHolderTests(TestRunner& tr);
 void RunObjectsTests(TestRunner& tr);
+void RunIntArrayTests(TestRunner& tr);
+void RunHostObjectTests(TestRunner& tr);
+void RunSymbolTests(TestRunner& tr);
 }  // namespace runtime
 
 void TestParseProgram(TestRunner& tr);
+void TestCompiledPrograms(TestRunner& tr);
+void TestBatchEvaluation(TestRunner& tr);
+void TestIncrementalPrograms(TestRunner& tr);
 
 namespace {
 
-void RunMythonProgram(istream& input, ostream& output) {
-    parse::Lexer lexer(input);
-    auto program = ParseProgram(lexer);
-
+void ExecuteProgram(runtime::Executable& program, ostream& output) {
     runtime::SimpleContext context{output};
     runtime::Closure closure;
-    program->Execute(closure, context);
+    program.Execute(closure, context);
+}
+
+void RunMythonProgram(const parse::TokenBuffer& tokens, ostream& output) {
+    ExecuteProgram(*ParseProgram(tokens, ParseOptions{}), output);
+}
+
+void RunMythonProgram(istream& input, ostream& output) {
+    // разбор на токены идёт в отдельном потоке одновременно с построением дерева
+    parse::TokenPipeline tokens(input);
+    ExecuteProgram(*ParseProgram(tokens, ParseOptions{}), output);
+}
+
+void RunMythonProgram(int fd, ostream& output) {
+    // текст читается из дескриптора буфером фиксированного размера
+    parse::TokenPipeline tokens(fd);
+    ExecuteProgram(*ParseProgram(tokens, ParseOptions{}), output);
 }
 
 void TestSimplePrints() {
@@ -114,10 +150,24 @@ print y.value
 void TestAll() {
     TestRunner tr;
     parse::RunOpenLexerTests(tr);
+    parse::scan::RunTextScanTests(tr);
+    parse::RunTokenBufferTests(tr);
+    parse::RunTokenCacheTests(tr);
+    parse::RunTokenPipelineTests(tr);
+    runtime::RunSymbolTests(tr);
     runtime::RunObjectHolderTests(tr);
     runtime::RunObjectsTests(tr);
+    runtime::RunIntArrayTests(tr);
+    runtime::RunHostObjectTests(tr);
     ast::RunUnitTests(tr);
+    ast::RunArenaTests(tr);
+    ast::RunFoldTests(tr);
+    ast::RunFuseTests(tr);
+    ast::RunInlineTests(tr);
     TestParseProgram(tr);
+    TestCompiledPrograms(tr);
+    TestBatchEvaluation(tr);
+    TestIncrementalPrograms(tr);
 
     RUN_TEST(tr, TestSimplePrints);
     RUN_TEST(tr, TestAssignments);
@@ -127,11 +177,23 @@ void TestAll() {
 
 }  // namespace
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
         TestAll();
 
-        RunMythonProgram(cin, cout);
+        if (argc > 1) {
+            // текст программы из файла разбирается на токены без копирования
+            // параллельно в нескольких потоках; токены текста, не менявшегося
+            // с прошлого запуска, читаются из кэша токенов. Дерево программы
+            // строится из токенов при каждом запуске
+            parse::MappedFile source(argv[1]);
+            parse::TokenCache cache(parse::TokenCache::DefaultDirectory());
+            RunMythonProgram(cache.Tokenize(source.Text(),
+                                            std::max(1U, std::thread::hardware_concurrency())),
+                             cout);
+        } else {
+            RunMythonProgram(STDIN_FILENO, cout);
+        }
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
 		return 1;
@@ -1,13 +1,23 @@
 #include "parse.h"
 
+#include "ast_arena.h"
+#include "ast_fold.h"
+#include "ast_fuse.h"
 #include "lexer.h"
 #include "statement.h"
+#include "token_buffer.h"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
 
 using namespace std;
 
 namespace TokenType = parse::token_type;
 
 namespace {
+const runtime::Symbol STR_FUNCTION{"str"s};
+
 bool operator==(const parse::Token& token, char c) {
     const auto* p = token.TryAs<TokenType::Char>();
     return p != nullptr && p->value == c;
@@ -17,10 +27,199 @@ bool operator!=(const parse::Token& token, char c) {
     return !(token == c);
 }
 
+// Операция выражения, ожидающая правого операнда, либо открытая скобка или вызов
+enum Operation : uint8_t { OR, AND, NOT, COMPARISON, ADD, SUB, MULT, DIV, NEGATE, GROUP, CALL };
+
+// Приоритеты операций: операция с большим приоритетом выполняется раньше.
+// Скобки и вызовы имеют нулевой приоритет и не сворачиваются бинарными операциями
+constexpr int PRECEDENCE[] = {
+    1,  // OR
+    2,  // AND
+    3,  // NOT
+    4,  // COMPARISON
+    5,  // ADD
+    5,  // SUB
+    6,  // MULT
+    6,  // DIV
+    7,  // NEGATE
+    0,  // GROUP
+    0,  // CALL
+};
+
+struct PendingOperation {
+    Operation operation;
+    // операция сравнения для COMPARISON
+    ast::ComparisonOp comparison = ast::ComparisonOp::EQUAL;
+    // имена и уже разобранные аргументы для CALL
+    vector<runtime::Symbol> names = {};
+    vector<unique_ptr<ast::Statement>> args = {};
+};
+
+// Возвращает бинарную операцию, обозначаемую токеном tok, если она есть
+optional<PendingOperation> BinaryOperationOf(const parse::Token& tok) {
+    if (const auto* ch = tok.TryAs<TokenType::Char>()) {
+        switch (ch->value) {
+            case '+':
+                return PendingOperation{ADD};
+            case '-':
+                return PendingOperation{SUB};
+            case '*':
+                return PendingOperation{MULT};
+            case '/':
+                return PendingOperation{DIV};
+            case '<':
+                return PendingOperation{COMPARISON, ast::ComparisonOp::LESS};
+            case '>':
+                return PendingOperation{COMPARISON, ast::ComparisonOp::GREATER};
+            default:
+                return nullopt;
+        }
+    }
+    if (tok.Is<TokenType::Or>()) {
+        return PendingOperation{OR};
+    }
+    if (tok.Is<TokenType::And>()) {
+        return PendingOperation{AND};
+    }
+    if (tok.Is<TokenType::Eq>()) {
+        return PendingOperation{COMPARISON, ast::ComparisonOp::EQUAL};
+    }
+    if (tok.Is<TokenType::NotEq>()) {
+        return PendingOperation{COMPARISON, ast::ComparisonOp::NOT_EQUAL};
+    }
+    if (tok.Is<TokenType::LessOrEq>()) {
+        return PendingOperation{COMPARISON, ast::ComparisonOp::LESS_OR_EQUAL};
+    }
+    if (tok.Is<TokenType::GreaterOrEq>()) {
+        return PendingOperation{COMPARISON, ast::ComparisonOp::GREATER_OR_EQUAL};
+    }
+    return nullopt;
+}
+
+// Создаёт узел операции op над операндами lhs и rhs (для унарных операций rhs пуст).
+// Если !type_feedback, узел не собирает обратную связь по типам
+unique_ptr<ast::Statement> MakeOperation(const PendingOperation& op, unique_ptr<ast::Statement> lhs,
+                                         unique_ptr<ast::Statement> rhs, bool type_feedback) {
+    switch (op.operation) {
+        case NOT:
+            return make_unique<ast::Not>(std::move(lhs));
+        case NEGATE:
+            return make_unique<ast::Negate>(std::move(lhs));
+        case OR:
+            return make_unique<ast::Or>(std::move(lhs), std::move(rhs));
+        case AND:
+            return make_unique<ast::And>(std::move(lhs), std::move(rhs));
+        case COMPARISON: {
+            auto comparison = ast::MakeComparison(op.comparison, std::move(lhs), std::move(rhs));
+            if (!type_feedback) {
+                comparison->DisableTypeFeedback();
+            }
+            return comparison;
+        }
+        case ADD: {
+            auto add = make_unique<ast::Add>(std::move(lhs), std::move(rhs));
+            if (!type_feedback) {
+                add->DisableTypeFeedback();
+            }
+            return add;
+        }
+        case SUB: {
+            auto sub = make_unique<ast::Sub>(std::move(lhs), std::move(rhs));
+            if (!type_feedback) {
+                sub->DisableTypeFeedback();
+            }
+            return sub;
+        }
+        case MULT:
+            return make_unique<ast::Mult>(std::move(lhs), std::move(rhs));
+        case DIV:
+            return make_unique<ast::Div>(std::move(lhs), std::move(rhs));
+        default:
+            return nullptr;
+    }
+}
+
+// Применяет операции с вершины стека, пока их приоритет не меньше min_precedence.
+// Если fold_constants, операции над константами сразу вычисляются (см. ast::FoldConstants)
+void ReduceOperations(vector<unique_ptr<ast::Statement>>& operands,
+                      vector<PendingOperation>& operations, int min_precedence,
+                      bool fold_constants, bool type_feedback) {
+    while (!operations.empty() && PRECEDENCE[operations.back().operation] >= min_precedence) {
+        const PendingOperation op = std::move(operations.back());
+        operations.pop_back();
+
+        unique_ptr<ast::Statement> rhs;
+        if (op.operation != NOT && op.operation != NEGATE) {
+            rhs = std::move(operands.back());
+            operands.pop_back();
+        }
+        auto result = MakeOperation(op, std::move(operands.back()), std::move(rhs), type_feedback);
+        operands.back() = fold_constants ? ast::FoldConstants(std::move(result)) : std::move(result);
+    }
+}
+
+// Общие данные методов программы, разбор тел которых отложен (см. ParseOptions::lazy_methods)
+struct LazyMethods {
+    shared_ptr<const parse::TokenBuffer> tokens;
+    const runtime::Builtins* builtins;
+    bool fold_constants;
+    bool fuse_statements;
+    ast::InlineLimits inline_limits;
+    bool bind_methods;
+    bool type_feedback;
+    // объявленные классы и порядковые номера их объявления
+    unordered_map<runtime::Symbol, pair<const runtime::Class*, size_t>> classes = {};
+};
+
 class Parser {
 public:
-    explicit Parser(parse::Lexer& lexer)
-        : lexer_(lexer) {
+    Parser(parse::TokenSource& lexer, const ParseOptions& options)
+        : lexer_(lexer)
+        , builtins_(options.builtins ? *options.builtins : runtime::Builtins::Default())
+        , fold_constants_(options.fold_constants)
+        , fuse_statements_(options.fuse_statements)
+        , inline_limits_(options.inline_limits)
+        , bind_methods_(options.bind_methods)
+        , type_feedback_(options.type_feedback) {
+        for (size_t i = 0; i < options.inputs.size(); ++i) {
+            slots_[runtime::Symbol(options.inputs[i])] = i;
+        }
+    }
+
+    // Разбор с классами classes, объявленными до текста, и переиспользуемыми
+    // объектами классов reused_classes (см. ParseStatements)
+    Parser(parse::TokenSource& lexer, const ParseOptions& options, runtime::Closure& classes,
+           const runtime::Closure& reused_classes)
+        : Parser(lexer, options) {
+        declared_classes_ = &classes;
+        reused_classes_ = &reused_classes;
+    }
+
+    // Разбор отложенного тела метода. Тексту метода видны visible_classes первых
+    // объявленных классов; узлы размещаются в арене arena
+    Parser(parse::TokenSource& lexer, shared_ptr<LazyMethods> lazy, size_t visible_classes,
+           const ast::Arena* arena)
+        : arena_(arena)
+        , lexer_(lexer)
+        , builtins_(*lazy->builtins)
+        , fold_constants_(lazy->fold_constants)
+        , fuse_statements_(lazy->fuse_statements)
+        , inline_limits_(lazy->inline_limits)
+        , bind_methods_(lazy->bind_methods)
+        , type_feedback_(lazy->type_feedback)
+        , lazy_(std::move(lazy))
+        , visible_classes_(visible_classes)
+        , method_depth_(1) {
+    }
+
+    // Откладывает разбор тел методов до первого вызова. cursor - источник токенов
+    // парсера, просматривающий буфер tokens
+    void DeferMethodBodies(const parse::TokenCursor& cursor,
+                           shared_ptr<const parse::TokenBuffer> tokens) {
+        cursor_ = &cursor;
+        lazy_ = make_shared<LazyMethods>(LazyMethods{std::move(tokens), &builtins_, fold_constants_,
+                                                      fuse_statements_, inline_limits_,
+                                                      bind_methods_, type_feedback_});
     }
 
     // Program -> eps
@@ -34,7 +233,46 @@ public:
         return result;
     }
 
+    // Разбирает инструкции верхнего уровня по одной, пока on_statement возвращает true
+    void ParseStatements(const StatementHandler& on_statement) {
+        while (!lexer_.CurrentToken().Is<TokenType::Eof>()) {
+            const size_t classes_before = new_classes_.size();
+            auto statement = ParseStatement();
+            vector<runtime::ObjectHolder> classes(
+                new_classes_.begin() + static_cast<ptrdiff_t>(classes_before), new_classes_.end());
+            if (!on_statement(std::move(statement), std::move(classes))) {
+                return;
+            }
+        }
+    }
+
+    // SingleExpression -> Test [Newline] Eof
+    unique_ptr<ast::Statement> ParseSingleExpression() {
+        auto result = ParseTest();
+        if (lexer_.CurrentToken().Is<TokenType::Newline>()) {
+            lexer_.NextToken();
+        }
+        if (!lexer_.CurrentToken().Is<TokenType::Eof>()) {
+            throw ParseError("Unexpected tokens after expression"s);
+        }
+        return result;
+    }
+
+    // MethodBody -> Suite
+    unique_ptr<ast::Statement> ParseMethodBody() {
+        // переменные метода не связаны с переменными программы
+        auto outer_classes = std::exchange(instance_classes_, {});
+        auto body = Fuse(make_unique<ast::MethodBody>(ParseSuite()));
+        instance_classes_ = std::move(outer_classes);
+        return body;
+    }
+
 private:
+    // Заменяет инструкцию объединённым узлом, если это разрешено (см. ast::FuseStatement)
+    unique_ptr<ast::Statement> Fuse(unique_ptr<ast::Statement> node) const {
+        return fuse_statements_ ? ast::FuseStatement(std::move(node)) : std::move(node);
+    }
+
     // Suite -> NEWLINE INDENT (Statement)+ DEDENT
     unique_ptr<ast::Statement> ParseSuite()  // NOLINT
     {
@@ -54,6 +292,46 @@ private:
         return result;
     }
 
+    // Пропускает блок Suite, проверяя парность скобок в каждой строке.
+    // Отступы уже проверены лексером
+    void SkipSuite() {
+        lexer_.Expect<TokenType::Newline>();
+        lexer_.ExpectNext<TokenType::Indent>();
+
+        size_t depth = 1;
+        int brackets = 0;
+        while (depth > 0) {
+            const auto& tok = lexer_.NextToken();
+            if (tok.Is<TokenType::Indent>()) {
+                ++depth;
+            } else if (tok.Is<TokenType::Dedent>()) {
+                --depth;
+            } else if (tok == '(') {
+                ++brackets;
+            } else if (tok == ')') {
+                if (--brackets < 0) {
+                    throw ParseError("Unmatched ')' in method body"s);
+                }
+            } else if (tok.Is<TokenType::Newline>() && brackets != 0) {
+                throw ParseError("Unmatched '(' in method body"s);
+            } else if (tok.Is<TokenType::Eof>()) {
+                throw ParseError("Unexpected end of method body"s);
+            }
+        }
+        lexer_.NextToken();
+    }
+
+    // Пропускает тело метода и возвращает узел, который разберёт его при первом вызове
+    unique_ptr<ast::Statement> ParseLazyMethodBody() {
+        const size_t position = cursor_->Position();
+        SkipSuite();
+        return make_unique<ast::LazyMethodBody>(
+            [lazy = lazy_, position, visible = lazy_->classes.size()](const ast::Arena* arena) {
+                parse::TokenCursor cursor(*lazy->tokens, position);
+                return Parser(cursor, lazy, visible, arena).ParseMethodBody();
+            });
+    }
+
     // Methods -> [def id(Params) : Suite]*
     vector<runtime::Method> ParseMethods()  // NOLINT
     {
@@ -62,13 +340,13 @@ private:
         while (lexer_.CurrentToken().Is<TokenType::Def>()) {
             runtime::Method m;
 
-            m.name = lexer_.ExpectNext<TokenType::Id>().value;
+            m.name = lexer_.ExpectNext<TokenType::Id>().symbol;
             lexer_.ExpectNext<TokenType::Char>('(');
 
             if (lexer_.NextToken().Is<TokenType::Id>()) {
-                m.formal_params.push_back(lexer_.Expect<TokenType::Id>().value);
+                m.formal_params.push_back(lexer_.Expect<TokenType::Id>().symbol);
                 while (lexer_.NextToken() == ',') {
-                    m.formal_params.push_back(lexer_.ExpectNext<TokenType::Id>().value);
+                    m.formal_params.push_back(lexer_.ExpectNext<TokenType::Id>().symbol);
                 }
             }
 
@@ -76,7 +354,9 @@ private:
             lexer_.ExpectNext<TokenType::Char>(':');
             lexer_.NextToken();
 
-            m.body = std::make_unique<ast::MethodBody>(ParseSuite());  // NOLINT
+            ++method_depth_;
+            m.body = cursor_ != nullptr ? ParseLazyMethodBody() : ParseMethodBody();  // NOLINT
+            --method_depth_;
 
             result.push_back(std::move(m));
         }
@@ -92,15 +372,14 @@ private:
 
         const runtime::Class* base_class = nullptr;
         if (lexer_.CurrentToken() == '(') {
-            auto name = lexer_.ExpectNext<TokenType::Id>().value;
+            string name = lexer_.ExpectNext<TokenType::Id>().value;
             lexer_.ExpectNext<TokenType::Char>(')');
             lexer_.NextToken();
 
-            auto it = declared_classes_.find(name);
-            if (it == declared_classes_.end()) {
+            base_class = FindClass(runtime::Symbol(name));
+            if (base_class == nullptr) {
                 throw ParseError("Base class "s + name + " not found for class "s + class_name);
             }
-            base_class = static_cast<const runtime::Class*>(it->second.Get());  // NOLINT
         }
 
         lexer_.Expect<TokenType::Char>(':');
@@ -112,51 +391,99 @@ private:
         lexer_.Expect<TokenType::Dedent>();
         lexer_.NextToken();
 
-        auto [it, inserted] = declared_classes_.insert({
-            class_name,
-            runtime::ObjectHolder::Own(runtime::Class(class_name, std::move(methods), base_class)),
-        });
-
-        if (!inserted) {
+        const runtime::Symbol class_symbol(class_name);
+        if (declared_classes_->count(class_symbol) > 0) {
             throw ParseError("Class "s + class_name + " already exists"s);
         }
+        runtime::Class cls(class_name, std::move(methods), base_class);
+        runtime::ObjectHolder holder;
+        if (auto it = reused_classes_->find(class_symbol); it != reused_classes_->end()) {
+            // прежний объект класса получает новое определение, так что ссылки на него
+            // из ранее разобранных инструкций остаются действительными
+            holder = it->second;
+            *holder.TryAs<runtime::Class>() = std::move(cls);
+        } else {
+            holder = runtime::ObjectHolder::Own(std::move(cls));
+        }
+        (*declared_classes_)[class_symbol] = holder;
+        new_classes_.push_back(holder);
+        if (lazy_) {
+            lazy_->classes.emplace(class_name,
+                                   pair{holder.TryAs<runtime::Class>(), lazy_->classes.size()});
+        }
+
+        return make_unique<ast::ClassDefinition>(holder);
+    }
 
-        return make_unique<ast::ClassDefinition>(it->second);
+    // Возвращает объявленный класс name или nullptr. Отложенному телу метода видны
+    // только классы, объявленные до метода
+    const runtime::Class* FindClass(runtime::Symbol name) const {
+        if (visible_classes_ != ALL_CLASSES) {
+            auto it = lazy_->classes.find(name);
+            return it != lazy_->classes.end() && it->second.second < visible_classes_
+                       ? it->second.first
+                       : nullptr;
+        }
+        auto it = declared_classes_->find(name);
+        return it != declared_classes_->end() ? it->second.TryAs<runtime::Class>() : nullptr;
     }
 
-    vector<string> ParseDottedIds() {
-        vector<string> result(1, lexer_.Expect<TokenType::Id>().value);
+    vector<runtime::Symbol> ParseDottedIds() {
+        vector<runtime::Symbol> result(1, lexer_.Expect<TokenType::Id>().symbol);
 
         while (lexer_.NextToken() == '.') {
-            result.push_back(lexer_.ExpectNext<TokenType::Id>().value);
+            result.push_back(lexer_.ExpectNext<TokenType::Id>().symbol);
         }
 
         return result;
     }
 
+    // Создаёт обращение к переменной. Входные переменные верхнего уровня разрешаются в слоты
+    ast::VariableValue MakeVariable(vector<runtime::Symbol> dotted_ids) const {
+        auto slot = method_depth_ == 0 ? slots_.find(dotted_ids.front()) : slots_.end();
+        auto result = slot != slots_.end()
+                          ? ast::VariableValue::Slot(slot->second, std::move(dotted_ids))
+                          : ast::VariableValue(std::move(dotted_ids));
+        if (!type_feedback_) {
+            result.DisableTypeFeedback();
+        }
+        return result;
+    }
+
     //  AssgnOrCall -> DottedIds = Expr
     //               | DottedIds '(' ExprList ')'
     unique_ptr<ast::Statement> ParseAssignmentOrCall() {
         lexer_.Expect<TokenType::Id>();
 
-        vector<string> id_list = ParseDottedIds();
-        string last_name = id_list.back();
+        vector<runtime::Symbol> id_list = ParseDottedIds();
+        runtime::Symbol last_name = id_list.back();
         id_list.pop_back();
 
         if (lexer_.CurrentToken() == '=') {
             lexer_.NextToken();
 
             if (id_list.empty()) {
-                return make_unique<ast::Assignment>(std::move(last_name), ParseTest());
+                if (method_depth_ == 0 && slots_.count(last_name) > 0) {
+                    throw ParseError("Input variable "s + last_name.GetName()
+                                     + " cannot be assigned"s);
+                }
+                auto value = ParseTest();
+                RecordAssignment(last_name, *value);
+                return make_unique<ast::Assignment>(last_name, std::move(value));
             }
-            return make_unique<ast::FieldAssignment>(ast::VariableValue{std::move(id_list)},
-                                                     std::move(last_name), ParseTest());
+            return Fuse(make_unique<ast::FieldAssignment>(MakeVariable(std::move(id_list)),
+                                                          last_name, ParseTest()));
         }
         lexer_.Expect<TokenType::Char>('(');
         lexer_.NextToken();
 
+        const runtime::Builtin* builtin = nullptr;
         if (id_list.empty()) {
-            throw ParseError("Mython doesn't support functions, only methods: "s + last_name);
+            builtin = builtins_.Find(last_name.GetName());
+            if (builtin == nullptr) {
+                throw ParseError("Mython doesn't support functions, only methods and builtins: "s
+                                 + last_name.GetName());
+            }
         }
 
         vector<unique_ptr<ast::Statement>> args;
@@ -166,125 +493,111 @@ private:
         lexer_.Expect<TokenType::Char>(')');
         lexer_.NextToken();
 
-        return make_unique<ast::MethodCall>(make_unique<ast::VariableValue>(std::move(id_list)),
-                                            std::move(last_name), std::move(args));
+        if (builtin != nullptr) {
+            return MakeBuiltinCall(*builtin, std::move(args));
+        }
+        return MakeMethodCall(std::move(id_list), last_name, std::move(args));
     }
 
-    // Expr -> Adder ['+'/'-' Adder]*
-    unique_ptr<ast::Statement> ParseExpression()  // NOLINT
-    {
-        unique_ptr<ast::Statement> result = ParseAdder();
-        while (lexer_.CurrentToken() == '+' || lexer_.CurrentToken() == '-') {
-            char op = lexer_.CurrentToken().As<TokenType::Char>().value;
-            lexer_.NextToken();
-
-            if (op == '+') {
-                result = make_unique<ast::Add>(std::move(result), ParseAdder());
-            } else {
-                result = make_unique<ast::Sub>(std::move(result), ParseAdder());
+    // Создаёт вызов метода method объекта object_ids и связывает его с методом класса,
+    // если класс объекта известен (см. ParseOptions::bind_methods)
+    unique_ptr<ast::Statement> MakeMethodCall(vector<runtime::Symbol> object_ids,
+                                              runtime::Symbol method,
+                                              vector<unique_ptr<ast::Statement>> args) {
+        const runtime::Class* cls = nullptr;
+        if (object_ids.size() == 1) {
+            if (auto it = instance_classes_.find(object_ids.front());
+                it != instance_classes_.end()) {
+                cls = it->second;
             }
         }
-        return result;
+        auto call = make_unique<ast::MethodCall>(
+            make_unique<ast::VariableValue>(MakeVariable(std::move(object_ids))), method,
+            std::move(args), inline_limits_);
+        if (!type_feedback_) {
+            call->DisableTypeFeedback();
+        } else if (cls != nullptr) {
+            // без подходящего метода вызов не связывается: ветвь с ним может не выполниться
+            call->Bind(*cls);
+        }
+        return call;
     }
 
-    // Adder -> Mult ['*'/'/' Mult]*
-    unique_ptr<ast::Statement> ParseAdder()  // NOLINT
-    {
-        unique_ptr<ast::Statement> result = ParseMult();
-        while (lexer_.CurrentToken() == '*' || lexer_.CurrentToken() == '/') {
-            char op = lexer_.CurrentToken().As<TokenType::Char>().value;
-            lexer_.NextToken();
-
-            if (op == '*') {
-                result = make_unique<ast::Mult>(std::move(result), ParseMult());
-            } else {
-                result = make_unique<ast::Div>(std::move(result), ParseMult());
+    // Запоминает класс переменной var после присваивания ей значения value: класс нового
+    // объекта или класс, известный для другой переменной
+    void RecordAssignment(runtime::Symbol var, const ast::Statement& value) {
+        const runtime::Class* cls = nullptr;
+        if (const auto* instance = dynamic_cast<const ast::NewInstance*>(&value)) {
+            cls = &instance->GetClass();
+        } else if (const auto* variable = dynamic_cast<const ast::VariableValue*>(&value);
+                   variable && !variable->GetSlot() && variable->GetFieldIds().empty()) {
+            if (auto it = instance_classes_.find(variable->GetSymbol());
+                it != instance_classes_.end()) {
+                cls = it->second;
             }
         }
-        return result;
+        if (cls != nullptr && bind_methods_) {
+            instance_classes_[var] = cls;
+        } else {
+            instance_classes_.erase(var);
+        }
     }
 
-    // Mult -> '(' Expr ')'
-    //       | NUMBER
-    //       | '-' Mult
-    //       | STRING
-    //       | NONE
-    //       | TRUE
-    //       | FALSE
-    //       | DottedIds '(' ExprList ')'
-    //       | DottedIds
-    unique_ptr<ast::Statement> ParseMult()  // NOLINT
-    {
-        if (lexer_.CurrentToken() == '(') {
-            lexer_.NextToken();
-            auto result = ParseTest();
-            lexer_.Expect<TokenType::Char>(')');
-            lexer_.NextToken();
-            return result;
-        }
-        if (lexer_.CurrentToken() == '-') {
-            lexer_.NextToken();
-            return make_unique<ast::Mult>(ParseMult(), make_unique<ast::NumericConst>(-1));
-        }
-        if (const auto* num = lexer_.CurrentToken().TryAs<TokenType::Number>()) {
-            int result = num->value;
-            lexer_.NextToken();
-            return make_unique<ast::NumericConst>(result);
+    // Создаёт узел вызова names(args): метода объекта, конструктора класса, функции str
+    // или встроенной функции
+    unique_ptr<ast::Statement> MakeCall(vector<runtime::Symbol> names,
+                                        vector<unique_ptr<ast::Statement>> args) {
+        auto method_name = names.back();
+        names.pop_back();
+
+        if (!names.empty()) {
+            return MakeMethodCall(std::move(names), method_name, std::move(args));
         }
-        if (const auto* str = lexer_.CurrentToken().TryAs<TokenType::String>()) {
-            string result = str->value;
-            lexer_.NextToken();
-            return make_unique<ast::StringConst>(std::move(result));
+        if (const runtime::Class* cls = FindClass(method_name)) {
+            return make_unique<ast::NewInstance>(*cls, std::move(args));
         }
-        if (lexer_.CurrentToken().Is<TokenType::True>()) {
-            lexer_.NextToken();
-            return make_unique<ast::BoolConst>(runtime::Bool(true));
+        if (method_name == STR_FUNCTION) {
+            if (args.size() != 1) {
+                throw ParseError("Function str takes exactly one argument"s);
+            }
+            auto result = make_unique<ast::Stringify>(std::move(args.front()));
+            return fold_constants_ ? ast::FoldConstants(std::move(result)) : std::move(result);
         }
-        if (lexer_.CurrentToken().Is<TokenType::False>()) {
-            lexer_.NextToken();
-            return make_unique<ast::BoolConst>(runtime::Bool(false));
+        if (const auto* builtin = builtins_.Find(method_name.GetName())) {
+            return MakeBuiltinCall(*builtin, std::move(args));
         }
-        if (lexer_.CurrentToken().Is<TokenType::None>()) {
-            lexer_.NextToken();
-            return make_unique<ast::None>();
-        }
-
-        return ParseDottedIdsInMultExpr();
+        throw ParseError("Unknown call to "s + method_name.GetName() + "()"s);
     }
 
-    std::unique_ptr<ast::Statement> ParseDottedIdsInMultExpr() {
-        vector<string> names = ParseDottedIds();
-
-        if (lexer_.CurrentToken() == '(') {
-            // various calls
-            vector<unique_ptr<ast::Statement>> args;
-            if (lexer_.NextToken() != ')') {
-                args = ParseTestList();
-            }
-            lexer_.Expect<TokenType::Char>(')');
-            lexer_.NextToken();
-
-            auto method_name = names.back();
-            names.pop_back();
+    // Constant -> NUMBER | STRING | NONE | TRUE | FALSE
+    unique_ptr<ast::Statement> ParseConstant() {
+        unique_ptr<ast::Statement> result;
+        const auto& tok = lexer_.CurrentToken();
+        if (const auto* num = tok.TryAs<TokenType::Number>()) {
+            result = make_unique<ast::NumericConst>(num->value);
+        } else if (const auto* str = tok.TryAs<TokenType::String>()) {
+            result = make_unique<ast::StringConst>(string(str->value));
+        } else if (tok.Is<TokenType::True>()) {
+            result = make_unique<ast::BoolConst>(runtime::Bool(true));
+        } else if (tok.Is<TokenType::False>()) {
+            result = make_unique<ast::BoolConst>(runtime::Bool(false));
+        } else if (tok.Is<TokenType::None>()) {
+            result = make_unique<ast::None>();
+        } else {
+            throw ParseError("Unexpected token in expression"s);
+        }
+        lexer_.NextToken();
+        return result;
+    }
 
-            if (!names.empty()) {
-                return make_unique<ast::MethodCall>(
-                    make_unique<ast::VariableValue>(std::move(names)), std::move(method_name),
-                    std::move(args));
-            }
-            if (auto it = declared_classes_.find(method_name); it != declared_classes_.end()) {
-                return make_unique<ast::NewInstance>(
-                    static_cast<const runtime::Class&>(*it->second), std::move(args));  // NOLINT
-            }
-            if (method_name == "str"sv) {
-                if (args.size() != 1) {
-                    throw ParseError("Function str takes exactly one argument"s);
-                }
-                return make_unique<ast::Stringify>(std::move(args.front()));
-            }
-            throw ParseError("Unknown call to "s + method_name + "()"s);
+    // Проверяет количество аргументов встроенной функции и создаёт узел её вызова
+    unique_ptr<ast::Statement> MakeBuiltinCall(const runtime::Builtin& builtin,
+                                               vector<unique_ptr<ast::Statement>> args) {
+        if (args.size() != builtin.arity) {
+            throw ParseError("Function "s + builtin.name + " takes "s + to_string(builtin.arity)
+                             + " argument(s), "s + to_string(args.size()) + " given"s);
         }
-        return make_unique<ast::VariableValue>(std::move(names));
+        return make_unique<ast::BuiltinCall>(builtin.function, std::move(args));
     }
 
     vector<unique_ptr<ast::Statement>> ParseTestList()  // NOLINT
@@ -310,7 +623,9 @@ private:
         lexer_.Expect<TokenType::Char>(':');
         lexer_.NextToken();
 
+        auto classes_before = instance_classes_;
         auto if_body = ParseSuite();
+        auto if_classes = std::exchange(instance_classes_, std::move(classes_before));
 
         unique_ptr<ast::Statement> else_body;
         if (lexer_.CurrentToken().Is<TokenType::Else>()) {
@@ -318,82 +633,133 @@ private:
             lexer_.NextToken();
             else_body = ParseSuite();
         }
-
-        return make_unique<ast::IfElse>(std::move(condition), std::move(if_body),
-                                        std::move(else_body));
-    }
-
-    // LogicalExpr -> AndTest [OR AndTest]
-    // AndTest -> NotTest [AND NotTest]
-    // NotTest -> [NOT] NotTest
-    //          | Comparison
-    unique_ptr<ast::Statement> ParseTest()  // NOLINT
-    {
-        auto result = ParseAndTest();
-        while (lexer_.CurrentToken().Is<TokenType::Or>()) {
-            lexer_.NextToken();
-            result = make_unique<ast::Or>(std::move(result), ParseAndTest());
+        // после условной инструкции класс переменной известен, только если он
+        // одинаков в обеих ветвях
+        for (auto it = instance_classes_.begin(); it != instance_classes_.end();) {
+            auto if_class = if_classes.find(it->first);
+            if (if_class == if_classes.end() || if_class->second != it->second) {
+                it = instance_classes_.erase(it);
+            } else {
+                ++it;
+            }
         }
-        return result;
-    }
 
-    unique_ptr<ast::Statement> ParseAndTest()  // NOLINT
-    {
-        auto result = ParseNotTest();
-        while (lexer_.CurrentToken().Is<TokenType::And>()) {
-            lexer_.NextToken();
-            result = make_unique<ast::And>(std::move(result), ParseNotTest());
-        }
-        return result;
+        return Fuse(make_unique<ast::IfElse>(std::move(condition), std::move(if_body),
+                                             std::move(else_body)));
     }
 
-    unique_ptr<ast::Statement> ParseNotTest()  // NOLINT
-    {
-        if (lexer_.CurrentToken().Is<TokenType::Not>()) {
-            lexer_.NextToken();
-            return make_unique<ast::Not>(ParseNotTest());  // NOLINT
-        }
-        return ParseComparison();
-    }
-
-    // Comparison -> Expr [COMP_OP Expr]
-    unique_ptr<ast::Statement> ParseComparison()  // NOLINT
-    {
-        auto result = ParseExpression();
+    // Test -> NOT Test | Test OR Test | Test AND Test | Expr COMP_OP Expr
+    // Expr -> Expr '+'/'-' Expr | Expr '*'/'/' Expr | '-' Expr | '(' Test ')'
+    //       | Constant | DottedIds | DottedIds '(' [Test [',' Test]*] ')'
+    //
+    // Выражение разбирается методом предшествования операций: операции, ожидающие правого
+    // операнда, а также открытые скобки и вызовы хранятся в явном стеке, поэтому глубина
+    // рекурсии не зависит ни от длины выражения, ни от вложенности скобок и вызовов
+    unique_ptr<ast::Statement> ParseTest() {
+        vector<unique_ptr<ast::Statement>> operands;
+        vector<PendingOperation> operations;
+        // количество открытых скобок и вызовов в стеке
+        size_t open_brackets = 0;
+        bool expect_operand = true;
+
+        while (true) {
+            const auto& tok = lexer_.CurrentToken();
+            if (expect_operand) {
+                if (tok.Is<TokenType::Not>()) {
+                    // not применяется только к операндам логических операций
+                    if (!operations.empty()
+                        && PRECEDENCE[operations.back().operation] > PRECEDENCE[NOT]) {
+                        throw ParseError("Unexpected not in expression"s);
+                    }
+                    operations.push_back({NOT});
+                    lexer_.NextToken();
+                } else if (tok == '-') {
+                    operations.push_back({NEGATE});
+                    lexer_.NextToken();
+                } else if (tok == '(') {
+                    operations.push_back({GROUP});
+                    ++open_brackets;
+                    lexer_.NextToken();
+                } else if (tok.Is<TokenType::Id>()) {
+                    vector<runtime::Symbol> names = ParseDottedIds();
+                    if (lexer_.CurrentToken() != '(') {
+                        operands.push_back(
+                            make_unique<ast::VariableValue>(MakeVariable(std::move(names))));
+                        expect_operand = false;
+                    } else if (lexer_.NextToken() == ')') {
+                        lexer_.NextToken();
+                        operands.push_back(MakeCall(std::move(names), {}));
+                        expect_operand = false;
+                    } else {
+                        operations.push_back({CALL, ast::ComparisonOp::EQUAL, std::move(names)});
+                        ++open_brackets;
+                    }
+                } else {
+                    operands.push_back(ParseConstant());
+                    expect_operand = false;
+                }
+                continue;
+            }
 
-        const auto tok = lexer_.CurrentToken();
+            if (auto binary = BinaryOperationOf(tok)) {
+                if (binary->operation == COMPARISON) {
+                    ReduceOperations(operands, operations, PRECEDENCE[COMPARISON] + 1,
+                                     fold_constants_, type_feedback_);
+                    // сравнения не объединяются в цепочки, a < b < c не является выражением
+                    if (!operations.empty()
+                        && operations.back().operation == COMPARISON) {
+                        throw ParseError("Comparisons cannot be chained"s);
+                    }
+                } else {
+                    ReduceOperations(operands, operations, PRECEDENCE[binary->operation],
+                                     fold_constants_, type_feedback_);
+                }
+                operations.push_back(std::move(*binary));
+                lexer_.NextToken();
+                expect_operand = true;
+                continue;
+            }
 
-        if (tok == '<') {
-            lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Less, std::move(result),
-                                                ParseExpression());
-        }
-        if (tok == '>') {
-            lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Greater, std::move(result),
-                                                ParseExpression());
-        }
-        if (tok.Is<TokenType::Eq>()) {
-            lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Equal, std::move(result),
-                                                ParseExpression());
-        }
-        if (tok.Is<TokenType::NotEq>()) {
-            lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::NotEqual, std::move(result),
-                                                ParseExpression());
-        }
-        if (tok.Is<TokenType::LessOrEq>()) {
-            lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::LessOrEqual, std::move(result),
-                                                ParseExpression());
-        }
-        if (tok.Is<TokenType::GreaterOrEq>()) {
+            if (open_brackets == 0 || (tok != ',' && tok != ')')) {
+                break;
+            }
+            ReduceOperations(operands, operations, 1, fold_constants_, type_feedback_);
+            PendingOperation& bracket = operations.back();
+            if (bracket.operation == GROUP) {
+                if (tok == ',') {
+                    break;
+                }
+                operations.pop_back();
+            } else {
+                bracket.args.push_back(std::move(operands.back()));
+                operands.pop_back();
+                if (tok == ',') {
+                    lexer_.NextToken();
+                    expect_operand = true;
+                    continue;
+                }
+                auto call = MakeCall(std::move(bracket.names), std::move(bracket.args));
+                operations.pop_back();
+                operands.push_back(std::move(call));
+            }
+            --open_brackets;
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::GreaterOrEqual, std::move(result),
-                                                ParseExpression());
         }
-        return result;
+
+        if (open_brackets > 0) {
+            // ближайшая открытая скобка или вызов - последние в стеке
+            const auto bracket =
+                find_if(operations.rbegin(), operations.rend(), [](const auto& pending) {
+                    return pending.operation == GROUP || pending.operation == CALL;
+                });
+            ostringstream message;
+            message << "Expected ')' to close "sv
+                    << (bracket->operation == GROUP ? "'('"sv : "call arguments"sv)
+                    << ", found "sv << lexer_.CurrentToken();
+            throw ParseError(message.str());
+        }
+        ReduceOperations(operands, operations, 1, fold_constants_, type_feedback_);
+        return std::move(operands.back());
     }
 
     // Statement -> SimpleStatement Newline
@@ -437,12 +803,89 @@ private:
         return ParseAssignmentOrCall();
     }
 
-    parse::Lexer& lexer_;
-    runtime::Closure declared_classes_;
+    // все узлы, созданные при разборе, размещаются в одной арене
+    ast::ArenaScope arena_;
+    parse::TokenSource& lexer_;
+    const runtime::Builtins& builtins_;
+    const bool fold_constants_;
+    const bool fuse_statements_;
+    const ast::InlineLimits inline_limits_;
+    const bool bind_methods_;
+    const bool type_feedback_;
+    // переменные, которым присвоены объекты известных при разборе классов
+    unordered_map<runtime::Symbol, const runtime::Class*> instance_classes_;
+    runtime::Closure own_classes_;
+    // объявленные классы: собственные либо переданные в ParseStatements
+    runtime::Closure* declared_classes_ = &own_classes_;
+    const runtime::Closure* reused_classes_ = &own_classes_;
+    // классы, объявленные при разборе, в порядке объявления
+    vector<runtime::ObjectHolder> new_classes_;
+    // отложенный разбор тел методов: источник токенов основного разбора и общие данные
+    const parse::TokenCursor* cursor_ = nullptr;
+    shared_ptr<LazyMethods> lazy_;
+    // количество классов, видимых отложенному телу метода
+    static constexpr size_t ALL_CLASSES = static_cast<size_t>(-1);
+    size_t visible_classes_ = ALL_CLASSES;
+    // номера слотов входных переменных
+    unordered_map<runtime::Symbol, size_t> slots_;
+    // глубина вложенности разбираемых методов; внутри методов слоты не используются
+    int method_depth_ = 0;
 };
 
+// Разбирает программу из буфера tokens. Тела методов, разбор которых отложен,
+// владеют буфером совместно
+unique_ptr<runtime::Executable> ParseTokens(shared_ptr<const parse::TokenBuffer> tokens,
+                                            const ParseOptions& options) {
+    parse::TokenCursor cursor(*tokens);
+    Parser parser{cursor, options};
+    if (options.lazy_methods) {
+        parser.DeferMethodBodies(cursor, std::move(tokens));
+    }
+    return parser.ParseProgram();
+}
+
 }  // namespace
 
 unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer) {
-    return Parser{lexer}.ParseProgram();
-}
\ No newline at end of file
+    return ParseProgram(lexer, runtime::Builtins::Default());
+}
+
+unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer,
+                                             const runtime::Builtins& builtins) {
+    ParseOptions options;
+    options.builtins = &builtins;
+    return ParseProgram(lexer, options);
+}
+
+unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer, const ParseOptions& options) {
+    if (options.lazy_methods) {
+        return ParseTokens(make_shared<parse::TokenBuffer>(lexer), options);
+    }
+    if (options.pretokenize) {
+        parse::TokenBuffer tokens(lexer);
+        return ParseProgram(tokens, options);
+    }
+    return Parser{lexer, options}.ParseProgram();
+}
+
+unique_ptr<runtime::Executable> ParseProgram(parse::TokenSource& tokens,
+                                             const ParseOptions& options) {
+    return Parser{tokens, options}.ParseProgram();
+}
+
+unique_ptr<runtime::Executable> ParseProgram(const parse::TokenBuffer& tokens,
+                                             const ParseOptions& options) {
+    // буфер принадлежит вызывающему
+    return ParseTokens(shared_ptr<const parse::TokenBuffer>(shared_ptr<void>(), &tokens), options);
+}
+
+void ParseStatements(parse::Lexer& lexer, const ParseOptions& options, runtime::Closure& classes,
+                     const runtime::Closure& reused_classes,
+                     const StatementHandler& on_statement) {
+    Parser{lexer, options, classes, reused_classes}.ParseStatements(on_statement);
+}
+
+unique_ptr<runtime::Executable> ParseExpression(parse::Lexer& lexer,
+                                                const ParseOptions& options) {
+    return Parser{lexer, options}.ParseSingleExpression();
+}
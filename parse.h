@@ -1,18 +1,116 @@
 #pragma once
 
+#include "ast_inline.h"
+#include "runtime.h"
+
+#include <functional>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace parse {
 class Lexer;
+class TokenBuffer;
+class TokenSource;
 }
 
 namespace runtime {
-class Executable;
+class Builtins;
 }
 
 struct ParseError : std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
-std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer);
\ No newline at end of file
+std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer);
+
+// Разбирает программу, разрешая вызовы встроенных функций из реестра builtins.
+// Количество аргументов каждого вызова проверяется во время разбора
+std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer,
+                                                  const runtime::Builtins& builtins);
+
+// Параметры разбора программы
+struct ParseOptions {
+    // Реестр встроенных функций. Если nullptr, используется runtime::Builtins::Default()
+    const runtime::Builtins* builtins = nullptr;
+    // Имена входных переменных. Обращения к ним на верхнем уровне программы разрешаются
+    // в слоты контекста (см. runtime::Context::GetSlots) с номером, равным позиции имени
+    // в списке. Присваивать входным переменным нельзя
+    std::vector<std::string> inputs;
+    // Перед разбором считать весь текст в буфер токенов (см. parse::TokenBuffer).
+    // Синтаксический анализатор тогда просматривает токены по номерам, не копируя их
+    bool pretokenize = false;
+    // Вычислять при разборе выражения над константами, например 60 * 60 * 24 или
+    // 'a' + 'b', и заменять умножение на -1 отрицанием (см. ast::FoldConstants).
+    // Выключено по умолчанию: операции над константами, в том числе str(), тогда
+    // выполняются при разборе, а не при выполнении программы
+    bool fold_constants = false;
+    // Заменять распространённые инструкции объединёнными узлами, например
+    // self.x = self.x + 1 - узлом ast::FieldIncrement (см. ast::FuseStatement)
+    bool fuse_statements = true;
+    // Размер методов, которые встраиваются в место вызова (см. ast::InlinedCall).
+    // Встраивание отключается значением max_body_nodes = 0
+    ast::InlineLimits inline_limits;
+    /*
+     * Связывать вызовы методов с методами классов, если класс объекта известен при разборе:
+     * переменной присвоен новый объект класса (x = Point()) или другая такая переменная.
+     * Связанный метод только заранее заполняет кэш вызова (см. ast::MethodCall::Bind).
+     * Вызов, для которого метод не найден, остаётся несвязанным, и ошибка, как и без
+     * связывания, возникает при его выполнении
+     */
+    bool bind_methods = true;
+    /*
+     * Откладывать разбор тел методов до их первого вызова. При разборе программы тело
+     * метода только пропускается с проверкой парности скобок, а дерево строится, когда
+     * метод вызывается впервые; ошибки в теле метода выбрасываются тогда же.
+     * Действует при разборе из лексера или буфера токенов. Текст программы, переданный буфер
+     * токенов и реестр builtins должны оставаться действительными, пока вызываются методы
+     */
+    bool lazy_methods = false;
+    /*
+     * Собирать обратную связь по типам и кэшировать найденные методы в узлах дерева
+     * (см. ast::TypeFeedback). Выполнение такого дерева изменяет его узлы, поэтому его нельзя
+     * выполнять одновременно в нескольких потоках. Если false, узлы сразу выполняются общим
+     * путём, вызовы методов не связываются (bind_methods не действует), и выполнение
+     * не изменяет дерево
+     */
+    bool type_feedback = true;
+};
+
+std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer,
+                                                  const ParseOptions& options);
+
+// Разбирает программу, читая токены из произвольного источника
+std::unique_ptr<runtime::Executable> ParseProgram(parse::TokenSource& tokens,
+                                                  const ParseOptions& options);
+
+// Разбирает программу, заранее разобранную на токены
+std::unique_ptr<runtime::Executable> ParseProgram(const parse::TokenBuffer& tokens,
+                                                  const ParseOptions& options);
+
+// Разбирает одно выражение, например "price * count > limit".
+// Выполнение результата возвращает значение выражения
+std::unique_ptr<runtime::Executable> ParseExpression(parse::Lexer& lexer,
+                                                     const ParseOptions& options);
+// Обработчик инструкции верхнего уровня statement, объявившей классы classes.
+// Возвращает false, чтобы прекратить разбор
+using StatementHandler = std::function<bool(std::unique_ptr<runtime::Executable> statement,
+                                            std::vector<runtime::ObjectHolder> classes)>;
+
+/*
+ * Разбирает программу по одной инструкции верхнего уровня и передаёт каждую в on_statement.
+ * Когда обработчик вызван, текущий токен лексера - первый токен следующей инструкции,
+ * так что lexer.CurrentOffset() - смещение её начала.
+ *
+ * classes содержит классы, объявленные до разбираемого текста; разбор добавляет в него
+ * объявленные классы. Если класс с тем же именем есть в reused_classes, новое определение
+ * записывается в прежний объект класса, и инструкции, разобранные ранее со ссылкой на
+ * этот объект, видят новое определение.
+ *
+ * Классы объектов, присвоенных переменным до разбираемого текста, неизвестны, поэтому
+ * вызовы их методов не связываются при разборе (см. ParseOptions::bind_methods)
+ */
+void ParseStatements(parse::Lexer& lexer, const ParseOptions& options, runtime::Closure& classes,
+                     const runtime::Closure& reused_classes,
+                     const StatementHandler& on_statement);
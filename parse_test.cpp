@@ -1,3 +1,5 @@
+#include "ast_arena.h"
+#include "builtins.h"
 #include "lexer.h"
 #include "parse.h"
 #include "statement.h"
@@ -263,6 +265,239 @@ print r, c, t1, t2
     //cerr << "TestClassicalPolymorphism. 4" << endl;
 }
 
+void TestBuiltinFunctions() {
+    const string program = R"(
+class Box:
+  def __init__(v):
+    self.v = v
+  def __lt__(rhs):
+    return self.v < rhs.v
+  def __str__():
+    return 'Box(' + str(self.v) + ')'
+
+print len('hello'), abs(-5), min(3, 7), max(3, 7), max('a', 'b')
+print min(Box(2), Box(1)), len(IntArray(3))
+)"s;
+
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    auto tree = ParseProgramFromString(program);
+    tree->Execute(closure, context);
+
+    ASSERT_EQUAL(context.output.str(), "5 5 3 7 b\nBox(1) 3\n"s);
+}
+
+int host_calls = 0;
+
+runtime::ObjectHolder HostTwice(const vector<runtime::ObjectHolder>& args,
+                                runtime::Context& /*context*/) {
+    ++host_calls;
+    return runtime::ObjectHolder::Own(
+        runtime::Number(args[0].TryAs<runtime::Number>()->GetValue() * 2));
+}
+
+void TestHostBuiltins() {
+    runtime::Builtins builtins;
+    builtins.Register("twice"s, 1, HostTwice);
+
+    istringstream is("x = twice(21)\ntwice(x)\nprint x\n"s);
+    parse::Lexer lexer(is);
+    auto tree = ParseProgram(lexer, builtins);
+
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    host_calls = 0;
+    tree->Execute(closure, context);
+
+    ASSERT_EQUAL(context.output.str(), "42\n"s);
+    ASSERT_EQUAL(host_calls, 2);
+
+    // Функции, отсутствующие в реестре, недоступны
+    ASSERT_THROWS(ParseProgramFromString("x = twice(1)\n"s), ParseError);
+}
+
+void TestBuiltinArityIsCheckedAtParseTime() {
+    ASSERT_THROWS(ParseProgramFromString("x = len('a', 'b')\n"s), ParseError);
+    ASSERT_THROWS(ParseProgramFromString("abs()\n"s), ParseError);
+    ASSERT_THROWS(ParseProgramFromString("x = unknown(1)\n"s), ParseError);
+}
+
+string RunProgram(const string& program) {
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    ParseProgramFromString(program)->Execute(closure, context);
+    return context.output.str();
+}
+
+void TestOperatorPrecedence() {
+    ASSERT_EQUAL(RunProgram("print 2 + 3 * 4 - 6 / 2 * -1\n"s), "17\n"s);
+    ASSERT_EQUAL(RunProgram("print 10 - 4 - 3, 24 / 4 / 3, -(2 + 3) * 2\n"s), "3 2 -10\n"s);
+    ASSERT_EQUAL(RunProgram("print not 1 == 2 and 3 > 2 or False\n"s), "True\n"s);
+    ASSERT_EQUAL(RunProgram("print not not False or not True and True\n"s), "False\n"s);
+    ASSERT_EQUAL(RunProgram("print str(1 + 2) + str(len('ab') * 2)\n"s), "34\n"s);
+
+    // сравнения не объединяются в цепочки, not не может быть операндом сравнения
+    ASSERT_THROWS(ParseProgramFromString("x = 1 < 2 < 3\n"s), ParseError);
+    ASSERT_THROWS(ParseProgramFromString("x = 1 == not 2\n"s), ParseError);
+    ASSERT_THROWS(ParseProgramFromString("x = 1 + not 2\n"s), ParseError);
+    ASSERT_THROWS(ParseProgramFromString("x = (1 < 2 < 3)\n"s), ParseError);
+    ASSERT_THROWS(ParseProgramFromString("x = (1 + 2\n"s), ParseError);
+    ASSERT_THROWS(ParseProgramFromString("x = (1, 2)\n"s), ParseError);
+    ASSERT_THROWS(ParseProgramFromString("x = 1 +\n"s), ParseError);
+}
+
+void TestUnclosedBrackets() {
+    // незакрытая скобка - синтаксическая ошибка, называющая недостающую скобку
+    auto error_of = [](const string& program) {
+        try {
+            ParseProgramFromString(program);
+        } catch (const ParseError& e) {
+            return string(e.what());
+        }
+        return "no error"s;
+    };
+    ASSERT_EQUAL(error_of("x = (1 + 2\n"s), "Expected ')' to close '(', found Newline"s);
+    ASSERT_EQUAL(error_of("print str(1, 2\n"s),
+                 "Expected ')' to close call arguments, found Newline"s);
+    ASSERT_EQUAL(error_of("x = ((1)\n"s), "Expected ')' to close '(', found Newline"s);
+    ASSERT_EQUAL(error_of("x = (1 == 2 == 3)\n"s), "Comparisons cannot be chained"s);
+}
+
+void TestDeeplyNestedExpressions() {
+    // глубина рекурсии разбора не зависит от вложенности скобок и вызовов
+    const size_t depth = 100000;
+    ASSERT_EQUAL(RunProgram("print "s + string(depth, '(') + "42"s + string(depth, ')') + "\n"s),
+                 "42\n"s);
+    ASSERT_EQUAL(RunProgram("print "s + string(1000, '-') + "7\n"s), "7\n"s);
+
+    string calls = "x = "s;
+    for (int i = 0; i < 1000; ++i) {
+        calls += "len(str("s;
+    }
+    calls += "12345"s + string(2000, ')') + "\nprint x\n"s;
+    ASSERT_EQUAL(RunProgram(calls), "1\n"s);
+
+    string sum = "print 0"s;
+    for (int i = 1; i <= 10000; ++i) {
+        sum += " + "s + to_string(i) + " * (1 - 0)"s;
+    }
+    ASSERT_EQUAL(RunProgram(sum + "\n"s), "50005000\n"s);
+}
+
+// Возвращает тело метода method класса, объявленного в closure под именем class_name
+ast::LazyMethodBody* FindLazyBody(const runtime::Closure& closure, const string& class_name,
+                                  const string& method) {
+    const auto* cls = closure.at(runtime::Symbol(class_name)).TryAs<runtime::Class>();
+    return dynamic_cast<ast::LazyMethodBody*>(cls->GetMethod(runtime::Symbol(method))->body.get());
+}
+
+void TestLazyMethodBodies() {
+    const string program = R"(
+class Shape:
+  def area():
+    return 0
+
+  def describe():
+    return 'shape with area ' + str(self.area())
+
+class Square(Shape):
+  def __init__(side):
+    self.side = side
+
+  def area():
+    return self.side * self.side
+
+  def unused():
+    return 1 + * 2
+
+  def copy():
+    return Square(self.side)
+
+s = Square(3)
+print s.describe()
+)"s;
+
+    ParseOptions options;
+    options.lazy_methods = true;
+    parse::Lexer lexer(string_view{program});
+    auto tree = ParseProgram(lexer, options);
+
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    tree->Execute(closure, context);
+    ASSERT_EQUAL(context.output.str(), "shape with area 9\n"s);
+
+    // разобраны только вызванные методы
+    ASSERT(FindLazyBody(closure, "Shape"s, "describe"s)->IsParsed());
+    ASSERT(FindLazyBody(closure, "Square"s, "area"s)->IsParsed());
+    ASSERT(!FindLazyBody(closure, "Shape"s, "area"s)->IsParsed());
+    ASSERT(!FindLazyBody(closure, "Square"s, "unused"s)->IsParsed());
+    // дерево тела размещается в арене программы
+    auto* area = FindLazyBody(closure, "Square"s, "area"s);
+    ASSERT(ast::Arena::Of(&area->GetBody()) == ast::Arena::Of(area));
+
+    // ошибки в теле метода обнаруживаются при его вызове
+    auto* square = closure.at(runtime::Symbol("s"s)).TryAs<runtime::ClassInstance>();
+    ASSERT_THROWS(square->Call(runtime::Symbol("unused"s), {}, context), ParseError);
+    // класс не виден собственным методам, как и при обычном разборе
+    ASSERT_THROWS(square->Call(runtime::Symbol("copy"s), {}, context), ParseError);
+}
+
+void TestLazyParsingChecksBrackets() {
+    ParseOptions options;
+    options.lazy_methods = true;
+    for (const string& program : {"class A:\n  def f():\n    return (1\n"s,
+                                  "class A:\n  def f():\n    return 1)\n"s,
+                                  "class A:\n  def f(:\n    return 1\n"s}) {
+        parse::Lexer lexer(string_view{program});
+        ASSERT_THROWS(ParseProgram(lexer, options), std::runtime_error);
+    }
+}
+
+void TestMethodCallsAreBound() {
+    const string classes = R"(
+class A:
+  def f(x):
+    return x
+
+class B(A):
+  def g():
+    return 2
+
+)"s;
+    ASSERT_EQUAL(RunProgram(classes + "a = A()\nb = B()\nc = b\nprint a.f(1), c.g(), c.f(3)\n"s),
+                 "1 2 3\n"s);
+
+    // вызов связан с методом ещё до выполнения
+    auto program = ParseProgramFromString(classes + "a = A()\na.f(1)\n"s);
+    const auto& statements = dynamic_cast<ast::Compound&>(*program).GetStatements();
+    const auto* call = dynamic_cast<const ast::MethodCall*>(statements.back().get());
+    ASSERT(call != nullptr);
+    ASSERT(call->GetTypeFeedback() == ast::TypeFeedback::INSTANCES);
+
+    // неверное количество аргументов - ошибка выполнения, даже если класс объекта известен
+    for (const string& source :
+         {"a = A()\na.f()\n"s, "a = B()\nb = a\nprint b.g(1)\n"s, "a = A()\nprint a.g()\n"s,
+          "if 1 < 2:\n  a = A()\nelse:\n  a = A()\na.f()\n"s,
+          "a = A()\nif 1 > 2:\n  a = 5\na.f()\n"s, "a = A()\na = B()\na.f()\n"s,
+          "class C:\n  def m(p):\n    return p.f()\nc = C()\nc.m(A())\n"s}) {
+        ASSERT_THROWS(RunProgram(classes + source), runtime_error);
+    }
+    // поэтому программы с такими вызовами в невыполняемых ветвях работают
+    ASSERT_EQUAL(RunProgram(classes + "a = A()\nif False:\n  a.f(1, 2)\nprint a.f(1)\n"s),
+                 "1\n"s);
+    ASSERT_EQUAL(RunProgram(classes + "class C:\n  def m():\n    p = A()\n    return p.f()\n"s),
+                 ""s);
+    ParseOptions options;
+    options.bind_methods = false;
+    const string source = classes + "a = A()\na.f()\n"s;
+    parse::Lexer lexer(string_view{source});
+    auto unbound = ParseProgram(lexer, options);
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    ASSERT_THROWS(unbound->Execute(closure, context), runtime_error);
+}
+
 }  // namespace parse
 
 void TestParseProgram(TestRunner& tr) {
@@ -274,4 +509,13 @@ void TestParseProgram(TestRunner& tr) {
     RUN_TEST(tr, parse::TestRecursion2);
     RUN_TEST(tr, parse::TestComplexLogicalExpression);
     RUN_TEST(tr, parse::TestClassicalPolymorphism);
+    RUN_TEST(tr, parse::TestBuiltinFunctions);
+    RUN_TEST(tr, parse::TestHostBuiltins);
+    RUN_TEST(tr, parse::TestBuiltinArityIsCheckedAtParseTime);
+    RUN_TEST(tr, parse::TestOperatorPrecedence);
+    RUN_TEST(tr, parse::TestUnclosedBrackets);
+    RUN_TEST(tr, parse::TestDeeplyNestedExpressions);
+    RUN_TEST(tr, parse::TestLazyMethodBodies);
+    RUN_TEST(tr, parse::TestLazyParsingChecksBrackets);
+    RUN_TEST(tr, parse::TestMethodCallsAreBound);
 }
\ No newline at end of file
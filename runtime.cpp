@@ -1,5 +1,7 @@
 #include "runtime.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <optional>
 #include <sstream>
@@ -11,6 +13,13 @@ using namespace std;
 
 namespace runtime {
 
+namespace {
+const Symbol SELF{"self"s};
+const Symbol STR_METHOD{"__str__"s};
+const Symbol EQ_METHOD{"__eq__"s};
+const Symbol LT_METHOD{"__lt__"s};
+}  // namespace
+
 ObjectHolder::ObjectHolder(std::shared_ptr<Object> data)
     : data_(std::move(data)) {
 }
@@ -70,14 +79,14 @@ bool IsTrue(const ObjectHolder& object) {
 }
 
 void ClassInstance::Print(std::ostream& os, Context& context) {
-    if (HasMethod("__str__"s, 0U)) {
-        Call("__str__"s, {}, context)->Print(os, context);
+    if (HasMethod(STR_METHOD, 0U)) {
+        Call(STR_METHOD, {}, context)->Print(os, context);
     } else {
         os << this;
     }
 }
 
-bool ClassInstance::HasMethod(const std::string& method, size_t argument_count) const {
+bool ClassInstance::HasMethod(Symbol method, size_t argument_count) const {
     auto method_ptr = cls_.GetMethod(method);
     if (method_ptr) {
         return method_ptr->formal_params.size() == argument_count;
@@ -97,35 +106,47 @@ const Closure& ClassInstance::Fields() const {
 ClassInstance::ClassInstance(const Class& cls):cls_(cls)  {
 }
 
-ObjectHolder ClassInstance::Call(const std::string& method,
+ObjectHolder ClassInstance::Call(Symbol method,
                                  const std::vector<ObjectHolder>& actual_args,
                                  Context& context) {
-    if (HasMethod(method, actual_args.size())) {
-        auto method_ptr = cls_.GetMethod(method);
-        Closure params;
-        
-        // копирование в таблицу параметров
-        int count = actual_args.size();
-        for (int i = 0; i < count; i++) {
-            params[method_ptr->formal_params[i]] = actual_args.at(i);
-        }
-        params["self"] = ObjectHolder::Share(*this);
-
-        return method_ptr->body->Execute(params, context);
+    auto method_ptr = cls_.GetMethod(method);
+    if (method_ptr && method_ptr->formal_params.size() == actual_args.size()) {
+        return Call(*method_ptr, actual_args, context);
     } else {
         throw runtime_error("Method not implemented");
     }
 }
 
+ObjectHolder ClassInstance::Call(const Method& method,
+                                 const std::vector<ObjectHolder>& actual_args,
+                                 Context& context) {
+    Closure params;
+
+    // копирование в таблицу параметров
+    const size_t count = actual_args.size();
+    for (size_t i = 0; i < count; i++) {
+        params[method.formal_params[i]] = actual_args[i];
+    }
+    params[SELF] = ObjectHolder::Share(*this);
+
+    return method.body->Execute(params, context);
+}
+
+const Class& ClassInstance::GetClass() const {
+    return cls_;
+}
+
 Class::Class(std::string name, std::vector<Method> methods, const Class* parent) {
     name_ = std::move(name);
     for (auto &item:methods) {
         methods_[item.name] = std::move(item);
     }
     parent_ = parent;
+    static std::atomic<uint64_t> next_version{1};
+    version_ = next_version++;
 }
 
-const Method* Class::GetMethod(const std::string& name) const {
+const Method* Class::GetMethod(Symbol name) const {
     auto it = methods_.find(name);
     if (it != methods_.end()) {
         return &(it->second);
@@ -140,10 +161,20 @@ const Method* Class::GetMethod(const std::string& name) const {
     return name_;
 }
 
+uint64_t Class::GetVersion() const {
+    return parent_ != nullptr ? max(version_, parent_->GetVersion()) : version_;
+}
+
 void Class::Print(ostream& os, Context& /*context*/) {
     os << "Class " << name_;
 }
 
+ObjectHolder MakeBool(bool value) {
+    static const ObjectHolder TRUE_VALUE = ObjectHolder::Own(Bool(true));
+    static const ObjectHolder FALSE_VALUE = ObjectHolder::Own(Bool(false));
+    return value ? TRUE_VALUE : FALSE_VALUE;
+}
+
 void Bool::Print(std::ostream& os, [[maybe_unused]] Context& context) {
     os << (GetValue() ? "True"sv : "False"sv);
 }
@@ -151,8 +182,8 @@ void Bool::Print(std::ostream& os, [[maybe_unused]] Context& context) {
 bool Equal(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
     auto class_ptr = lhs.TryAs<ClassInstance>();
     if (class_ptr) {
-        if (class_ptr->HasMethod("__eq__", 1)) {
-            return IsTrue(class_ptr->Call("__eq__", {rhs}, context));
+        if (class_ptr->HasMethod(EQ_METHOD, 1)) {
+            return IsTrue(class_ptr->Call(EQ_METHOD, {rhs}, context));
         }
     }
     
@@ -182,8 +213,8 @@ bool Equal(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
 bool Less(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
     auto class_ptr = lhs.TryAs<ClassInstance>();
     if (class_ptr) {
-        if (class_ptr->HasMethod("__lt__", 1)) {
-            return IsTrue(class_ptr->Call("__lt__", {rhs}, context));
+        if (class_ptr->HasMethod(LT_METHOD, 1)) {
+            return IsTrue(class_ptr->Call(LT_METHOD, {rhs}, context));
         }
     }
     auto p_Number_1 = lhs.TryAs<Number>();
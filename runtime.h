@@ -1,19 +1,30 @@
 #pragma once
 
+#include "symbol.h"
+
 #include <memory>
 #include <sstream>
 #include <string>
+#include <typeinfo>
 #include <unordered_map>
 #include <vector>
 
 namespace runtime {
 
+class ObjectHolder;
+
 // Контекст исполнения инструкций Mython
 class Context {
 public:
     // Возвращает поток вывода для команд print
     virtual std::ostream& GetOutputStream() = 0;
 
+    // Возвращает значения входных переменных скомпилированной программы, разрешённых
+    // в слоты при разборе, либо nullptr, если программа выполняется без них
+    virtual const ObjectHolder* GetSlots() {
+        return nullptr;
+    }
+
 protected:
     ~Context() = default;
 };
@@ -60,6 +71,15 @@ public:
         return dynamic_cast<T*>(this->Get());
     }
 
+    // Возвращает указатель на объект, если его тип - в точности T, а не наследник T.
+    // Проверка дешевле TryAs, ею проверяют типы операндов специализированные узлы
+    template <typename T>
+    [[nodiscard]] T* TryAsExact() const {
+        Object* object = this->Get();
+        return object != nullptr && typeid(*object) == typeid(T) ? static_cast<T*>(object)
+                                                                 : nullptr;
+    }
+
     // Возвращает true, если ObjectHolder не пуст
     explicit operator bool() const;
     
@@ -95,7 +115,7 @@ private:
 };
 
 // Таблица символов, связывающая имя объекта с его значением
-using Closure = std::unordered_map<std::string, ObjectHolder>;
+using Closure = std::unordered_map<Symbol, ObjectHolder>;
 
 // Проверяет, содержится ли в object значение, приводимое к True
 // Для отличных от нуля чисел, True и непустых строк возвращается true. В остальных случаях - false.
@@ -108,6 +128,11 @@ public:
     // Выполняет действие над объектами внутри closure, используя context
     // Возвращает результирующее значение либо None
     virtual ObjectHolder Execute(Closure& closure, Context& context) = 0;
+
+    // Узлы, созданные во время разбора программы, размещаются в арене разбора
+    // (см. ast::ArenaScope), остальные - в общей куче
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr) noexcept;
 };
 
 // Строковое значение
@@ -123,12 +148,16 @@ public:
     void Print(std::ostream& os, Context& context) override;
 };
 
+// Возвращает общий объект True или False. Логические значения неизменяемы, поэтому
+// результаты сравнений не создают новых объектов
+ObjectHolder MakeBool(bool value);
+
 // Метод класса
 struct Method {
     // Имя метода
-    std::string name;
+    Symbol name;
     // Имена формальных параметров метода
-    std::vector<std::string> formal_params;
+    std::vector<Symbol> formal_params;
     // Тело метода
     std::unique_ptr<Executable> body;
 };
@@ -141,18 +170,24 @@ public:
     explicit Class(std::string name, std::vector<Method> methods, const Class* parent);
 
     // Возвращает указатель на метод name или nullptr, если метод с таким именем отсутствует
-    [[nodiscard]] const Method* GetMethod(const std::string& name) const;
+    [[nodiscard]] const Method* GetMethod(Symbol name) const;
 
     // Возвращает имя класса
     [[nodiscard]] const std::string& GetName() const;
 
+    // Возвращает номер определения класса с учётом его родителей. Номера определений
+    // возрастают, поэтому результат меняется, когда новое определение получает сам класс
+    // или любой из его родителей
+    [[nodiscard]] uint64_t GetVersion() const;
+
     // Выводит в os строку "Class <имя класса>", например "Class cat"
     void Print(std::ostream& os, Context& context) override;
 private:
     std::string name_;
     //std::vector<Method> methods_;
-    std::unordered_map<std::string, Method> methods_;
+    std::unordered_map<Symbol, Method> methods_;
     const Class* parent_;
+    uint64_t version_;
 };
 
 // Экземпляр класса
@@ -172,11 +207,19 @@ public:
      * Если ни сам класс, ни его родители не содержат метод method, метод выбрасывает исключение
      * runtime_error
      */
-    ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
+    ObjectHolder Call(Symbol method, const std::vector<ObjectHolder>& actual_args,
+                      Context& context);
+
+    // Вызывает у объекта метод method его класса, найденный ранее. Количество параметров
+    // должно совпадать с количеством формальных параметров метода
+    ObjectHolder Call(const Method& method, const std::vector<ObjectHolder>& actual_args,
                       Context& context);
 
+    // Возвращает класс объекта
+    [[nodiscard]] const Class& GetClass() const;
+
     // Возвращает true, если объект имеет метод method, принимающий argument_count параметров
-    [[nodiscard]] bool HasMethod(const std::string& method, size_t argument_count) const;
+    [[nodiscard]] bool HasMethod(Symbol method, size_t argument_count) const;
 
     // Возвращает ссылку на Closure, содержащий поля объекта
     [[nodiscard]] Closure& Fields();
@@ -240,4 +283,26 @@ private:
     std::ostream& output_;
 };
 
+// Контекст, добавляющий к контексту base значения входных переменных slots.
+// Вывод перенаправляется в поток контекста base
+class SlotContext : public runtime::Context {
+public:
+    SlotContext(Context& base, const ObjectHolder* slots)
+        : base_(base)
+        , slots_(slots) {
+    }
+
+    std::ostream& GetOutputStream() override {
+        return base_.GetOutputStream();
+    }
+
+    const ObjectHolder* GetSlots() override {
+        return slots_;
+    }
+
+private:
+    Context& base_;
+    const ObjectHolder* slots_;
+};
+
 }  // namespace runtime
\ No newline at end of file
@@ -121,24 +121,27 @@ void TestMethodInvocation() {
     };
     vector<Method> base_methods;
     base_methods.push_back(
-        {"test"s, {"arg1"s, "arg2"s}, make_unique<TestMethodBody>(base_method_1)});
-    base_methods.push_back({"test_2"s, {"arg1"s}, make_unique<TestMethodBody>(base_method_2)});
+        {Symbol("test"s), {Symbol("arg1"s), Symbol("arg2"s)},
+         make_unique<TestMethodBody>(base_method_1)});
+    base_methods.push_back(
+        {Symbol("test_2"s), {Symbol("arg1"s)}, make_unique<TestMethodBody>(base_method_2)});
     Class base_class{"Base"s, std::move(base_methods), nullptr};
     ClassInstance base_inst{base_class};
-    base_inst.Fields()["base_field"s] = ObjectHolder::Own(String{"hello"s});
-    ASSERT(base_inst.HasMethod("test"s, 2U));
+    base_inst.Fields()[Symbol("base_field"s)] = ObjectHolder::Own(String{"hello"s});
+    ASSERT(base_inst.HasMethod(Symbol("test"s), 2U));
     auto res = base_inst.Call(
-        "test"s, {ObjectHolder::Own(Number{1}), ObjectHolder::Own(String{"abc"s})}, context);
+        Symbol("test"s), {ObjectHolder::Own(Number{1}), ObjectHolder::Own(String{"abc"s})},
+        context);
     ASSERT(Equal(res, ObjectHolder::Own(Number{123}), context));
     ASSERT_EQUAL(base_closure.size(), 3U);
-    ASSERT_EQUAL(base_closure.count("self"s), 1U);
-    ASSERT_EQUAL(base_closure.at("self"s).Get(), &base_inst);
-    ASSERT_EQUAL(base_closure.count("self"s), 1U);
-    ASSERT_EQUAL(base_closure.count("arg1"s), 1U);
-    ASSERT(Equal(base_closure.at("arg1"s), ObjectHolder::Own(Number{1}), context));
-    ASSERT_EQUAL(base_closure.count("arg2"s), 1U);
-    ASSERT(Equal(base_closure.at("arg2"s), ObjectHolder::Own(String{"abc"s}), context));
-    ASSERT_EQUAL(base_closure.count("base_field"s), 0U);
+    ASSERT_EQUAL(base_closure.count(Symbol("self"s)), 1U);
+    ASSERT_EQUAL(base_closure.at(Symbol("self"s)).Get(), &base_inst);
+    ASSERT_EQUAL(base_closure.count(Symbol("self"s)), 1U);
+    ASSERT_EQUAL(base_closure.count(Symbol("arg1"s)), 1U);
+    ASSERT(Equal(base_closure.at(Symbol("arg1"s)), ObjectHolder::Own(Number{1}), context));
+    ASSERT_EQUAL(base_closure.count(Symbol("arg2"s)), 1U);
+    ASSERT(Equal(base_closure.at(Symbol("arg2"s)), ObjectHolder::Own(String{"abc"s}), context));
+    ASSERT_EQUAL(base_closure.count(Symbol("base_field"s)), 0U);
 
     Closure child_closure;
     auto child_method_1 = [&child_closure, &context](Closure& closure, Context& ctx) {
@@ -148,36 +151,40 @@ void TestMethodInvocation() {
     };
     vector<Method> child_methods;
     child_methods.push_back(
-        {"test"s, {"arg1_child"s, "arg2_child"s}, make_unique<TestMethodBody>(child_method_1)});
+        {Symbol("test"s), {Symbol("arg1_child"s), Symbol("arg2_child"s)},
+         make_unique<TestMethodBody>(child_method_1)});
     Class child_class{"Child"s, std::move(child_methods), &base_class};
     ClassInstance child_inst{child_class};
-    ASSERT(child_inst.HasMethod("test"s, 2U));
+    ASSERT(child_inst.HasMethod(Symbol("test"s), 2U));
     base_closure.clear();
     res = child_inst.Call(
-        "test"s, {ObjectHolder::Own(String{"value1"s}), ObjectHolder::Own(String{"value2"s})},
+        Symbol("test"s),
+        {ObjectHolder::Own(String{"value1"s}), ObjectHolder::Own(String{"value2"s})},
         context);
     ASSERT(Equal(res, ObjectHolder::Own(String{"child"s}), context));
     ASSERT(base_closure.empty());
     ASSERT_EQUAL(child_closure.size(), 3U);
-    ASSERT_EQUAL(child_closure.count("self"s), 1U);
-    ASSERT_EQUAL(child_closure.at("self"s).Get(), &child_inst);
-    ASSERT_EQUAL(child_closure.count("arg1_child"s), 1U);
-    ASSERT(Equal(child_closure.at("arg1_child"s), (ObjectHolder::Own(String{"value1"s})), context));
-    ASSERT_EQUAL(child_closure.count("arg2_child"s), 1U);
-    ASSERT(Equal(child_closure.at("arg2_child"s), (ObjectHolder::Own(String{"value2"s})), context));
-
-    ASSERT(child_inst.HasMethod("test_2"s, 1U));
+    ASSERT_EQUAL(child_closure.count(Symbol("self"s)), 1U);
+    ASSERT_EQUAL(child_closure.at(Symbol("self"s)).Get(), &child_inst);
+    ASSERT_EQUAL(child_closure.count(Symbol("arg1_child"s)), 1U);
+    ASSERT(Equal(child_closure.at(Symbol("arg1_child"s)), (ObjectHolder::Own(String{"value1"s})),
+                 context));
+    ASSERT_EQUAL(child_closure.count(Symbol("arg2_child"s)), 1U);
+    ASSERT(Equal(child_closure.at(Symbol("arg2_child"s)), (ObjectHolder::Own(String{"value2"s})),
+                 context));
+
+    ASSERT(child_inst.HasMethod(Symbol("test_2"s), 1U));
     child_closure.clear();
-    res = child_inst.Call("test_2"s, {ObjectHolder::Own(String{":)"s})}, context);
+    res = child_inst.Call(Symbol("test_2"s), {ObjectHolder::Own(String{":)"s})}, context);
     ASSERT(Equal(res, ObjectHolder::Own(Number{456}), context));
     ASSERT_EQUAL(base_closure.size(), 2U);
-    ASSERT_EQUAL(base_closure.count("self"s), 1U);
-    ASSERT_EQUAL(base_closure.at("self"s).Get(), &child_inst);
-    ASSERT_EQUAL(base_closure.count("arg1"s), 1U);
-    ASSERT(Equal(base_closure.at("arg1"s), (ObjectHolder::Own(String{":)"s})), context));
+    ASSERT_EQUAL(base_closure.count(Symbol("self"s)), 1U);
+    ASSERT_EQUAL(base_closure.at(Symbol("self"s)).Get(), &child_inst);
+    ASSERT_EQUAL(base_closure.count(Symbol("arg1"s)), 1U);
+    ASSERT(Equal(base_closure.at(Symbol("arg1"s)), (ObjectHolder::Own(String{":)"s})), context));
 
-    ASSERT(!child_inst.HasMethod("test"s, 1U));
-    ASSERT_THROWS(child_inst.Call("test"s, {ObjectHolder::None()}, context), runtime_error);
+    ASSERT(!child_inst.HasMethod(Symbol("test"s), 1U));
+    ASSERT_THROWS(child_inst.Call(Symbol("test"s), {ObjectHolder::None()}, context), runtime_error);
 }
 
 void TestNonowning() {
@@ -428,8 +435,10 @@ void TestComparison() {
         };
 
         std::vector<Method> cls1_methods;
-        cls1_methods.push_back({"__eq__"s, {"rhs"s}, std::make_unique<TestMethodBody>(eq_body)});
-        cls1_methods.push_back({"__lt__"s, {"rhs"s}, std::make_unique<TestMethodBody>(lt_body)});
+        cls1_methods.push_back(
+            {Symbol("__eq__"s), {Symbol("rhs"s)}, std::make_unique<TestMethodBody>(eq_body)});
+        cls1_methods.push_back(
+            {Symbol("__lt__"s), {Symbol("rhs"s)}, std::make_unique<TestMethodBody>(lt_body)});
         Class cls1{"Class1"s, std::move(cls1_methods), nullptr};
         ClassInstance lhs{cls1};
 
@@ -439,8 +448,8 @@ void TestComparison() {
         // Equal / NotEqual
         eq_result = ObjectHolder::Own(Bool{true});
         test_equal(ObjectHolder::Share(lhs), ObjectHolder::Share(rhs), true);
-        ASSERT(eq_closure.at("self"s).TryAs<ClassInstance>() == &lhs);
-        ASSERT(eq_closure.at("rhs"s).TryAs<ClassInstance>() == &rhs);
+        ASSERT(eq_closure.at(Symbol("self"s)).TryAs<ClassInstance>() == &lhs);
+        ASSERT(eq_closure.at(Symbol("rhs"s)).TryAs<ClassInstance>() == &rhs);
         ASSERT(lt_closure.empty());
         eq_result = ObjectHolder::Own(Bool{false});
         test_equal(ObjectHolder::Share(lhs), ObjectHolder::Share(rhs), false);
@@ -451,8 +460,8 @@ void TestComparison() {
         eq_result = ObjectHolder::Own(Bool{false});
         lt_result = ObjectHolder::Own(Bool{true});
         test_less(ObjectHolder::Share(lhs), ObjectHolder::Share(rhs), true);
-        ASSERT(lt_closure.at("self"s).TryAs<ClassInstance>() == &lhs);
-        ASSERT(lt_closure.at("rhs"s).TryAs<ClassInstance>() == &rhs);
+        ASSERT(lt_closure.at(Symbol("self"s)).TryAs<ClassInstance>() == &lhs);
+        ASSERT(lt_closure.at(Symbol("rhs"s)).TryAs<ClassInstance>() == &rhs);
         ASSERT(eq_closure.empty());
         eq_result = ObjectHolder::Own(Bool{true});
         lt_result = ObjectHolder::Own(Bool{false});
@@ -464,10 +473,10 @@ void TestComparison() {
         eq_result = ObjectHolder::Own(Bool{false});
         lt_result = ObjectHolder::Own(Bool{false});
         test_greater(ObjectHolder::Share(lhs), ObjectHolder::Share(rhs), true);
-        ASSERT(eq_closure.at("self"s).TryAs<ClassInstance>() == &lhs);
-        ASSERT(eq_closure.at("rhs"s).TryAs<ClassInstance>() == &rhs);
-        ASSERT(lt_closure.at("self"s).TryAs<ClassInstance>() == &lhs);
-        ASSERT(lt_closure.at("rhs"s).TryAs<ClassInstance>() == &rhs);
+        ASSERT(eq_closure.at(Symbol("self"s)).TryAs<ClassInstance>() == &lhs);
+        ASSERT(eq_closure.at(Symbol("rhs"s)).TryAs<ClassInstance>() == &rhs);
+        ASSERT(lt_closure.at(Symbol("self"s)).TryAs<ClassInstance>() == &lhs);
+        ASSERT(lt_closure.at(Symbol("rhs"s)).TryAs<ClassInstance>() == &rhs);
         eq_result = ObjectHolder::Own(Bool{true});
         lt_result = ObjectHolder::Own(Bool{true});
         test_greater(ObjectHolder::Share(lhs), ObjectHolder::Share(rhs), false);
@@ -483,12 +492,13 @@ void TestClass() {
         passed_context = &ctx;
         return ObjectHolder::Own(Number{42});
     };
-    methods.push_back({"method"s, {"arg1"s, "arg2"s}, make_unique<TestMethodBody>(body)});
+    methods.push_back(
+        {Symbol("method"s), {Symbol("arg1"s), Symbol("arg2"s)}, make_unique<TestMethodBody>(body)});
     Class cls{"Test"s, move(methods), nullptr};
     ASSERT_EQUAL(cls.GetName(), "Test"s);
-    ASSERT_EQUAL(cls.GetMethod("missing_method"s), nullptr);
+    ASSERT_EQUAL(cls.GetMethod(Symbol("missing_method"s)), nullptr);
 
-    const Method* method = cls.GetMethod("method"s);
+    const Method* method = cls.GetMethod(Symbol("method"s));
     ASSERT(method != nullptr);
     DummyContext ctx;
     Closure closure;
@@ -513,20 +523,20 @@ void TestClassInstance() {
         return ObjectHolder::Own(String{"result"s});
     };
 
-    methods.push_back({"__str__", {}, make_unique<TestMethodBody>(str_body)});
+    methods.push_back({Symbol("__str__"), {}, make_unique<TestMethodBody>(str_body)});
 
     Class cls{"Test"s, move(methods), nullptr};
     ClassInstance instance{cls};
 
     ASSERT_EQUAL(&instance.Fields(), &const_cast<const ClassInstance&>(instance).Fields());
-    ASSERT(instance.HasMethod("__str__"s, 0));
+    ASSERT(instance.HasMethod(Symbol("__str__"s), 0));
 
     ostringstream out;
     DummyContext ctx;
     instance.Print(out, ctx);
     ASSERT_EQUAL(out.str(), "result"s);
 
-    ASSERT_THROWS(instance.Call("missing_method"s, {}, ctx), runtime_error);
+    ASSERT_THROWS(instance.Call(Symbol("missing_method"s), {}, ctx), runtime_error);
 }
 
 }  // namespace
@@ -0,0 +1,17 @@
+#pragma once
+
+// Определение доступного набора векторных инструкций.
+// MYTHON_SIMD_AVX2 - сборка с AVX2 (опция MYTHON_USE_AVX2),
+// MYTHON_SIMD_SSE2 - SSE2, доступный на любом x86-64.
+// Если ни один макрос не определён, используются скалярные версии алгоритмов
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MYTHON_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+#define MYTHON_SIMD_SSE2
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+/*
+ * Очередь фиксированной ёмкости для одного потока-писателя и одного потока-читателя.
+ * Не использует блокировок: писатель изменяет только tail_, читатель - только head_.
+ * Capacity должна быть степенью двойки
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    // Добавляет значение в очередь. Возвращает false, если очередь заполнена.
+    // Вызывается только потоком-писателем
+    bool TryPush(T&& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots_[tail & (Capacity - 1)] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Извлекает значение из очереди или возвращает nullopt, если очередь пуста.
+    // Вызывается только потоком-читателем
+    std::optional<T> TryPop() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        std::optional<T> result(std::move(slots_[head & (Capacity - 1)]));
+        head_.store(head + 1, std::memory_order_release);
+        return result;
+    }
+
+private:
+    // счётчики разнесены по разным строкам кэша, чтобы потоки не мешали друг другу
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::array<T, Capacity> slots_{};
+};
@@ -1,7 +1,12 @@
 #include "statement.h"
 
+#include "ast_arena.h"
+#include "host_object.h"
+#include "int_array.h"
+
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <utility>
 #include <functional>
 
@@ -14,50 +19,142 @@ using runtime::Context;
 using runtime::ObjectHolder;
 
 namespace {
-const string ADD_METHOD = "__add__"s;
-const string INIT_METHOD = "__init__"s;
+const runtime::Symbol ADD_METHOD{"__add__"s};
+const runtime::Symbol INIT_METHOD{"__init__"s};
 }  // namespace
 
+TypeFeedback ObserveOperands(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+    if (lhs.TryAsExact<runtime::Number>() && rhs.TryAsExact<runtime::Number>()) {
+        return TypeFeedback::NUMBERS;
+    }
+    if (lhs.TryAsExact<runtime::String>() && rhs.TryAsExact<runtime::String>()) {
+        return TypeFeedback::STRINGS;
+    }
+    return TypeFeedback::GENERIC;
+}
+
 ObjectHolder Assignment::Execute(Closure& closure, Context& context) {
-    closure[var_name] = var_value->Execute(closure, context);
-    return closure.at(var_name);
+    auto& value = closure[var_name];
+    value = var_value->Execute(closure, context);
+    return value;
 }
 
-Assignment::Assignment(std::string var, std::unique_ptr<Statement> rv) {
-    var_name = std::move(var);
+Assignment::Assignment(runtime::Symbol var, std::unique_ptr<Statement> rv) {
+    var_name = var;
     var_value = std::move(rv);
 }
 
-VariableValue::VariableValue(const std::string& var_name)
+VariableValue::VariableValue(runtime::Symbol var_name)
     : name{var_name} {
 }
 
-VariableValue::VariableValue(std::vector<std::string> dotted_ids) {
-    if (auto size = dotted_ids.size(); size > 0) {
-        name = std::move(dotted_ids.at(0));
-        list_ids.resize(size - 1);
-        std::move(std::next(dotted_ids.begin()), dotted_ids.end(), list_ids.begin());
+VariableValue::VariableValue(std::vector<runtime::Symbol> dotted_ids) {
+    if (!dotted_ids.empty()) {
+        name = dotted_ids.front();
+        dotted_ids.erase(dotted_ids.begin());
+        list_ids = std::move(dotted_ids);
     }
 }
 
+VariableValue::VariableValue(const std::vector<std::string>& dotted_ids)
+    : VariableValue(std::vector<runtime::Symbol>(dotted_ids.begin(), dotted_ids.end())) {
+}
+
+VariableValue VariableValue::Slot(size_t slot, std::vector<runtime::Symbol> dotted_ids) {
+    VariableValue result(std::move(dotted_ids));
+    result.slot_ = slot;
+    return result;
+}
+
+std::optional<size_t> VariableValue::GetSlot() const {
+    if (slot_ == NO_SLOT) {
+        return std::nullopt;
+    }
+    return slot_;
+}
+
+const std::string& VariableValue::GetName() const {
+    return name.GetName();
+}
+
+runtime::Symbol VariableValue::GetSymbol() const {
+    return name;
+}
+
+const std::vector<runtime::Symbol>& VariableValue::GetFieldIds() const {
+    return list_ids;
+}
+
+TypeFeedback VariableValue::GetTypeFeedback() const {
+    return feedback_;
+}
+
+void VariableValue::DisableTypeFeedback() {
+    feedback_ = TypeFeedback::GENERIC;
+}
+
 ObjectHolder VariableValue::Execute(Closure &closure, Context &context) {
-    if (closure.count(name)) {
-        auto result = closure.at(name);
-        if (list_ids.size() > 0) {
-            if (auto obj = result.TryAs<runtime::ClassInstance>()) {
-                return VariableValue(list_ids).Execute(obj->Fields(), context);
-            } else {
-                throw std::runtime_error("Variable " + name+ " is not class"s);
-            }
+    ObjectHolder result;
+    if (slot_ != NO_SLOT) {
+        const ObjectHolder* slots = context.GetSlots();
+        if (!slots) {
+            throw std::runtime_error("Input variable "s + name.GetName() + " is not bound"s);
         }
-        return result;
+        result = slots[slot_];
     } else {
-        throw std::runtime_error("Variable "s + name + " not found"s);
+        auto it = closure.find(name);
+        if (it == closure.end()) {
+            throw std::runtime_error("Variable "s + name.GetName() + " not found"s);
+        }
+        result = it->second;
+    }
+    if (feedback_ == TypeFeedback::UNINITIALIZED) {
+        feedback_ = list_ids.empty() ? TypeFeedback::GENERIC : TypeFeedback::INSTANCES;
+    }
+    runtime::Symbol owner = name;
+    for (const auto& id : list_ids) {
+        if (feedback_ == TypeFeedback::INSTANCES) {
+            if (auto obj = result.TryAsExact<runtime::ClassInstance>()) {
+                auto field = obj->Fields().find(id);
+                if (field == obj->Fields().end()) {
+                    throw std::runtime_error("Variable "s + id.GetName() + " not found"s);
+                }
+                result = field->second;
+                owner = id;
+                continue;
+            }
+            feedback_ = TypeFeedback::GENERIC;
+        }
+        if (auto obj = result.TryAs<runtime::ClassInstance>()) {
+            auto field = obj->Fields().find(id);
+            if (field == obj->Fields().end()) {
+                throw std::runtime_error("Variable "s + id.GetName() + " not found"s);
+            }
+            result = field->second;
+        } else if (auto host = result.TryAs<runtime::HostObject>()) {
+            result = host->GetField(id.GetName());
+        } else {
+            throw std::runtime_error("Variable " + owner.GetName() + " is not class"s);
+        }
+        owner = id;
     }
+    return result;
+}
+
+bool IsConstant(const Statement& node) {
+    return dynamic_cast<const NumericConst*>(&node) || dynamic_cast<const StringConst*>(&node)
+           || dynamic_cast<const BoolConst*>(&node) || dynamic_cast<const None*>(&node);
+}
+
+ObjectHolder EvaluateConstant(Statement& node) {
+    runtime::DummyContext context;
+    Closure closure;
+    return node.Execute(closure, context);
 }
 
 unique_ptr<Print> Print::Variable(const std::string& name) {
-    return std::make_unique<Print>(Print(std::make_unique<VariableValue>(VariableValue(name))));
+    return std::make_unique<Print>(
+        Print(std::make_unique<VariableValue>(VariableValue(runtime::Symbol(name)))));
 }
 
 Print::Print(unique_ptr<Statement> argument) {
@@ -88,20 +185,90 @@ ObjectHolder Print::Execute(Closure& closure, Context& context) {
     return t;
 }
 
-MethodCall::MethodCall(std::unique_ptr<Statement> object, std::string method,
-                       std::vector<std::unique_ptr<Statement>> args) {
+MethodCall::MethodCall(std::unique_ptr<Statement> object, runtime::Symbol method,
+                       std::vector<std::unique_ptr<Statement>> args, InlineLimits limits)
+    : limits_(limits) {
     object_ = std::move(object);
-    method_ = std::move(method);
+    method_ = method;
     args_ = std::move(args);
 }
 
+MethodCall::~MethodCall() = default;
+
+const InlinedCall* MethodCall::GetInlinedCall() const {
+    return cached_call_.get();
+}
+
+bool MethodCall::Bind(const runtime::Class& cls) {
+    const runtime::Method* method = cls.GetMethod(method_);
+    if (!method || method->formal_params.size() != args_.size()) {
+        return false;
+    }
+    feedback_ = TypeFeedback::INSTANCES;
+    cached_class_ = &cls;
+    cached_version_ = cls.GetVersion();
+    cached_method_ = method;
+    cached_call_.reset();
+    return true;
+}
+
+TypeFeedback MethodCall::GetTypeFeedback() const {
+    return feedback_;
+}
+
+void MethodCall::DisableTypeFeedback() {
+    feedback_ = TypeFeedback::GENERIC;
+    cached_class_ = nullptr;
+    cached_method_ = nullptr;
+    cached_call_.reset();
+}
+
 ObjectHolder MethodCall::Execute(Closure& closure, Context& context) {
     std::vector<runtime::ObjectHolder> values;
     for (auto &arg:args_) {
         values.push_back(arg->Execute(closure, context));
     }
-    auto obj_ptr = object_->Execute(closure, context).TryAs<runtime::ClassInstance>();
-    return obj_ptr->Call(method_, values, context);
+    auto object = object_->Execute(closure, context);
+    if (feedback_ != TypeFeedback::GENERIC) {
+        if (auto instance = object.TryAsExact<runtime::ClassInstance>()) {
+            const runtime::Class& cls = instance->GetClass();
+            if (feedback_ == TypeFeedback::UNINITIALIZED) {
+                Bind(cls);
+            }
+            if (feedback_ == TypeFeedback::INSTANCES && &cls == cached_class_
+                && cls.GetVersion() == cached_version_) {
+                if (!cached_call_) {
+                    cached_call_ = std::make_unique<InlinedCall>(*cached_method_, cls, limits_);
+                }
+                return cached_call_->Call(*instance, values, context);
+            }
+        }
+        feedback_ = TypeFeedback::GENERIC;
+    }
+    if (auto obj_ptr = object.TryAs<runtime::ClassInstance>()) {
+        return obj_ptr->Call(method_, values, context);
+    }
+    if (auto array_ptr = object.TryAs<runtime::IntArray>()) {
+        return array_ptr->Call(method_.GetName(), values, context);
+    }
+    if (auto host_ptr = object.TryAs<runtime::HostObject>()) {
+        return host_ptr->Call(method_.GetName(), values, context);
+    }
+    throw std::runtime_error("Method "s + method_.GetName() + " called on non-object"s);
+}
+
+BuiltinCall::BuiltinCall(runtime::BuiltinFunction function,
+                         std::vector<std::unique_ptr<Statement>> args)
+    : function_(function), args_(std::move(args)) {
+}
+
+ObjectHolder BuiltinCall::Execute(Closure& closure, Context& context) {
+    std::vector<runtime::ObjectHolder> values;
+    values.reserve(args_.size());
+    for (auto &arg:args_) {
+        values.push_back(arg->Execute(closure, context));
+    }
+    return function_(values, context);
 }
 
 ObjectHolder Stringify::Execute(Closure& closure, Context& context) {
@@ -119,7 +286,36 @@ ObjectHolder Stringify::Execute(Closure& closure, Context& context) {
 ObjectHolder Add::Execute(Closure& closure, Context& context) {
     auto lhs_value = lhs_->Execute(closure, context);
     auto rhs_value = rhs_->Execute(closure, context);
-    
+
+    switch (feedback_) {
+        case TypeFeedback::NUMBERS:
+            if (auto lhs_number = lhs_value.TryAsExact<runtime::Number>()) {
+                if (auto rhs_number = rhs_value.TryAsExact<runtime::Number>()) {
+                    return ObjectHolder::Own(
+                        runtime::Number(lhs_number->GetValue() + rhs_number->GetValue()));
+                }
+            }
+            break;
+        case TypeFeedback::STRINGS:
+            if (auto lhs_string = lhs_value.TryAsExact<runtime::String>()) {
+                if (auto rhs_string = rhs_value.TryAsExact<runtime::String>()) {
+                    return ObjectHolder::Own(
+                        runtime::String(lhs_string->GetValue() + rhs_string->GetValue()));
+                }
+            }
+            break;
+        case TypeFeedback::UNINITIALIZED:
+            feedback_ = ObserveOperands(lhs_value, rhs_value);
+            [[fallthrough]];
+        default:
+            return Apply(lhs_value, rhs_value, context);
+    }
+    feedback_ = TypeFeedback::GENERIC;
+    return Apply(lhs_value, rhs_value, context);
+}
+
+ObjectHolder Add::Apply(const ObjectHolder& lhs_value, const ObjectHolder& rhs_value,
+                        Context& context) {
     auto pNumber1 = lhs_value.TryAs<runtime::Number>();
     auto pNumber2 = rhs_value.TryAs<runtime::Number>();
     if (pNumber1 && pNumber2) {
@@ -147,7 +343,21 @@ ObjectHolder Add::Execute(Closure& closure, Context& context) {
 ObjectHolder Sub::Execute(Closure& closure, Context& context) {
     auto lhs_value = lhs_->Execute(closure, context);
     auto rhs_value = rhs_->Execute(closure, context);
-    
+
+    if (feedback_ == TypeFeedback::NUMBERS) {
+        if (auto lhs_number = lhs_value.TryAsExact<runtime::Number>()) {
+            if (auto rhs_number = rhs_value.TryAsExact<runtime::Number>()) {
+                return ObjectHolder::Own(
+                    runtime::Number(lhs_number->GetValue() - rhs_number->GetValue()));
+            }
+        }
+        feedback_ = TypeFeedback::GENERIC;
+    } else if (feedback_ == TypeFeedback::UNINITIALIZED) {
+        feedback_ = ObserveOperands(lhs_value, rhs_value) == TypeFeedback::NUMBERS
+                        ? TypeFeedback::NUMBERS
+                        : TypeFeedback::GENERIC;
+    }
+
     auto pNumber1 = lhs_value.TryAs<runtime::Number>();
     auto pNumber2 = rhs_value.TryAs<runtime::Number>();
     if (pNumber1 && pNumber2) {
@@ -204,28 +414,32 @@ ClassDefinition::ClassDefinition(ObjectHolder cls): cls_(cls) {
 }
 
 ObjectHolder ClassDefinition::Execute(Closure& closure, Context& /*context*/) {
-    string name = cls_.TryAs<runtime::Class>()->GetName();
+    runtime::Symbol name(cls_.TryAs<runtime::Class>()->GetName());
     closure[name] = cls_;
-    return closure.at(name);
+    return cls_;
 }
 
-FieldAssignment::FieldAssignment(VariableValue object, std::string field_name, std::unique_ptr<Statement> rv): object_(object) {
-    field_name_ = std::move(field_name);
+FieldAssignment::FieldAssignment(VariableValue object, runtime::Symbol field_name,
+                                 std::unique_ptr<Statement> rv): object_(object) {
+    field_name_ = field_name;
     rv_ = std::move(rv);
 
 }
 
 ObjectHolder FieldAssignment::Execute(Closure& closure, Context& context) {
-    auto obj_ptr = object_.Execute(closure, context).TryAs<runtime::ClassInstance>();
+    auto object = object_.Execute(closure, context);
+    if (auto host_ptr = object.TryAs<runtime::HostObject>()) {
+        auto value = rv_->Execute(closure, context);
+        host_ptr->SetField(field_name_.GetName(), value);
+        return value;
+    }
+    auto obj_ptr = object.TryAs<runtime::ClassInstance>();
     if (!obj_ptr) {
         throw std::runtime_error("Is not object");
     }
-    obj_ptr->Fields()[field_name_] = rv_->Execute(closure, context);
-    if (obj_ptr->Fields().at(field_name_)) {
-        return obj_ptr->Fields().at(field_name_);
-    } else {
-        return runtime::ObjectHolder::None();
-    }
+    auto& field = obj_ptr->Fields()[field_name_];
+    field = rv_->Execute(closure, context);
+    return field;
 }
 
 IfElse::IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
@@ -236,7 +450,10 @@ IfElse::IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement>
 }
 
 ObjectHolder IfElse::Execute(Closure& closure, Context& context) {
-    bool f = runtime::IsTrue(condition_->Execute(closure, context));
+    return ExecuteBranch(runtime::IsTrue(condition_->Execute(closure, context)), closure, context);
+}
+
+ObjectHolder IfElse::ExecuteBranch(bool f, Closure& closure, Context& context) {
     if (f) {
         return if_body_->Execute(closure, context);
     } else {
@@ -273,34 +490,91 @@ ObjectHolder Not::Execute(Closure& closure, Context& context) {
     return ObjectHolder::Own(runtime::Bool(!f));
 }
 
+ObjectHolder Negate::Execute(Closure& closure, Context& context) {
+    auto value = argument_->Execute(closure, context);
+    if (auto pNumber = value.TryAs<runtime::Number>()) {
+        return ObjectHolder::Own(runtime::Number(-pNumber->GetValue()));
+    }
+    throw std::runtime_error("Negate operation. Invalid argument.");
+}
+
 Comparison::Comparison(Comparator cmp, unique_ptr<Statement> lhs, unique_ptr<Statement> rhs)
     : BinaryOperation(std::move(lhs), std::move(rhs)), cmp_(cmp) {
 }
 
+Comparison::Comparison(unique_ptr<Statement> lhs, unique_ptr<Statement> rhs)
+    : BinaryOperation(std::move(lhs), std::move(rhs)) {
+}
+
+bool Comparison::Compare(const ObjectHolder& lhs, const ObjectHolder& rhs,
+                         Context& context) const {
+    return cmp_(lhs, rhs, context);
+}
+
+std::optional<ComparisonOp> Comparison::GetOperator() const {
+    return std::nullopt;
+}
+
 ObjectHolder Comparison::Execute(Closure& closure, Context& context) {
     auto lhs_value = lhs_->Execute(closure, context);
     auto rhs_value = rhs_->Execute(closure, context);
     
-    bool f = cmp_(lhs_value, rhs_value, context);
-    return ObjectHolder::Own(runtime::Bool(f));
+    return runtime::MakeBool(cmp_(lhs_value, rhs_value, context));
+}
+
+std::unique_ptr<Comparison> MakeComparison(ComparisonOp op, std::unique_ptr<Statement> lhs,
+                                           std::unique_ptr<Statement> rhs) {
+    switch (op) {
+        case ComparisonOp::EQUAL:
+            return make_unique<OperatorComparison<ComparisonOp::EQUAL>>(std::move(lhs),
+                                                                        std::move(rhs));
+        case ComparisonOp::NOT_EQUAL:
+            return make_unique<OperatorComparison<ComparisonOp::NOT_EQUAL>>(std::move(lhs),
+                                                                            std::move(rhs));
+        case ComparisonOp::LESS:
+            return make_unique<OperatorComparison<ComparisonOp::LESS>>(std::move(lhs),
+                                                                       std::move(rhs));
+        case ComparisonOp::GREATER:
+            return make_unique<OperatorComparison<ComparisonOp::GREATER>>(std::move(lhs),
+                                                                          std::move(rhs));
+        case ComparisonOp::LESS_OR_EQUAL:
+            return make_unique<OperatorComparison<ComparisonOp::LESS_OR_EQUAL>>(std::move(lhs),
+                                                                                std::move(rhs));
+        case ComparisonOp::GREATER_OR_EQUAL:
+            return make_unique<OperatorComparison<ComparisonOp::GREATER_OR_EQUAL>>(
+                std::move(lhs), std::move(rhs));
+    }
+    throw std::invalid_argument("Unknown comparison operation");
 }
 
 NewInstance::NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args): class_def(class_){
     args_list = std::move(args);
+    ResolveInit();
 }
 
 NewInstance::NewInstance(const runtime::Class& class_): class_def(class_) {
+    ResolveInit();
+}
+
+void NewInstance::ResolveInit() {
+    const runtime::Method* init = class_def.GetMethod(INIT_METHOD);
+    init_ = init && init->formal_params.size() == args_list.size() ? init : nullptr;
+    init_version_ = class_def.GetVersion();
 }
 
 ObjectHolder NewInstance::Execute(Closure& closure, Context& context) {
     auto obj = ObjectHolder::Own(runtime::ClassInstance(class_def));
-    
-    if (obj.TryAs<runtime::ClassInstance>()->HasMethod(INIT_METHOD, args_list.size())) {
+
+    // класс может получить новое определение после разбора (см. IncrementalProgram)
+    if (class_def.GetVersion() != init_version_) {
+        ResolveInit();
+    }
+    if (init_) {
         std::vector<ObjectHolder> actual_args;
         for (auto &item:args_list) {
             actual_args.push_back(item->Execute(closure, context));
         }
-        obj.TryAs<runtime::ClassInstance>()->Call(INIT_METHOD, actual_args, context);
+        obj.TryAs<runtime::ClassInstance>()->Call(*init_, actual_args, context);
     }
     return obj;
 }
@@ -309,10 +583,14 @@ MethodBody::MethodBody(std::unique_ptr<Statement>&& body) {
     body_ = std::forward<std::unique_ptr<Statement>>(body);
 }
 
+MethodBody::MethodBody(std::unique_ptr<Statement> body, std::unique_ptr<Statement> result)
+    : body_(std::move(body)), result_(std::move(result)) {
+}
+
 ObjectHolder MethodBody::Execute(Closure& closure, Context& context) {
     try {
         body_->Execute(closure, context);
-        return ObjectHolder::None();
+        return result_ ? result_->Execute(closure, context) : ObjectHolder::None();
     }  catch (runtime::ObjectHolder &result) {
         return result;
     }  catch (...) {
@@ -320,4 +598,91 @@ ObjectHolder MethodBody::Execute(Closure& closure, Context& context) {
     }
 }
 
+LazyMethodBody::LazyMethodBody(BodyParser parser)
+    : parser_(std::move(parser)) {
+}
+
+ObjectHolder LazyMethodBody::Execute(Closure& closure, Context& context) {
+    return GetBody().Execute(closure, context);
+}
+
+Statement& LazyMethodBody::GetBody() {
+    if (!body_) {
+        // узлы тела размещаются рядом с самим узлом
+        body_ = parser_(Arena::Of(this));
+        parser_ = nullptr;
+    }
+    return *body_;
+}
+
+bool LazyMethodBody::IsParsed() const {
+    return body_ != nullptr;
+}
+
+FieldIncrement::FieldIncrement(std::unique_ptr<FieldAssignment> assignment)
+    : assignment_(std::move(assignment))
+    , increment_(dynamic_cast<Add&>(assignment_->GetValue()).GetRhs()) {
+}
+
+ObjectHolder FieldIncrement::Execute(Closure& closure, Context& context) {
+    auto object = assignment_->GetObject().Execute(closure, context);
+    auto instance = object.TryAsExact<runtime::ClassInstance>();
+    if (!instance) {
+        return assignment_->Execute(closure, context);
+    }
+    auto& fields = instance->Fields();
+    const runtime::Symbol name = assignment_->GetFieldName();
+    auto field = fields.find(name);
+    if (field == fields.end()) {
+        return assignment_->Execute(closure, context);
+    }
+    // increment_ - константа или переменная, её вычисление не меняет поля объекта
+    auto increment = increment_.Execute(closure, context);
+    if (auto number = field->second.TryAsExact<runtime::Number>()) {
+        if (auto rhs_number = increment.TryAsExact<runtime::Number>()) {
+            field->second = ObjectHolder::Own(runtime::Number(number->GetValue()
+                                                              + rhs_number->GetValue()));
+            return field->second;
+        }
+    }
+    if (auto str = field->second.TryAsExact<runtime::String>()) {
+        if (auto rhs_string = increment.TryAsExact<runtime::String>()) {
+            field->second = ObjectHolder::Own(runtime::String(str->GetValue()
+                                                              + rhs_string->GetValue()));
+            return field->second;
+        }
+    }
+    // метод __add__ может изменить поля объекта, поэтому поле ищется заново
+    auto sum = Add::Apply(field->second, increment, context);
+    auto& value = fields[name];
+    value = std::move(sum);
+    return value;
+}
+
+IfFieldEquals::IfFieldEquals(std::unique_ptr<IfElse> if_else)
+    : if_else_(std::move(if_else))
+    , condition_(dynamic_cast<Comparison&>(if_else_->GetCondition()))
+    , field_(dynamic_cast<VariableValue&>(condition_.GetLhs()))
+    , equal_(dynamic_cast<OperatorComparison<ComparisonOp::EQUAL>*>(&condition_) != nullptr) {
+    constant_ = EvaluateConstant(condition_.GetRhs());
+}
+
+ObjectHolder IfFieldEquals::Execute(Closure& closure, Context& context) {
+    auto value = field_.Execute(closure, context);
+    if (auto number = value.TryAsExact<runtime::Number>()) {
+        if (auto constant = constant_.TryAsExact<runtime::Number>()) {
+            return if_else_->ExecuteBranch(
+                (number->GetValue() == constant->GetValue()) == equal_, closure, context);
+        }
+    }
+    if (auto str = value.TryAsExact<runtime::String>()) {
+        if (auto constant = constant_.TryAsExact<runtime::String>()) {
+            return if_else_->ExecuteBranch(
+                (str->GetValue() == constant->GetValue()) == equal_, closure, context);
+        }
+    }
+    return if_else_->ExecuteBranch(condition_.Compare(value, constant_, context),
+                                   closure, context);
+}
+
 }  // namespace ast
@@ -1,15 +1,39 @@
 #pragma once
 
+#include "ast_inline.h"
+#include "builtins.h"
 #include "runtime.h"
 
 #include <functional>
 #include <iostream>
 #include <exception>
+#include <optional>
 
 namespace ast {
 
 using Statement = runtime::Executable;
 
+class Arena;
+
+/*
+Обратная связь по типам, которую узел собирает при выполнении. При первом выполнении узел
+запоминает типы операндов и далее выполняет быстрый путь для них, проверяя типы перед
+каждым выполнением. Если проверка не проходит, узел навсегда переходит в состояние GENERIC
+и выполняется общим путём. Узлы, собирающие обратную связь, не предназначены для одновременного
+выполнения в нескольких потоках. Метод DisableTypeFeedback сразу переводит узел в состояние
+GENERIC, после чего выполнение узла его не изменяет (см. ParseOptions::type_feedback)
+*/
+enum class TypeFeedback : uint8_t {
+    UNINITIALIZED,  // узел ещё не выполнялся
+    NUMBERS,        // операнды - числа
+    STRINGS,        // операнды - строки
+    INSTANCES,      // объекты - экземпляры пользовательских классов
+    GENERIC,        // типы операндов менялись, специализация не используется
+};
+
+// Возвращает обратную связь по типам операндов бинарной операции
+TypeFeedback ObserveOperands(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs);
+
 // Выражение, возвращающее значение типа T,
 // используется как основа для создания констант
 template <typename T>
@@ -24,6 +48,10 @@ public:
         return runtime::ObjectHolder::Share(value_);
     }
 
+    [[nodiscard]] const T& GetValue() const {
+        return value_;
+    }
+
 private:
     T value_;
 };
@@ -39,36 +67,68 @@ x = circle.center.x
 */
 class VariableValue : public Statement {
 public:
-    explicit VariableValue(const std::string& var_name);
-    explicit VariableValue(std::vector<std::string> dotted_ids);
+    explicit VariableValue(runtime::Symbol var_name);
+    explicit VariableValue(std::vector<runtime::Symbol> dotted_ids);
+    explicit VariableValue(const std::vector<std::string>& dotted_ids);
+
+    // Создаёт обращение к входной переменной, значение которой хранится в слоте slot
+    // контекста выполнения (см. runtime::Context::GetSlots)
+    static VariableValue Slot(size_t slot, std::vector<runtime::Symbol> dotted_ids);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает номер слота входной переменной либо пустое значение для обычной переменной
+    [[nodiscard]] std::optional<size_t> GetSlot() const;
+    // Возвращает имя переменной (первый идентификатор цепочки)
+    [[nodiscard]] const std::string& GetName() const;
+    [[nodiscard]] runtime::Symbol GetSymbol() const;
+    // Возвращает имена полей, следующих за именем переменной
+    [[nodiscard]] const std::vector<runtime::Symbol>& GetFieldIds() const;
+    // INSTANCES, если все объекты цепочки полей были экземплярами пользовательских классов
+    [[nodiscard]] TypeFeedback GetTypeFeedback() const;
+    void DisableTypeFeedback();
 private:
-    bool simpleVariable;
-    std::string name;
-    std::vector<std::string> list_ids;
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+    size_t slot_ = NO_SLOT;
+    runtime::Symbol name;
+    std::vector<runtime::Symbol> list_ids;
+    TypeFeedback feedback_ = TypeFeedback::UNINITIALIZED;
 };
 
 // Присваивает переменной, имя которой задано в параметре var, значение выражения rv
 class Assignment : public Statement {
 public:
-    Assignment(std::string var, std::unique_ptr<Statement> rv);
+    Assignment(runtime::Symbol var, std::unique_ptr<Statement> rv);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
 private:
-    std::string var_name;
+    runtime::Symbol var_name;
     std::unique_ptr<Statement> var_value;
 };
 
 // Присваивает полю object.field_name значение выражения rv
 class FieldAssignment : public Statement {
 public:
-    FieldAssignment(VariableValue object, std::string field_name, std::unique_ptr<Statement> rv);
+    FieldAssignment(VariableValue object, runtime::Symbol field_name,
+                    std::unique_ptr<Statement> rv);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    [[nodiscard]] VariableValue& GetObject() {
+        return object_;
+    }
+
+    [[nodiscard]] runtime::Symbol GetFieldName() const {
+        return field_name_;
+    }
+
+    [[nodiscard]] Statement& GetValue() const {
+        return *rv_;
+    }
 private:
     VariableValue object_;
-    std::string field_name_;
+    runtime::Symbol field_name_;
     std::unique_ptr<Statement> rv_;
 };
 
@@ -81,6 +141,13 @@ public:
     }
 };
 
+// Возвращает true, если node - константа: число, строка, логическое значение или None
+bool IsConstant(const Statement& node);
+
+// Вычисляет значение константы node. Константа не зависит от переменных и контекста
+// выполнения, поэтому её значение можно вычислить заранее, при построении дерева
+runtime::ObjectHolder EvaluateConstant(Statement& node);
+
 // Команда print
 class Print : public Statement {
 public:
@@ -99,16 +166,69 @@ private:
     std::vector<std::unique_ptr<Statement>> args_list;
 };
 
-// Вызывает метод object.method со списком параметров args
+// Вызывает метод object.method со списком параметров args.
+// object может быть экземпляром пользовательского класса, массивом runtime::IntArray
+// либо объектом приложения runtime::HostObject
 class MethodCall : public Statement {
 public:
-    MethodCall(std::unique_ptr<Statement> object, std::string method,
-               std::vector<std::unique_ptr<Statement>> args);
-
+    // Небольшие методы встраиваются в вызов в пределах limits (см. ast::InlinedCall)
+    MethodCall(std::unique_ptr<Statement> object, runtime::Symbol method,
+               std::vector<std::unique_ptr<Statement>> args, InlineLimits limits = {});
+    ~MethodCall() override;
+
+    // Вызов запоминает класс объекта и найденный метод. Пока объект - экземпляр того же
+    // класса и определение класса не менялось, метод вызывается без поиска по имени,
+    // а небольшой метод выполняется встроенным
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    /*
+    Связывает вызов с методом класса cls, если при разборе известно, что объект - экземпляр
+    этого класса. Связанный метод запоминается так же, как после первого вызова, поэтому
+    при выполнении класс объекта и определение класса по-прежнему проверяются.
+    Возвращает false, если у класса нет метода с таким количеством параметров
+    */
+    bool Bind(const runtime::Class& cls);
+
+    // INSTANCES, если все вызовы выполнялись для объектов одного класса
+    [[nodiscard]] TypeFeedback GetTypeFeedback() const;
+    // Вызов больше не запоминает класс и метод, метод ищется по имени при каждом вызове
+    void DisableTypeFeedback();
+    // Возвращает встроенный вызов запомненного метода или nullptr
+    [[nodiscard]] const InlinedCall* GetInlinedCall() const;
+
+    [[nodiscard]] Statement& GetObject() const {
+        return *object_;
+    }
+
+    [[nodiscard]] runtime::Symbol GetMethod() const {
+        return method_;
+    }
+
+    [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetArgs() const {
+        return args_;
+    }
 private:
     std::unique_ptr<Statement> object_;
-    std::string method_;
+    runtime::Symbol method_;
+    std::vector<std::unique_ptr<Statement>> args_;
+    InlineLimits limits_;
+    TypeFeedback feedback_ = TypeFeedback::UNINITIALIZED;
+    const runtime::Class* cached_class_ = nullptr;
+    uint64_t cached_version_ = 0;
+    const runtime::Method* cached_method_ = nullptr;
+    // создаётся при первом выполнении запомненного метода
+    std::unique_ptr<InlinedCall> cached_call_;
+};
+
+// Вызывает встроенную функцию function со списком параметров args.
+// Количество параметров проверяется при разборе программы
+class BuiltinCall : public Statement {
+public:
+    BuiltinCall(runtime::BuiltinFunction function, std::vector<std::unique_ptr<Statement>> args);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+private:
+    runtime::BuiltinFunction function_;
     std::vector<std::unique_ptr<Statement>> args_;
 };
 
@@ -131,9 +251,19 @@ public:
     NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args);
     // Возвращает объект, содержащий значение типа ClassInstance
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    [[nodiscard]] const runtime::Class& GetClass() const {
+        return class_def;
+    }
 private:
+    // Находит конструктор с подходящим количеством параметров для текущего определения класса
+    void ResolveInit();
+
     const runtime::Class& class_def;
     std::vector<std::unique_ptr<Statement>> args_list;
+    // конструктор или nullptr и номер определения класса, для которого он найден
+    const runtime::Method* init_ = nullptr;
+    uint64_t init_version_ = 0;
 };
 
 // Базовый класс для унарных операций
@@ -142,6 +272,10 @@ public:
     explicit UnaryOperation(std::unique_ptr<Statement> argument) {
         argument_ = std::move(argument);
     }
+
+    [[nodiscard]] Statement& GetArgument() const {
+        return *argument_;
+    }
 protected:
     std::unique_ptr<Statement> argument_;
 };
@@ -160,6 +294,23 @@ public:
         lhs_ = std::move(lhs);
         rhs_ = std::move(rhs);
     }
+
+    [[nodiscard]] Statement& GetLhs() const {
+        return *lhs_;
+    }
+
+    [[nodiscard]] Statement& GetRhs() const {
+        return *rhs_;
+    }
+
+    // Забирают аргументы у операции, например при замене её другим узлом
+    std::unique_ptr<Statement> ReleaseLhs() {
+        return std::move(lhs_);
+    }
+
+    std::unique_ptr<Statement> ReleaseRhs() {
+        return std::move(rhs_);
+    }
 protected:
     std::unique_ptr<Statement> lhs_, rhs_;
 };
@@ -175,6 +326,21 @@ public:
     //  объект1 + объект2, если у объект1 - пользовательский класс с методом _add__(rhs)
     // В противном случае при вычислении выбрасывается runtime_error
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    [[nodiscard]] TypeFeedback GetTypeFeedback() const {
+        return feedback_;
+    }
+
+    void DisableTypeFeedback() {
+        feedback_ = TypeFeedback::GENERIC;
+    }
+
+    // Складывает значения lhs и rhs по тем же правилам без учёта обратной связи по типам
+    static runtime::ObjectHolder Apply(const runtime::ObjectHolder& lhs,
+                                       const runtime::ObjectHolder& rhs,
+                                       runtime::Context& context);
+private:
+    TypeFeedback feedback_ = TypeFeedback::UNINITIALIZED;
 };
 
 // Возвращает результат вычитания аргументов lhs и rhs
@@ -186,6 +352,16 @@ public:
     //  число - число
     // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    [[nodiscard]] TypeFeedback GetTypeFeedback() const {
+        return feedback_;
+    }
+
+    void DisableTypeFeedback() {
+        feedback_ = TypeFeedback::GENERIC;
+    }
+private:
+    TypeFeedback feedback_ = TypeFeedback::UNINITIALIZED;
 };
 
 // Возвращает результат умножения аргументов lhs и rhs
@@ -236,6 +412,15 @@ public:
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
 };
 
+// Возвращает число, противоположное значению аргумента (унарный минус)
+class Negate : public UnaryOperation {
+public:
+    using UnaryOperation::UnaryOperation;
+
+    // Если значение аргумента - не число, выбрасывается исключение runtime_error
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+};
+
 // Составная инструкция (например: тело метода, содержимое ветки if, либо else)
 class Compound : public Statement {
 public:
@@ -258,6 +443,17 @@ public:
     
     // Последовательно выполняет добавленные инструкции. Возвращает None
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetStatements() const {
+        return args_list;
+    }
+
+    // Забирает последнюю инструкцию. Составная инструкция не должна быть пустой
+    std::unique_ptr<Statement> ReleaseLastStatement() {
+        auto last = std::move(args_list.back());
+        args_list.pop_back();
+        return last;
+    }
 private:
     std::vector<std::unique_ptr<Statement>> args_list;
 };
@@ -266,12 +462,49 @@ private:
 class MethodBody : public Statement {
 public:
     explicit MethodBody(std::unique_ptr<Statement>&& body);
+    // Тело, завершающееся инструкцией return result. Значение result вычисляется после body
+    // и возвращается без исключения, которым выходит из метода инструкция Return
+    MethodBody(std::unique_ptr<Statement> body, std::unique_ptr<Statement> result);
 
     // Вычисляет инструкцию, переданную в качестве body.
     // Если внутри body была выполнена инструкция return, возвращает результат return
     // В противном случае возвращает None
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    [[nodiscard]] Statement& GetBody() const {
+        return *body_;
+    }
+
+    // Возвращает выражение завершающей инструкции return или nullptr
+    [[nodiscard]] Statement* GetResult() const {
+        return result_.get();
+    }
+
+    std::unique_ptr<Statement> ReleaseBody() {
+        return std::move(body_);
+    }
+private:
+    std::unique_ptr<Statement> body_;
+    std::unique_ptr<Statement> result_;
+};
+
+// Тело метода, которое разбирается при первом вызове метода (см. ParseOptions::lazy_methods)
+class LazyMethodBody : public Statement {
+public:
+    // Разбирает тело метода, размещая узлы в арене arena (см. ast::ArenaScope)
+    using BodyParser = std::function<std::unique_ptr<Statement>(const Arena* arena)>;
+
+    explicit LazyMethodBody(BodyParser parser);
+
+    // Разбирает тело метода, если оно ещё не разобрано, и выполняет его.
+    // Ошибки разбора выбрасываются при каждом выполнении, пока тело не разобрано
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает тело метода, разбирая его при необходимости
+    Statement& GetBody();
+    [[nodiscard]] bool IsParsed() const;
 private:
+    BodyParser parser_;
     std::unique_ptr<Statement> body_;
 };
 
@@ -284,6 +517,14 @@ public:
     // Останавливает выполнение текущего метода. После выполнения инструкции return метод,
     // внутри которого она была исполнена, должен вернуть результат вычисления выражения statement.
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    [[nodiscard]] Statement& GetExpression() const {
+        return *statement_;
+    }
+
+    std::unique_ptr<Statement> ReleaseExpression() {
+        return std::move(statement_);
+    }
 private:
     std::unique_ptr<Statement> statement_;
 };
@@ -309,12 +550,23 @@ public:
            std::unique_ptr<Statement> else_body);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    [[nodiscard]] Statement& GetCondition() const {
+        return *condition_;
+    }
+
+    // Выполняет ветвь if_body, если condition истинно, иначе ветвь else_body
+    runtime::ObjectHolder ExecuteBranch(bool condition, runtime::Closure& closure,
+                                        runtime::Context& context);
 private:
     std::unique_ptr<Statement> condition_;
     std::unique_ptr<Statement> if_body_;
     std::unique_ptr<Statement> else_body_;
 };
 
+// Операции сравнения языка Mython
+enum class ComparisonOp { EQUAL, NOT_EQUAL, LESS, GREATER, LESS_OR_EQUAL, GREATER_OR_EQUAL };
+
 // Операция сравнения
 class Comparison : public BinaryOperation {
 public:
@@ -327,8 +579,186 @@ public:
     // Вычисляет значение выражений lhs и rhs и возвращает результат работы comparator,
     // приведённый к типу runtime::Bool
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Сравнивает значения lhs и rhs так же, как Execute сравнивает значения аргументов
+    [[nodiscard]] virtual bool Compare(const runtime::ObjectHolder& lhs,
+                                       const runtime::ObjectHolder& rhs,
+                                       runtime::Context& context) const;
+
+    // Операция языка, если сравнение задано ею (см. OperatorComparison), иначе пустое значение
+    [[nodiscard]] virtual std::optional<ComparisonOp> GetOperator() const;
+
+    // Сравнение, заданное функцией comparator, не собирает обратную связь по типам
+    virtual void DisableTypeFeedback() {
+    }
+
+protected:
+    // Сравнение, которое выполняет производный класс без функции comparator
+    Comparison(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs);
+
 private:
     Comparator cmp_;
 };
 
+// Функция сравнения значений и операция над числами и строками для операции сравнения
+template <ComparisonOp op>
+struct ComparisonTraits;
+
+template <>
+struct ComparisonTraits<ComparisonOp::EQUAL> {
+    static constexpr auto FUNCTION = &runtime::Equal;
+    using Compare = std::equal_to<>;
+};
+
+template <>
+struct ComparisonTraits<ComparisonOp::NOT_EQUAL> {
+    static constexpr auto FUNCTION = &runtime::NotEqual;
+    using Compare = std::not_equal_to<>;
+};
+
+template <>
+struct ComparisonTraits<ComparisonOp::LESS> {
+    static constexpr auto FUNCTION = &runtime::Less;
+    using Compare = std::less<>;
+};
+
+template <>
+struct ComparisonTraits<ComparisonOp::GREATER> {
+    static constexpr auto FUNCTION = &runtime::Greater;
+    using Compare = std::greater<>;
+};
+
+template <>
+struct ComparisonTraits<ComparisonOp::LESS_OR_EQUAL> {
+    static constexpr auto FUNCTION = &runtime::LessOrEqual;
+    using Compare = std::less_equal<>;
+};
+
+template <>
+struct ComparisonTraits<ComparisonOp::GREATER_OR_EQUAL> {
+    static constexpr auto FUNCTION = &runtime::GreaterOrEqual;
+    using Compare = std::greater_equal<>;
+};
+
+// Сравнение операцией языка op. Два числа или две строки сравниваются непосредственно,
+// остальные значения - функцией сравнения операции (runtime::Equal, runtime::Less и т.д.).
+// Результат - общий объект True или False (см. runtime::MakeBool)
+template <ComparisonOp op>
+class OperatorComparison final : public Comparison {
+public:
+    using Traits = ComparisonTraits<op>;
+
+    OperatorComparison(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs)
+        : Comparison(std::move(lhs), std::move(rhs)) {
+    }
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override {
+        const auto lhs_value = lhs_->Execute(closure, context);
+        const auto rhs_value = rhs_->Execute(closure, context);
+        typename Traits::Compare compare;
+        switch (feedback_) {
+            case TypeFeedback::NUMBERS:
+                if (const auto* lhs_number = lhs_value.TryAsExact<runtime::Number>()) {
+                    if (const auto* rhs_number = rhs_value.TryAsExact<runtime::Number>()) {
+                        return runtime::MakeBool(
+                            compare(lhs_number->GetValue(), rhs_number->GetValue()));
+                    }
+                }
+                break;
+            case TypeFeedback::STRINGS:
+                if (const auto* lhs_string = lhs_value.TryAsExact<runtime::String>()) {
+                    if (const auto* rhs_string = rhs_value.TryAsExact<runtime::String>()) {
+                        return runtime::MakeBool(
+                            compare(lhs_string->GetValue(), rhs_string->GetValue()));
+                    }
+                }
+                break;
+            case TypeFeedback::UNINITIALIZED:
+                feedback_ = ObserveOperands(lhs_value, rhs_value);
+                [[fallthrough]];
+            default:
+                return runtime::MakeBool(CompareValues(lhs_value, rhs_value, context));
+        }
+        feedback_ = TypeFeedback::GENERIC;
+        return runtime::MakeBool(CompareValues(lhs_value, rhs_value, context));
+    }
+
+    [[nodiscard]] bool Compare(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+                               runtime::Context& context) const override {
+        return CompareValues(lhs, rhs, context);
+    }
+
+    [[nodiscard]] std::optional<ComparisonOp> GetOperator() const override {
+        return op;
+    }
+
+    [[nodiscard]] TypeFeedback GetTypeFeedback() const {
+        return feedback_;
+    }
+
+    void DisableTypeFeedback() override {
+        feedback_ = TypeFeedback::GENERIC;
+    }
+
+private:
+    static bool CompareValues(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+                        runtime::Context& context) {
+        typename Traits::Compare compare;
+        if (const auto* lhs_number = lhs.TryAs<runtime::Number>()) {
+            if (const auto* rhs_number = rhs.TryAs<runtime::Number>()) {
+                return compare(lhs_number->GetValue(), rhs_number->GetValue());
+            }
+        } else if (const auto* lhs_string = lhs.TryAs<runtime::String>()) {
+            if (const auto* rhs_string = rhs.TryAs<runtime::String>()) {
+                return compare(lhs_string->GetValue(), rhs_string->GetValue());
+            }
+        }
+        return Traits::FUNCTION(lhs, rhs, context);
+    }
+
+    TypeFeedback feedback_ = TypeFeedback::UNINITIALIZED;
+};
+
+// Создаёт узел сравнения, специализированный для операции op
+std::unique_ptr<Comparison> MakeComparison(ComparisonOp op, std::unique_ptr<Statement> lhs,
+                                           std::unique_ptr<Statement> rhs);
+
+/*
+Объединённая инструкция object.field = object.field + increment, где increment - константа
+или переменная (см. ast::FuseStatement). Поле читается и записывается за один поиск,
+числа и строки складываются без промежуточных объектов.
+Если object - не экземпляр пользовательского класса или поля нет, выполняется исходная
+инструкция assignment
+*/
+class FieldIncrement : public Statement {
+public:
+    explicit FieldIncrement(std::unique_ptr<FieldAssignment> assignment);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+private:
+    std::unique_ptr<FieldAssignment> assignment_;
+    // правый операнд сложения внутри assignment_
+    Statement& increment_;
+};
+
+/*
+Объединённая инструкция if object.field == constant (или !=) (см. ast::FuseStatement).
+Числа и строки сравниваются с константой без создания результата сравнения,
+значения других типов - функцией сравнения исходного условия
+*/
+class IfFieldEquals : public Statement {
+public:
+    // Условие if_else - сравнение ==/!= поля объекта с константой
+    explicit IfFieldEquals(std::unique_ptr<IfElse> if_else);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+private:
+    std::unique_ptr<IfElse> if_else_;
+    Comparison& condition_;
+    VariableValue& field_;
+    runtime::ObjectHolder constant_;
+    // true для ==, false для !=
+    bool equal_;
+};
+
 }  // namespace ast
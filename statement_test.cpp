@@ -8,6 +8,7 @@ namespace ast {
 
 using runtime::Closure;
 using runtime::ObjectHolder;
+using runtime::Symbol;
 
 namespace {
 
@@ -72,10 +73,11 @@ void TestVariable() {
     runtime::Number num(42);
     runtime::String word("Hello"s);
 
-    Closure closure = {{"x"s, ObjectHolder::Share(num)}, {"w"s, ObjectHolder::Share(word)}};
-    ASSERT(VariableValue("x"s).Execute(closure, context).Get() == &num);
-    ASSERT(VariableValue("w"s).Execute(closure, context).Get() == &word);
-    ASSERT_THROWS(VariableValue("unknown"s).Execute(closure, context), std::runtime_error);
+    Closure closure = {{Symbol("x"s), ObjectHolder::Share(num)},
+                       {Symbol("w"s), ObjectHolder::Share(word)}};
+    ASSERT(VariableValue(Symbol("x"s)).Execute(closure, context).Get() == &num);
+    ASSERT(VariableValue(Symbol("w"s)).Execute(closure, context).Get() == &word);
+    ASSERT_THROWS(VariableValue(Symbol("unknown"s)).Execute(closure, context), std::runtime_error);
 
     ASSERT(context.output.str().empty());
 }
@@ -83,26 +85,26 @@ void TestVariable() {
 void TestAssignment() {
     runtime::DummyContext context;
 
-    Assignment assign_x("x"s, make_unique<NumericConst>(runtime::Number(57)));
-    Assignment assign_y("y"s, make_unique<StringConst>(runtime::String("Hello"s)));
+    Assignment assign_x(Symbol("x"s), make_unique<NumericConst>(runtime::Number(57)));
+    Assignment assign_y(Symbol("y"s), make_unique<StringConst>(runtime::String("Hello"s)));
 
-    Closure closure = {{"y"s, ObjectHolder::Own(runtime::Number(42))}};
+    Closure closure = {{Symbol("y"s), ObjectHolder::Own(runtime::Number(42))}};
 
     {
         ObjectHolder o = assign_x.Execute(closure, context);
         ASSERT(o);
         ASSERT_OBJECT_VALUE_EQUAL(o, 57);
     }
-    ASSERT(closure.find("x"s) != closure.end());
-    ASSERT_OBJECT_VALUE_EQUAL(closure.at("x"s), 57);
+    ASSERT(closure.find(Symbol("x"s)) != closure.end());
+    ASSERT_OBJECT_VALUE_EQUAL(closure.at(Symbol("x"s)), 57);
 
     {
         ObjectHolder o = assign_y.Execute(closure, context);
         ASSERT(o);
         ASSERT_OBJECT_VALUE_EQUAL(o, "Hello"s);
     }
-    ASSERT(closure.find("y"s) != closure.end());
-    ASSERT_OBJECT_VALUE_EQUAL(closure.at("y"s), "Hello"s);
+    ASSERT(closure.find(Symbol("y"s)) != closure.end());
+    ASSERT_OBJECT_VALUE_EQUAL(closure.at(Symbol("y"s)), "Hello"s);
 
     ASSERT(context.output.str().empty());
 }
@@ -113,23 +115,24 @@ void TestFieldAssignment() {
     runtime::Class empty("Empty"s, {}, nullptr);
     runtime::ClassInstance object{empty};
 
-    FieldAssignment assign_x(VariableValue{"self"s}, "x"s,
+    FieldAssignment assign_x(VariableValue{Symbol("self"s)}, Symbol("x"s),
                              make_unique<NumericConst>(runtime::Number(57)));
-    FieldAssignment assign_y(VariableValue{"self"s}, "y"s, make_unique<NewInstance>(empty));
+    FieldAssignment assign_y(VariableValue{Symbol("self"s)}, Symbol("y"s),
+                             make_unique<NewInstance>(empty));
 
-    Closure closure = {{"self"s, ObjectHolder::Share(object)}};
+    Closure closure = {{Symbol("self"s), ObjectHolder::Share(object)}};
 
     {
         ObjectHolder o = assign_x.Execute(closure, context);
         ASSERT(o);
         ASSERT_OBJECT_VALUE_EQUAL(o, 57);
     }
-    ASSERT(object.Fields().find("x"s) != object.Fields().end());
-    ASSERT_OBJECT_VALUE_EQUAL(object.Fields().at("x"s), 57);
+    ASSERT(object.Fields().find(Symbol("x"s)) != object.Fields().end());
+    ASSERT_OBJECT_VALUE_EQUAL(object.Fields().at(Symbol("x"s)), 57);
 
     assign_y.Execute(closure, context);
     FieldAssignment assign_yz(
-        VariableValue{vector<string>{"self"s, "y"s}}, "z"s,
+        VariableValue{vector<string>{"self"s, "y"s}}, Symbol("z"s),
         make_unique<StringConst>(runtime::String("Hello, world! Hooray! Yes-yes!!!"s)));
     {
         ObjectHolder o = assign_yz.Execute(closure, context);
@@ -137,10 +140,12 @@ void TestFieldAssignment() {
         ASSERT_OBJECT_VALUE_EQUAL(o, "Hello, world! Hooray! Yes-yes!!!"s);
     }
 
-    ASSERT(object.Fields().find("y"s) != object.Fields().end());
-    const auto* subobject = object.Fields().at("y"s).TryAs<runtime::ClassInstance>();
-    ASSERT(subobject != nullptr && subobject->Fields().find("z"s) != subobject->Fields().end());
-    ASSERT_OBJECT_VALUE_EQUAL(subobject->Fields().at("z"s), "Hello, world! Hooray! Yes-yes!!!"s);
+    ASSERT(object.Fields().find(Symbol("y"s)) != object.Fields().end());
+    const auto* subobject = object.Fields().at(Symbol("y"s)).TryAs<runtime::ClassInstance>();
+    ASSERT(subobject != nullptr
+           && subobject->Fields().find(Symbol("z"s)) != subobject->Fields().end());
+    ASSERT_OBJECT_VALUE_EQUAL(subobject->Fields().at(Symbol("z"s)),
+                              "Hello, world! Hooray! Yes-yes!!!"s);
 
     ASSERT(context.output.str().empty());
 }
@@ -148,7 +153,7 @@ void TestFieldAssignment() {
 void TestPrintVariable() {
     runtime::DummyContext context;
 
-    Closure closure = {{"y"s, ObjectHolder::Own(runtime::Number(42))}};
+    Closure closure = {{Symbol("y"s), ObjectHolder::Own(runtime::Number(42))}};
 
     auto print_statement = Print::Variable("y"s);
     print_statement->Execute(closure, context);
@@ -160,13 +165,14 @@ void TestPrintMultipleStatements() {
     runtime::DummyContext context;
 
     runtime::String hello("hello"s);
-    Closure closure = {{"word"s, ObjectHolder::Share(hello)}, {"empty"s, ObjectHolder::None()}};
+    Closure closure = {{Symbol("word"s), ObjectHolder::Share(hello)},
+                       {Symbol("empty"s), ObjectHolder::None()}};
 
     vector<unique_ptr<Statement>> args;
-    args.push_back(make_unique<VariableValue>("word"s));
+    args.push_back(make_unique<VariableValue>(Symbol("word"s)));
     args.push_back(make_unique<NumericConst>(57));
     args.push_back(make_unique<StringConst>("Python"s));
-    args.push_back(make_unique<VariableValue>("empty"s));
+    args.push_back(make_unique<VariableValue>(Symbol("empty"s)));
 
     Print(std::move(args)).Execute(closure, context);
 
@@ -190,7 +196,7 @@ void TestStringify() {
     }
     {
         vector<runtime::Method> methods;
-        methods.push_back({"__str__"s, {}, make_unique<NumericConst>(842)});
+        methods.push_back({Symbol("__str__"s), {}, make_unique<NumericConst>(842)});
 
         runtime::Class cls("BoxedValue"s, std::move(methods), nullptr);
 
@@ -200,12 +206,12 @@ void TestStringify() {
     }
     {
         runtime::Class cls("BoxedValue"s, {}, nullptr);
-        runtime::Closure closure{{"x"s, ObjectHolder::Own(runtime::ClassInstance{cls})}};
+        runtime::Closure closure{{Symbol("x"s), ObjectHolder::Own(runtime::ClassInstance{cls})}};
 
         std::ostringstream expected_output;
-        expected_output << closure.at("x"s).Get();
+        expected_output << closure.at(Symbol("x"s)).Get();
 
-        Stringify str(make_unique<VariableValue>("x"s));
+        Stringify str(make_unique<VariableValue>(Symbol("x"s)));
         ASSERT_OBJECT_VALUE_EQUAL(str.Execute(closure, context), expected_output.str());
     }
     {
@@ -261,10 +267,10 @@ void TestSuccessfulClassInstanceAdd() {
     runtime::DummyContext context;
 
     vector<runtime::Method> methods;
-    methods.push_back({"__add__"s,
-                       {"value_"s},
+    methods.push_back({Symbol("__add__"s),
+                       {Symbol("value_"s)},
                        make_unique<Add>(make_unique<StringConst>("hello, "s),
-                                        make_unique<VariableValue>("value_"s))});
+                                        make_unique<VariableValue>(Symbol("value_"s)))});
 
     runtime::Class cls("BoxedValue"s, std::move(methods), nullptr);
 
@@ -292,17 +298,17 @@ void TestCompound() {
     runtime::DummyContext context;
 
     Compound cpd{
-        make_unique<Assignment>("x"s, make_unique<StringConst>("one"s)),
-        make_unique<Assignment>("y"s, make_unique<NumericConst>(2)),
-        make_unique<Assignment>("z"s, make_unique<VariableValue>("x"s)),
+        make_unique<Assignment>(Symbol("x"s), make_unique<StringConst>("one"s)),
+        make_unique<Assignment>(Symbol("y"s), make_unique<NumericConst>(2)),
+        make_unique<Assignment>(Symbol("z"s), make_unique<VariableValue>(Symbol("x"s))),
     };
 
     Closure closure;
     auto result = cpd.Execute(closure, context);
 
-    ASSERT_OBJECT_VALUE_EQUAL(closure.at("x"s), "one"s);
-    ASSERT_OBJECT_VALUE_EQUAL(closure.at("y"s), 2);
-    ASSERT_OBJECT_VALUE_EQUAL(closure.at("z"s), "one"s);
+    ASSERT_OBJECT_VALUE_EQUAL(closure.at(Symbol("x"s)), "one"s);
+    ASSERT_OBJECT_VALUE_EQUAL(closure.at(Symbol("y"s)), 2);
+    ASSERT_OBJECT_VALUE_EQUAL(closure.at(Symbol("z"s)), "one"s);
 
     ASSERT(!result);
 
@@ -314,32 +320,33 @@ void TestFields() {
 
     vector<runtime::Method> methods;
 
-    methods.push_back({"__init__"s,
+    methods.push_back({Symbol("__init__"s),
                        {},
-                       {make_unique<FieldAssignment>(VariableValue{"self"s}, "value"s,
+                       {make_unique<FieldAssignment>(VariableValue{Symbol("self"s)},
+                                                     Symbol("value"s),
                                                      make_unique<NumericConst>(0))}});
     methods.push_back(
-        {"value"s, {}, {make_unique<VariableValue>(vector<string>{"self"s, "value"s})}});
+        {Symbol("value"s), {}, {make_unique<VariableValue>(vector<string>{"self"s, "value"s})}});
     methods.push_back(
-        {"add"s,
-         {"x"s},
+        {Symbol("add"s),
+         {Symbol("x"s)},
          {make_unique<FieldAssignment>(
-             VariableValue{"self"s}, "value"s,
+             VariableValue{Symbol("self"s)}, Symbol("value"s),
              make_unique<Add>(make_unique<VariableValue>(vector<string>{"self"s, "value"s}),
-                              make_unique<VariableValue>("x"s)))}});
+                              make_unique<VariableValue>(Symbol("x"s))))}});
 
     runtime::Class cls("BoxedValue"s, std::move(methods), nullptr);
     runtime::ClassInstance inst(cls);
 
-    inst.Call("__init__"s, {}, context);
+    inst.Call(Symbol("__init__"s), {}, context);
 
     for (int i = 1, expected = 0; i < 10; expected += i, ++i) {
-        auto fv = inst.Call("value"s, {}, context);
+        auto fv = inst.Call(Symbol("value"s), {}, context);
         auto* obj = fv.TryAs<runtime::Number>();
         ASSERT(obj);
         ASSERT_EQUAL(obj->GetValue(), expected);
 
-        inst.Call("add"s, {ObjectHolder::Own(runtime::Number(i))}, context);
+        inst.Call(Symbol("add"s), {ObjectHolder::Own(runtime::Number(i))}, context);
     }
 
     ASSERT(context.output.str().empty());
@@ -347,65 +354,70 @@ void TestFields() {
 
 void TestBaseClass() {
     vector<runtime::Method> methods;
-    methods.push_back({"GetValue"s, {}, make_unique<VariableValue>(vector{"self"s, "value"s})});
-    methods.push_back({"SetValue"s,
-                       {"x"s},
-                       make_unique<FieldAssignment>(VariableValue{"self"s}, "value"s,
-                                                    make_unique<ast::VariableValue>("x"s))});
+    methods.push_back(
+        {Symbol("GetValue"s), {}, make_unique<VariableValue>(vector{"self"s, "value"s})});
+    methods.push_back({Symbol("SetValue"s),
+                       {Symbol("x"s)},
+                       make_unique<FieldAssignment>(VariableValue{Symbol("self"s)},
+                                                    Symbol("value"s),
+                                                    make_unique<ast::VariableValue>(Symbol("x"s)))});
 
     runtime::Class cls("BoxedValue"s, move(methods), nullptr);
 
     ASSERT_EQUAL(cls.GetName(), "BoxedValue"s);
     {
-        const auto* m = cls.GetMethod("GetValue"s);
+        const auto* m = cls.GetMethod(Symbol("GetValue"s));
         ASSERT(m != nullptr);
-        ASSERT_EQUAL(m->name, "GetValue"s);
+        ASSERT_EQUAL(m->name.GetName(), "GetValue"s);
         ASSERT(m->formal_params.empty());
     }
     {
-        const auto* m = cls.GetMethod("SetValue"s);
+        const auto* m = cls.GetMethod(Symbol("SetValue"s));
         ASSERT(m != nullptr);
-        ASSERT_EQUAL(m->name, "SetValue"s);
+        ASSERT_EQUAL(m->name.GetName(), "SetValue"s);
         ASSERT_EQUAL(m->formal_params.size(), 1U);
     }
-    ASSERT(!cls.GetMethod("AsString"s));
+    ASSERT(!cls.GetMethod(Symbol("AsString"s)));
 }
 
 void TestInheritance() {
     vector<runtime::Method> methods;
-    methods.push_back({"GetValue"s, {}, make_unique<VariableValue>(vector{"self"s, "value"s})});
-    methods.push_back({"SetValue"s,
-                       {"x"s},
-                       make_unique<FieldAssignment>(VariableValue{"self"s}, "value"s,
-                                                    make_unique<VariableValue>("x"s))});
+    methods.push_back(
+        {Symbol("GetValue"s), {}, make_unique<VariableValue>(vector{"self"s, "value"s})});
+    methods.push_back({Symbol("SetValue"s),
+                       {Symbol("x"s)},
+                       make_unique<FieldAssignment>(VariableValue{Symbol("self"s)},
+                                                    Symbol("value"s),
+                                                    make_unique<VariableValue>(Symbol("x"s)))});
 
     runtime::Class base("BoxedValue"s, std::move(methods), nullptr);
 
     methods.clear();
-    methods.push_back({"GetValue"s, {"z"s}, make_unique<VariableValue>("z"s)});
-    methods.push_back({"AsString"s, {}, make_unique<StringConst>("value"s)});
+    methods.push_back(
+        {Symbol("GetValue"s), {Symbol("z"s)}, make_unique<VariableValue>(Symbol("z"s))});
+    methods.push_back({Symbol("AsString"s), {}, make_unique<StringConst>("value"s)});
     runtime::Class cls("StringableValue"s, std::move(methods), &base);
 
     ASSERT_EQUAL(cls.GetName(), "StringableValue"s);
     {
-        const auto* m = cls.GetMethod("GetValue"s);
+        const auto* m = cls.GetMethod(Symbol("GetValue"s));
         ASSERT(m != nullptr);
-        ASSERT_EQUAL(m->name, "GetValue"s);
+        ASSERT_EQUAL(m->name.GetName(), "GetValue"s);
         ASSERT_EQUAL(m->formal_params.size(), 1U);
     }
     {
-        const auto* m = cls.GetMethod("SetValue"s);
+        const auto* m = cls.GetMethod(Symbol("SetValue"s));
         ASSERT(m != nullptr);
-        ASSERT_EQUAL(m->name, "SetValue"s);
+        ASSERT_EQUAL(m->name.GetName(), "SetValue"s);
         ASSERT_EQUAL(m->formal_params.size(), 1U);
     }
     {
-        const auto* m = cls.GetMethod("AsString"s);
+        const auto* m = cls.GetMethod(Symbol("AsString"s));
         ASSERT(m != nullptr);
-        ASSERT_EQUAL(m->name, "AsString"s);
+        ASSERT_EQUAL(m->name.GetName(), "AsString"s);
         ASSERT(m->formal_params.empty());
     }
-    ASSERT(!cls.GetMethod("AsStringValue"s));
+    ASSERT(!cls.GetMethod(Symbol("AsStringValue"s)));
 }
 
 void TestOr() {
@@ -454,6 +466,143 @@ void TestNot() {
     test_not(false);
 }
 
+void TestOperatorComparisons() {
+    vector<ObjectHolder> values = {
+        ObjectHolder::Own(runtime::Number(1)),      ObjectHolder::Own(runtime::Number(2)),
+        ObjectHolder::Own(runtime::String("a"s)),   ObjectHolder::Own(runtime::String("ab"s)),
+        ObjectHolder::Own(runtime::Bool(false)),    ObjectHolder::Own(runtime::Bool(true)),
+        ObjectHolder::None(),
+    };
+    const pair<ComparisonOp, Comparison::Comparator> operations[] = {
+        {ComparisonOp::EQUAL, runtime::Equal},
+        {ComparisonOp::NOT_EQUAL, runtime::NotEqual},
+        {ComparisonOp::LESS, runtime::Less},
+        {ComparisonOp::GREATER, runtime::Greater},
+        {ComparisonOp::LESS_OR_EQUAL, runtime::LessOrEqual},
+        {ComparisonOp::GREATER_OR_EQUAL, runtime::GreaterOrEqual},
+    };
+
+    Closure closure;
+    runtime::DummyContext context;
+    for (const auto& [op, function] : operations) {
+        for (const auto& lhs : values) {
+            for (const auto& rhs : values) {
+                closure[Symbol("lhs"s)] = lhs;
+                closure[Symbol("rhs"s)] = rhs;
+                auto typed = MakeComparison(op, make_unique<VariableValue>(Symbol("lhs"s)),
+                                            make_unique<VariableValue>(Symbol("rhs"s)));
+                Comparison generic(function, make_unique<VariableValue>(Symbol("lhs"s)),
+                                   make_unique<VariableValue>(Symbol("rhs"s)));
+                // операция известна без разбора функции comparator
+                ASSERT(typed->GetOperator() == op);
+                ASSERT(!generic.GetOperator());
+
+                optional<bool> expected;
+                try {
+                    expected = function(lhs, rhs, context);
+                } catch (const runtime_error&) {
+                }
+                if (!expected) {
+                    ASSERT_THROWS(typed->Execute(closure, context), runtime_error);
+                    continue;
+                }
+                ASSERT_EQUAL(typed->Compare(lhs, rhs, context), *expected);
+                auto result = typed->Execute(closure, context);
+                ASSERT_EQUAL(result.TryAs<runtime::Bool>()->GetValue(), *expected);
+                // результаты - общие объекты True и False
+                ASSERT_EQUAL(result.Get(), generic.Execute(closure, context).Get());
+                ASSERT_EQUAL(result.Get(), runtime::MakeBool(*expected).Get());
+            }
+        }
+    }
+}
+
+// Создаёт класс с методом name без параметров, возвращающим число value
+runtime::Class MakeClassReturning(const string& class_name, const string& name, int value) {
+    vector<runtime::Method> methods;
+    methods.push_back({Symbol(name), {}, make_unique<NumericConst>(value)});
+    return runtime::Class(class_name, std::move(methods), nullptr);
+}
+
+void TestTypeFeedback() {
+    runtime::DummyContext context;
+    Closure closure;
+
+    Add add(make_unique<VariableValue>(Symbol("lhs"s)), make_unique<VariableValue>(Symbol("rhs"s)));
+    ASSERT(add.GetTypeFeedback() == TypeFeedback::UNINITIALIZED);
+    closure[Symbol("lhs"s)] = ObjectHolder::Own(runtime::Number(2));
+    closure[Symbol("rhs"s)] = ObjectHolder::Own(runtime::Number(3));
+    ASSERT_OBJECT_VALUE_EQUAL(add.Execute(closure, context), 5);
+    ASSERT_OBJECT_VALUE_EQUAL(add.Execute(closure, context), 5);
+    ASSERT(add.GetTypeFeedback() == TypeFeedback::NUMBERS);
+    // промах проверки типов отключает специализацию, результат не меняется
+    closure[Symbol("lhs"s)] = ObjectHolder::Own(runtime::String("a"s));
+    closure[Symbol("rhs"s)] = ObjectHolder::Own(runtime::String("b"s));
+    ASSERT_OBJECT_VALUE_EQUAL(add.Execute(closure, context), "ab"s);
+    ASSERT(add.GetTypeFeedback() == TypeFeedback::GENERIC);
+    closure[Symbol("lhs"s)] = ObjectHolder::Own(runtime::Number(1));
+    closure[Symbol("rhs"s)] = ObjectHolder::Own(runtime::Number(1));
+    ASSERT_OBJECT_VALUE_EQUAL(add.Execute(closure, context), 2);
+
+    Add concat(make_unique<StringConst>("x"s), make_unique<StringConst>("y"s));
+    ASSERT_OBJECT_VALUE_EQUAL(concat.Execute(closure, context), "xy"s);
+    ASSERT(concat.GetTypeFeedback() == TypeFeedback::STRINGS);
+
+    Sub sub(make_unique<VariableValue>(Symbol("lhs"s)), make_unique<VariableValue>(Symbol("rhs"s)));
+    ASSERT_OBJECT_VALUE_EQUAL(sub.Execute(closure, context), 0);
+    ASSERT(sub.GetTypeFeedback() == TypeFeedback::NUMBERS);
+    closure[Symbol("rhs"s)] = ObjectHolder::Own(runtime::String("b"s));
+    ASSERT_THROWS(sub.Execute(closure, context), runtime_error);
+    ASSERT(sub.GetTypeFeedback() == TypeFeedback::GENERIC);
+
+    auto less = MakeComparison(ComparisonOp::LESS, make_unique<VariableValue>(Symbol("lhs"s)),
+                               make_unique<VariableValue>(Symbol("rhs"s)));
+    auto& typed_less = dynamic_cast<OperatorComparison<ComparisonOp::LESS>&>(*less);
+    closure[Symbol("lhs"s)] = ObjectHolder::Own(runtime::String("a"s));
+    ASSERT(runtime::IsTrue(less->Execute(closure, context)));
+    ASSERT(typed_less.GetTypeFeedback() == TypeFeedback::STRINGS);
+    closure[Symbol("rhs"s)] = ObjectHolder::Own(runtime::Number(1));
+    ASSERT_THROWS(less->Execute(closure, context), runtime_error);
+    ASSERT(typed_less.GetTypeFeedback() == TypeFeedback::GENERIC);
+}
+
+void TestTypeFeedbackForObjects() {
+    runtime::DummyContext context;
+    Closure closure;
+
+    runtime::Class first = MakeClassReturning("First"s, "get"s, 1);
+    runtime::Class second = MakeClassReturning("Second"s, "get"s, 2);
+    auto object = ObjectHolder::Own(runtime::ClassInstance(first));
+    object.TryAs<runtime::ClassInstance>()->Fields()[Symbol("inner"s)] =
+        ObjectHolder::Own(runtime::ClassInstance(second));
+    closure[Symbol("x"s)] = object;
+
+    VariableValue field(vector<string>{"x"s, "inner"s});
+    ASSERT(field.Execute(closure, context).Get()
+           == object.TryAs<runtime::ClassInstance>()->Fields().at(Symbol("inner"s)).Get());
+    ASSERT(field.GetTypeFeedback() == TypeFeedback::INSTANCES);
+    closure[Symbol("x"s)] = ObjectHolder::Own(runtime::Number(1));
+    ASSERT_THROWS(field.Execute(closure, context), runtime_error);
+    ASSERT(field.GetTypeFeedback() == TypeFeedback::GENERIC);
+
+    closure[Symbol("x"s)] = object;
+    MethodCall call(make_unique<VariableValue>(Symbol("x"s)), Symbol("get"s), {});
+    ASSERT_OBJECT_VALUE_EQUAL(call.Execute(closure, context), 1);
+    ASSERT_OBJECT_VALUE_EQUAL(call.Execute(closure, context), 1);
+    ASSERT(call.GetTypeFeedback() == TypeFeedback::INSTANCES);
+    closure[Symbol("x"s)] = ObjectHolder::Own(runtime::ClassInstance(second));
+    ASSERT_OBJECT_VALUE_EQUAL(call.Execute(closure, context), 2);
+    ASSERT(call.GetTypeFeedback() == TypeFeedback::GENERIC);
+
+    // новое определение класса в прежнем объекте класса не вызывает старый метод
+    closure[Symbol("x"s)] = object;
+    MethodCall cached(make_unique<VariableValue>(Symbol("x"s)), Symbol("get"s), {});
+    ASSERT_OBJECT_VALUE_EQUAL(cached.Execute(closure, context), 1);
+    first = MakeClassReturning("First"s, "get"s, 10);
+    ASSERT_OBJECT_VALUE_EQUAL(cached.Execute(closure, context), 10);
+    ASSERT(cached.GetTypeFeedback() == TypeFeedback::GENERIC);
+}
+
 }  // namespace
 
 void RunUnitTests(TestRunner& tr) {
@@ -477,6 +626,9 @@ void RunUnitTests(TestRunner& tr) {
     RUN_TEST(tr, ast::TestOr);
     RUN_TEST(tr, ast::TestAnd);
     RUN_TEST(tr, ast::TestNot);
+    RUN_TEST(tr, ast::TestOperatorComparisons);
+    RUN_TEST(tr, ast::TestTypeFeedback);
+    RUN_TEST(tr, ast::TestTypeFeedbackForObjects);
 }
 
 }  // namespace ast
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "symbol.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace std;
+
+namespace runtime {
+
+namespace {
+
+SymbolTable& Table() {
+    // Таблица не разрушается: символы могут использоваться статическими объектами
+    // и другими потоками вплоть до завершения программы
+    static SymbolTable* table = new SymbolTable;
+    return *table;
+}
+
+}  // namespace
+
+SymbolTable::SymbolTable(size_t capacity)
+    : chunks_(new atomic<string*>[(capacity + CHUNK_SIZE - 1) / CHUNK_SIZE]())
+    , capacity_(capacity) {
+    Intern(""sv);
+}
+
+SymbolTable::~SymbolTable() {
+    for (size_t chunk = 0; chunk * CHUNK_SIZE < size_; ++chunk) {
+        delete[] chunks_[chunk].load(memory_order_relaxed);
+    }
+}
+
+uint32_t SymbolTable::Intern(std::string_view name) {
+    {
+        shared_lock lock(mutex_);
+        if (auto it = ids_.find(name); it != ids_.end()) {
+            return it->second;
+        }
+    }
+    unique_lock lock(mutex_);
+    if (auto it = ids_.find(name); it != ids_.end()) {
+        return it->second;
+    }
+    if (size_ == capacity_) {
+        throw runtime_error("Symbol table is full: too many distinct names"s);
+    }
+    const uint32_t id = size_;
+    const size_t chunk = id >> CHUNK_BITS;
+    string* names = chunks_[chunk].load(memory_order_relaxed);
+    if (names == nullptr) {
+        names = new string[CHUNK_SIZE];
+        chunks_[chunk].store(names, memory_order_release);
+    }
+    string& stored = names[id & (CHUNK_SIZE - 1)];
+    stored = name;
+    ids_.emplace(stored, id);
+    ++size_;
+    return id;
+}
+
+const string& SymbolTable::Name(uint32_t id) const {
+    return chunks_[id >> CHUNK_BITS].load(memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+}
+
+size_t SymbolTable::Size() const {
+    shared_lock lock(mutex_);
+    return size_;
+}
+
+size_t SymbolTable::Capacity() const {
+    return capacity_;
+}
+
+Symbol::Symbol(std::string_view name)
+    : id_(Table().Intern(name)) {
+}
+
+Symbol::Symbol(const std::string& name)
+    : Symbol(std::string_view(name)) {
+}
+
+Symbol::Symbol(const char* name)
+    : Symbol(std::string_view(name)) {
+}
+
+Symbol Symbol::FromId(uint32_t id) {
+    return Symbol(id);
+}
+
+const std::string& Symbol::GetName() const {
+    return Table().Name(id_);
+}
+
+std::ostream& operator<<(std::ostream& os, Symbol symbol) {
+    return os << symbol.GetName();
+}
+
+}  // namespace runtime
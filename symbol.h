@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace runtime {
+
+/*
+ * Таблица имён. Имена хранятся в блоках фиксированного размера, которые никогда не
+ * перемещаются, поэтому имя по номеру читается без блокировки. Поиск номера по имени
+ * выполняется под разделяемой блокировкой, добавление нового имени - под исключительной.
+ * Имена не удаляются, поэтому размер таблицы ограничен capacity
+ */
+class SymbolTable {
+public:
+    // Размер глобальной таблицы символов (см. Symbol)
+    static constexpr size_t DEFAULT_CAPACITY = size_t{1} << 24;
+
+    explicit SymbolTable(size_t capacity = DEFAULT_CAPACITY);
+    ~SymbolTable();
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // Возвращает номер имени name, добавляя его в таблицу при необходимости.
+    // Если в заполненной таблице нет name, выбрасывает runtime_error; таблица остаётся
+    // пригодной для поиска уже добавленных имён
+    uint32_t Intern(std::string_view name);
+
+    [[nodiscard]] const std::string& Name(uint32_t id) const;
+
+    // Количество имён в таблице, включая пустое
+    [[nodiscard]] size_t Size() const;
+    [[nodiscard]] size_t Capacity() const;
+
+private:
+    static constexpr size_t CHUNK_BITS = 12;
+    static constexpr size_t CHUNK_SIZE = size_t{1} << CHUNK_BITS;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+    std::unique_ptr<std::atomic<std::string*>[]> chunks_;
+    size_t capacity_;
+    uint32_t size_ = 0;
+};
+
+/*
+ * Имя (идентификатор) Mython, сохранённое в глобальной таблице символов.
+ * Одинаковые имена получают один и тот же 32-битный номер, поэтому символы сравниваются
+ * и хешируются как числа, а текст имени хранится в таблице один раз.
+ * Таблица общая для всех потоков; символы не удаляются до завершения программы, поэтому
+ * каждое разобранное имя, в том числе при повторных разборах правок (см. IncrementalProgram),
+ * занимает место в таблице. Таблица вмещает SymbolTable::DEFAULT_CAPACITY имён; после этого
+ * создание символа с новым именем выбрасывает runtime_error, а разбор текста с новыми
+ * именами завершается этой ошибкой. Создание символа из строки интернирует её, поэтому
+ * преобразование явное
+ */
+class Symbol {
+public:
+    // Пустое имя
+    Symbol() = default;
+    explicit Symbol(std::string_view name);
+    explicit Symbol(const std::string& name);
+    explicit Symbol(const char* name);
+
+    // Возвращает символ с номером id, ранее полученным из GetId()
+    static Symbol FromId(uint32_t id);
+
+    [[nodiscard]] uint32_t GetId() const {
+        return id_;
+    }
+
+    [[nodiscard]] size_t GetHash() const {
+        // номера идут подряд, умножение распределяет их по корзинам хеш-таблицы
+        return static_cast<size_t>(id_) * static_cast<size_t>(0x9E3779B97F4A7C15ULL);
+    }
+
+    [[nodiscard]] const std::string& GetName() const;
+
+private:
+    explicit Symbol(uint32_t id)
+        : id_(id) {
+    }
+
+    uint32_t id_ = 0;
+};
+
+inline bool operator==(Symbol lhs, Symbol rhs) {
+    return lhs.GetId() == rhs.GetId();
+}
+
+inline bool operator!=(Symbol lhs, Symbol rhs) {
+    return !(lhs == rhs);
+}
+
+std::ostream& operator<<(std::ostream& os, Symbol symbol);
+
+}  // namespace runtime
+
+namespace std {
+
+template <>
+struct hash<runtime::Symbol> {
+    size_t operator()(runtime::Symbol symbol) const {
+        return symbol.GetHash();
+    }
+};
+
+}  // namespace std
@@ -0,0 +1,81 @@
+#include "symbol.h"
+#include "test_runner_p.h"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace runtime {
+
+namespace {
+
+void TestSameNamesShareSymbol() {
+    const Symbol x("x"sv);
+    ASSERT_EQUAL(x, Symbol("x"s));
+    ASSERT_EQUAL(x, Symbol("x"));
+    ASSERT(x != Symbol("y"sv));
+    ASSERT_EQUAL(x.GetName(), "x"s);
+    ASSERT_EQUAL(Symbol::FromId(x.GetId()), x);
+    ASSERT_EQUAL(hash<Symbol>()(x), hash<Symbol>()(Symbol("x"s)));
+
+    ASSERT_EQUAL(Symbol().GetId(), 0U);
+    ASSERT_EQUAL(Symbol(""sv), Symbol());
+    ASSERT_EQUAL(Symbol().GetName(), ""s);
+
+    unordered_map<Symbol, int> closure;
+    closure[Symbol("value"s)] = 1;
+    ASSERT_EQUAL(closure.count(Symbol("value"sv)), 1U);
+}
+
+void TestConcurrentInterning() {
+    constexpr int THREADS = 4;
+    constexpr int NAMES = 2000;
+    vector<vector<Symbol>> symbols(THREADS);
+    vector<thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t, &symbols] {
+            for (int i = 0; i < NAMES; ++i) {
+                symbols[t].emplace_back("concurrent_"s + to_string(i));
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    for (int t = 1; t < THREADS; ++t) {
+        ASSERT(symbols[t] == symbols[0]);
+    }
+    for (int i = 0; i < NAMES; ++i) {
+        ASSERT_EQUAL(symbols[0][i].GetName(), "concurrent_"s + to_string(i));
+    }
+}
+
+void TestTableCapacity() {
+    // пустое имя занимает первый номер
+    SymbolTable table(3);
+    const uint32_t a = table.Intern("a"sv);
+    ASSERT_EQUAL(table.Intern("b"sv), a + 1);
+    ASSERT_EQUAL(table.Size(), table.Capacity());
+
+    // заполненная таблица отвергает новые имена, но находит добавленные
+    ASSERT_THROWS(table.Intern("c"sv), runtime_error);
+    ASSERT_EQUAL(table.Intern("a"sv), a);
+    ASSERT_EQUAL(table.Name(a), "a"s);
+    ASSERT_EQUAL(table.Size(), 3U);
+
+    ASSERT_EQUAL(SymbolTable().Capacity(), SymbolTable::DEFAULT_CAPACITY);
+}
+
+}  // namespace
+
+void RunSymbolTests(TestRunner& tr) {
+    RUN_TEST(tr, TestSameNamesShareSymbol);
+    RUN_TEST(tr, TestConcurrentInterning);
+    RUN_TEST(tr, TestTableCapacity);
+}
+
+}  // namespace runtime
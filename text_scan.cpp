@@ -0,0 +1,164 @@
+#include "text_scan.h"
+
+#include "simd.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace parse::scan {
+
+namespace {
+
+#if defined(MYTHON_SIMD_AVX2) || defined(MYTHON_SIMD_SSE2)
+
+inline unsigned FirstSetBit(uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// Операции над блоком из 16 байт
+struct Sse2 {
+    using Vector = __m128i;
+    static constexpr size_t WIDTH = 16;
+    static constexpr uint32_t ALL = 0xFFFFU;
+
+    static Vector Load(const char* pos) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    }
+    static Vector Equal(Vector chunk, char c) {
+        return _mm_cmpeq_epi8(chunk, _mm_set1_epi8(c));
+    }
+    static Vector Or(Vector lhs, Vector rhs) {
+        return _mm_or_si128(lhs, rhs);
+    }
+    static uint32_t Mask(Vector v) {
+        return static_cast<uint32_t>(_mm_movemask_epi8(v));
+    }
+};
+
+#endif
+
+#if defined(MYTHON_SIMD_AVX2)
+
+// Операции над блоком из 32 байт
+struct Avx2 {
+    using Vector = __m256i;
+    static constexpr size_t WIDTH = 32;
+    static constexpr uint32_t ALL = 0xFFFFFFFFU;
+
+    static Vector Load(const char* pos) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+    }
+    static Vector Equal(Vector chunk, char c) {
+        return _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(c));
+    }
+    static Vector Or(Vector lhs, Vector rhs) {
+        return _mm256_or_si256(lhs, rhs);
+    }
+    static uint32_t Mask(Vector v) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(v));
+    }
+};
+
+#endif
+
+#if defined(MYTHON_SIMD_AVX2) || defined(MYTHON_SIMD_SSE2)
+
+// Просматривает полные блоки текста. match(Ops{}, блок) возвращает битовую маску
+// подходящих байтов блока. Возвращает найденную позицию или nullptr; pos сдвигается
+// к первому непросмотренному байту
+template <typename Ops, typename Match>
+const char* ScanBlocks(const char*& pos, const char* end, Match match) {
+    while (static_cast<size_t>(end - pos) >= Ops::WIDTH) {
+        const uint32_t mask = match(Ops{}, Ops::Load(pos));
+        if (mask != 0) {
+            return pos + FirstSetBit(mask);
+        }
+        pos += Ops::WIDTH;
+    }
+    return nullptr;
+}
+
+#endif
+
+// Сначала просматривает текст самыми широкими доступными блоками, затем узкими,
+// остаток проверяется по одному символу функцией is_match
+template <typename Match, typename ScalarMatch>
+const char* Scan(const char* pos, const char* end, [[maybe_unused]] Match match,
+                 ScalarMatch is_match) {
+#if defined(MYTHON_SIMD_AVX2)
+    if (const char* found = ScanBlocks<Avx2>(pos, end, match)) {
+        return found;
+    }
+#endif
+#if defined(MYTHON_SIMD_AVX2) || defined(MYTHON_SIMD_SSE2)
+    if (const char* found = ScanBlocks<Sse2>(pos, end, match)) {
+        return found;
+    }
+#endif
+    while (pos != end && !is_match(*pos)) {
+        ++pos;
+    }
+    return pos;
+}
+
+}  // namespace
+
+const char* FindNewline(const char* pos, const char* end) {
+    return Scan(
+        pos, end,
+        [](auto ops, auto chunk) {
+            using Ops = decltype(ops);
+            return Ops::Mask(Ops::Equal(chunk, '\n'));
+        },
+        [](char c) {
+            return c == '\n';
+        });
+}
+
+const char* SkipSpaces(const char* pos, const char* end) {
+    return Scan(
+        pos, end,
+        [](auto ops, auto chunk) {
+            using Ops = decltype(ops);
+            return Ops::Mask(Ops::Equal(chunk, ' ')) ^ Ops::ALL;
+        },
+        [](char c) {
+            return c != ' ';
+        });
+}
+
+const char* FindStringStop(const char* pos, const char* end, char quote) {
+    return Scan(
+        pos, end,
+        [quote](auto ops, auto chunk) {
+            using Ops = decltype(ops);
+            auto stops = Ops::Or(Ops::Or(Ops::Equal(chunk, quote), Ops::Equal(chunk, '\\')),
+                                 Ops::Or(Ops::Equal(chunk, '\n'), Ops::Equal(chunk, '\r')));
+            return Ops::Mask(stops);
+        },
+        [quote](char c) {
+            return c == quote || c == '\\' || c == '\n' || c == '\r';
+        });
+}
+
+const char* InstructionSet() {
+#if defined(MYTHON_SIMD_AVX2)
+    return "avx2";
+#elif defined(MYTHON_SIMD_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+}  // namespace parse::scan
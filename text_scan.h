@@ -0,0 +1,22 @@
+#pragma once
+
+namespace parse::scan {
+
+// Векторные функции поиска символов в исходном тексте.
+// Каждая функция просматривает диапазон [pos, end) блоками по 32 (AVX2) или 16 (SSE2) байт
+// и возвращает указатель на первый найденный символ либо end, если символ не найден
+
+// Ищет символ перевода строки
+const char* FindNewline(const char* pos, const char* end);
+
+// Ищет первый символ, отличный от пробела
+const char* SkipSpaces(const char* pos, const char* end);
+
+// Ищет символ, на котором должен остановиться разбор строковой константы:
+// закрывающую кавычку quote, обратную косую черту или конец строки (\n, \r)
+const char* FindStringStop(const char* pos, const char* end, char quote);
+
+// Возвращает название используемого набора инструкций: "avx2", "sse2" или "scalar"
+const char* InstructionSet();
+
+}  // namespace parse::scan
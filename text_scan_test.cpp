@@ -0,0 +1,79 @@
+#include "test_runner_p.h"
+#include "text_scan.h"
+
+#include <string>
+
+using namespace std;
+
+namespace parse::scan {
+
+namespace {
+
+// Простые версии поиска для сравнения с векторными
+const char* ReferenceFind(const char* pos, const char* end, bool (*is_match)(char)) {
+    while (pos != end && !is_match(*pos)) {
+        ++pos;
+    }
+    return pos;
+}
+
+string MakeText(size_t size, size_t seed) {
+    const string alphabet = "    abc'\"\\#\n\rxyz_12"s;
+    string text;
+    for (size_t i = 0; i < size; ++i) {
+        text.push_back(alphabet[(i * 7 + seed * 13 + i / 5) % alphabet.size()]);
+    }
+    return text;
+}
+
+void TestScannersMatchReference() {
+    // Разные длины и смещения проверяют векторные блоки и хвосты
+    for (size_t size : {0U, 1U, 15U, 16U, 17U, 31U, 32U, 33U, 64U, 100U}) {
+        for (size_t seed = 0; seed < 20; ++seed) {
+            const string text = MakeText(size, seed);
+            const string hint = "size "s + to_string(size) + " seed "s + to_string(seed);
+            for (size_t from = 0; from <= text.size(); from += 3) {
+                const char* pos = text.data() + from;
+                const char* end = text.data() + text.size();
+                AssertEqual(FindNewline(pos, end) - text.data(),
+                            ReferenceFind(pos, end, [](char c) { return c == '\n'; }) - text.data(),
+                            hint);
+                AssertEqual(SkipSpaces(pos, end) - text.data(),
+                            ReferenceFind(pos, end, [](char c) { return c != ' '; }) - text.data(),
+                            hint);
+                AssertEqual(FindStringStop(pos, end, '\'') - text.data(),
+                            ReferenceFind(pos, end,
+                                          [](char c) {
+                                              return c == '\'' || c == '\\' || c == '\n'
+                                                     || c == '\r';
+                                          })
+                                - text.data(),
+                            hint);
+            }
+        }
+    }
+}
+
+void TestLongRuns() {
+    const string spaces(1000, ' ');
+    const string text = spaces + "x"s;
+    ASSERT_EQUAL(SkipSpaces(text.data(), text.data() + text.size()) - text.data(), 1000);
+    ASSERT_EQUAL(SkipSpaces(spaces.data(), spaces.data() + spaces.size()) - spaces.data(), 1000);
+
+    const string literal = string(777, 'a') + "\"rest"s;
+    ASSERT_EQUAL(FindStringStop(literal.data(), literal.data() + literal.size(), '"')
+                     - literal.data(),
+                 777);
+    ASSERT_EQUAL(FindStringStop(literal.data(), literal.data() + literal.size(), '\'')
+                     - literal.data(),
+                 static_cast<ptrdiff_t>(literal.size()));
+}
+
+}  // namespace
+
+void RunTextScanTests(TestRunner& tr) {
+    RUN_TEST(tr, TestScannersMatchReference);
+    RUN_TEST(tr, TestLongRuns);
+}
+
+}  // namespace parse::scan
@@ -0,0 +1,398 @@
+#include "token_buffer.h"
+
+#include "text_scan.h"
+
+#include <array>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <ostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+namespace parse {
+
+namespace {
+
+// Создание токена без значения по номеру его типа
+template <size_t... Kinds>
+constexpr auto MakeDefaultTokenFactories(std::index_sequence<Kinds...>) {
+    return std::array<Token (*)(), sizeof...(Kinds)>{+[] {
+        return Token(std::in_place_index<Kinds>);
+    }...};
+}
+
+const auto DEFAULT_TOKENS
+    = MakeDefaultTokenFactories(std::make_index_sequence<std::variant_size_v<TokenBase>>());
+
+// Проверяет, что строка line начинается в первом столбце с оператора, а не с отступа,
+// комментария или пустой строки
+bool StartsTopLevelStatement(const char* line, const char* end) {
+    return line != end && *line != ' ' && *line != '#' && *line != '\n' && *line != '\r';
+}
+
+// Делит текст на части, каждая из которых начинается с оператора верхнего уровня
+vector<string_view> SplitAtTopLevel(string_view source, size_t parts, size_t min_chunk_size) {
+    const char* begin = source.data();
+    const char* end = begin + source.size();
+    const size_t target = std::max(min_chunk_size, source.size() / std::max<size_t>(parts, 1));
+
+    vector<string_view> chunks;
+    const char* chunk_begin = begin;
+    while (static_cast<size_t>(end - chunk_begin) > target) {
+        const char* line = scan::FindNewline(chunk_begin + target, end);
+        while (line != end) {
+            ++line;
+            if (StartsTopLevelStatement(line, end)) {
+                break;
+            }
+            line = scan::FindNewline(line, end);
+        }
+        if (line == end) {
+            break;
+        }
+        chunks.emplace_back(chunk_begin, line - chunk_begin);
+        chunk_begin = line;
+    }
+    chunks.emplace_back(chunk_begin, end - chunk_begin);
+    return chunks;
+}
+
+// Версия формата образа, записываемого TokenBuffer::SaveImage
+constexpr uint32_t IMAGE_VERSION = 1;
+
+// Положение текста в общем массиве символов образа
+struct TextSpan {
+    uint32_t offset;
+    uint32_t size;
+};
+
+template <typename T>
+void WritePod(ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+void WriteArray(ostream& out, const vector<T>& values) {
+    out.write(reinterpret_cast<const char*>(values.data()),
+              static_cast<streamsize>(values.size() * sizeof(T)));
+}
+
+// Последовательное чтение образа с проверкой границ
+class ImageReader {
+public:
+    explicit ImageReader(string_view image)
+        : image_(image) {
+    }
+
+    template <typename T>
+    T ReadPod() {
+        T value;
+        memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    vector<T> ReadArray(size_t count) {
+        if (count > image_.size() / sizeof(T)) {
+            throw runtime_error("Token image is truncated"s);
+        }
+        vector<T> values(count);
+        memcpy(values.data(), Take(count * sizeof(T)), count * sizeof(T));
+        return values;
+    }
+
+    string_view ReadBytes(size_t size) {
+        return {Take(size), size};
+    }
+
+private:
+    const char* Take(size_t size) {
+        if (size > image_.size() - position_) {
+            throw runtime_error("Token image is truncated"s);
+        }
+        const char* result = image_.data() + position_;
+        position_ += size;
+        return result;
+    }
+
+    string_view image_;
+    size_t position_ = 0;
+};
+
+}  // namespace
+
+TokenBuffer TokenBuffer::LexParallel(std::string_view source, size_t workers,
+                                     size_t min_chunk_size) {
+    const vector<string_view> chunks = SplitAtTopLevel(source, workers, min_chunk_size);
+    if (chunks.size() == 1) {
+        Lexer lexer(source);
+        return TokenBuffer(lexer);
+    }
+
+    vector<optional<TokenBuffer>> parts(chunks.size());
+    vector<exception_ptr> errors(chunks.size());
+    auto lex_chunk = [&chunks, &parts, &errors](size_t index) {
+        try {
+            Lexer lexer(chunks[index]);
+            parts[index].emplace(lexer);
+        } catch (...) {
+            errors[index] = current_exception();
+        }
+    };
+
+    vector<thread> threads;
+    threads.reserve(chunks.size() - 1);
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        threads.emplace_back(lex_chunk, i);
+    }
+    lex_chunk(0);
+    for (thread& t : threads) {
+        t.join();
+    }
+    // ошибка в первой по порядку части - та, на которой остановился бы разбор
+    for (const exception_ptr& error : errors) {
+        if (error) {
+            rethrow_exception(error);
+        }
+    }
+
+    const char* source_begin = source.data();
+    const char* source_end = source_begin + source.size();
+    auto in_source = [source_begin, source_end](string_view text) {
+        return !less<const char*>()(text.data(), source_begin)
+               && !less<const char*>()(source_end, text.data() + text.size());
+    };
+
+    TokenBuffer result;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const TokenBuffer& part = *parts[i];
+        const size_t base = static_cast<size_t>(chunks[i].data() - source_begin);
+
+        vector<uint32_t> text_ids(part.TextCount());
+        for (uint32_t t = 0; t < text_ids.size(); ++t) {
+            const string_view text = part.Text(t);
+            text_ids[t] = result.Intern(in_source(text) ? TokenText::Ref(text)
+                                                        : TokenText(string(text)));
+        }
+
+        // Eof всех частей, кроме последней, отбрасывается
+        const size_t count = i + 1 < chunks.size() ? part.Size() - 1 : part.Size();
+        for (size_t k = 0; k < count; ++k) {
+            const uint8_t kind = part.Kind(k);
+            uint32_t value = part.Value(k);
+            if (kind == TokenKind<token_type::String>()) {
+                value = text_ids[value];
+            }
+            result.Append(kind, base + part.Offset(k), value);
+        }
+    }
+    return result;
+}
+
+TokenBuffer::TokenBuffer(Lexer& lexer) {
+    while (true) {
+        const Token& token = lexer.CurrentToken();
+
+        uint32_t value = 0;
+        if (const auto* number = token.TryAs<token_type::Number>()) {
+            value = static_cast<uint32_t>(number->value);
+        } else if (const auto* c = token.TryAs<token_type::Char>()) {
+            value = static_cast<unsigned char>(c->value);
+        } else if (const auto* id = token.TryAs<token_type::Id>()) {
+            value = id->symbol.GetId();
+        } else if (const auto* str = token.TryAs<token_type::String>()) {
+            value = Intern(str->value);
+        }
+        Append(static_cast<uint8_t>(token.index()), lexer.CurrentOffset(), value);
+
+        if (token.Is<token_type::Eof>()) {
+            break;
+        }
+        lexer.NextToken();
+    }
+}
+
+void TokenBuffer::Append(uint8_t kind, size_t offset, uint32_t value) {
+    if (offset > numeric_limits<uint32_t>::max()) {
+        throw LexerError("Source is too large for token buffer"s);
+    }
+    kinds_.push_back(kind);
+    offsets_.push_back(static_cast<uint32_t>(offset));
+    values_.push_back(value);
+}
+
+uint32_t TokenBuffer::Intern(const TokenText& text) {
+    if (auto it = text_ids_.find(text.View()); it != text_ids_.end()) {
+        return it->second;
+    }
+    // текст, не являющийся срезом исходного текста, копируется в буфер
+    string_view stored = text.View();
+    if (text.IsOwned()) {
+        stored = owned_texts_.emplace_back(text.View());
+    }
+    const auto id = static_cast<uint32_t>(texts_.size());
+    texts_.push_back(stored);
+    text_ids_.emplace(stored, id);
+    return id;
+}
+
+size_t TokenBuffer::Size() const {
+    return kinds_.size();
+}
+
+uint8_t TokenBuffer::Kind(size_t index) const {
+    return kinds_[index];
+}
+
+uint32_t TokenBuffer::Offset(size_t index) const {
+    return offsets_[index];
+}
+
+uint32_t TokenBuffer::Value(size_t index) const {
+    return values_[index];
+}
+
+size_t TokenBuffer::TextCount() const {
+    return texts_.size();
+}
+
+std::string_view TokenBuffer::Text(uint32_t text_index) const {
+    return texts_[text_index];
+}
+
+Token TokenBuffer::At(size_t index) const {
+    const uint8_t kind = kinds_[index];
+    const uint32_t value = values_[index];
+    switch (kind) {
+        case TokenKind<token_type::Number>():
+            return token_type::Number{static_cast<int>(value)};
+        case TokenKind<token_type::Char>():
+            return token_type::Char{static_cast<char>(value)};
+        case TokenKind<token_type::Id>(): {
+            const auto symbol = runtime::Symbol::FromId(value);
+            return token_type::Id{TokenText::Ref(symbol.GetName()), symbol};
+        }
+        case TokenKind<token_type::String>():
+            return token_type::String{TokenText::Ref(texts_[value])};
+        default:
+            return DEFAULT_TOKENS[kind]();
+    }
+}
+
+void TokenBuffer::SaveImage(std::ostream& out) const {
+    // идентификаторы нумеруются внутри образа в порядке первого появления
+    unordered_map<uint32_t, uint32_t> name_ids;
+    vector<string_view> names;
+    vector<uint32_t> values = values_;
+    for (size_t i = 0; i < kinds_.size(); ++i) {
+        if (kinds_[i] == TokenKind<token_type::Id>()) {
+            auto [it, inserted] = name_ids.emplace(values[i], static_cast<uint32_t>(names.size()));
+            if (inserted) {
+                names.push_back(runtime::Symbol::FromId(values[i]).GetName());
+            }
+            values[i] = it->second;
+        }
+    }
+
+    string pool;
+    vector<TextSpan> spans;
+    spans.reserve(names.size() + texts_.size());
+    for (const auto& texts : {cref(names), cref(texts_)}) {
+        for (string_view text : texts.get()) {
+            spans.push_back({static_cast<uint32_t>(pool.size()), static_cast<uint32_t>(text.size())});
+            pool += text;
+        }
+    }
+
+    WritePod(out, IMAGE_VERSION);
+    WritePod(out, static_cast<uint32_t>(kinds_.size()));
+    WritePod(out, static_cast<uint32_t>(names.size()));
+    WritePod(out, static_cast<uint32_t>(texts_.size()));
+    WritePod(out, static_cast<uint32_t>(pool.size()));
+    WriteArray(out, kinds_);
+    WriteArray(out, offsets_);
+    WriteArray(out, values);
+    WriteArray(out, spans);
+    out.write(pool.data(), static_cast<streamsize>(pool.size()));
+}
+
+TokenBuffer TokenBuffer::LoadImage(std::string_view image) {
+    ImageReader reader(image);
+    if (reader.ReadPod<uint32_t>() != IMAGE_VERSION) {
+        throw runtime_error("Unsupported token image version"s);
+    }
+    const auto token_count = reader.ReadPod<uint32_t>();
+    const auto name_count = reader.ReadPod<uint32_t>();
+    const auto text_count = reader.ReadPod<uint32_t>();
+    const auto pool_size = reader.ReadPod<uint32_t>();
+
+    TokenBuffer result;
+    result.kinds_ = reader.ReadArray<uint8_t>(token_count);
+    result.offsets_ = reader.ReadArray<uint32_t>(token_count);
+    result.values_ = reader.ReadArray<uint32_t>(token_count);
+    const auto spans = reader.ReadArray<TextSpan>(size_t{name_count} + text_count);
+    const string_view pool = reader.ReadBytes(pool_size);
+
+    auto text_of = [pool](const TextSpan& span) {
+        if (span.offset > pool.size() || span.size > pool.size() - span.offset) {
+            throw runtime_error("Token image is corrupted"s);
+        }
+        return pool.substr(span.offset, span.size);
+    };
+    vector<uint32_t> symbols(name_count);
+    for (uint32_t i = 0; i < name_count; ++i) {
+        symbols[i] = runtime::Symbol(text_of(spans[i])).GetId();
+    }
+    result.texts_.reserve(text_count);
+    for (uint32_t i = 0; i < text_count; ++i) {
+        result.texts_.push_back(text_of(spans[name_count + i]));
+    }
+
+    if (token_count == 0 || result.kinds_.back() != TokenKind<token_type::Eof>()) {
+        throw runtime_error("Token image is corrupted"s);
+    }
+    for (size_t i = 0; i < token_count; ++i) {
+        const uint8_t kind = result.kinds_[i];
+        uint32_t& value = result.values_[i];
+        if (kind >= variant_size_v<TokenBase>
+            || (kind == TokenKind<token_type::Id>() && value >= name_count)
+            || (kind == TokenKind<token_type::String>() && value >= text_count)) {
+            throw runtime_error("Token image is corrupted"s);
+        }
+        if (kind == TokenKind<token_type::Id>()) {
+            value = symbols[value];
+        }
+    }
+    return result;
+}
+
+TokenCursor::TokenCursor(const TokenBuffer& buffer)
+    : TokenCursor(buffer, 0) {
+}
+
+TokenCursor::TokenCursor(const TokenBuffer& buffer, size_t position)
+    : buffer_(buffer)
+    , position_(std::min(position, buffer.Size() - 1)) {
+    currentToken = buffer_.At(position_);
+}
+
+const Token& TokenCursor::NextToken() {
+    // за последним токеном (Eof) курсор не продвигается
+    if (position_ + 1 < buffer_.Size()) {
+        ++position_;
+        currentToken = buffer_.At(position_);
+    }
+    return currentToken;
+}
+
+size_t TokenCursor::Position() const {
+    return position_;
+}
+
+}  // namespace parse
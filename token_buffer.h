@@ -0,0 +1,130 @@
+#pragma once
+
+#include "lexer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace parse {
+
+template <typename T, typename... Types>
+constexpr uint8_t TokenKindIn(std::variant<Types...>*) {
+    constexpr bool matches[] = {std::is_same_v<T, Types>...};
+    for (uint8_t i = 0; i < sizeof...(Types); ++i) {
+        if (matches[i]) {
+            return i;
+        }
+    }
+    return sizeof...(Types);
+}
+
+// Номер типа токена T в варианте Token
+template <typename T>
+constexpr uint8_t TokenKind() {
+    return TokenKindIn<T>(static_cast<TokenBase*>(nullptr));
+}
+
+/*
+ * Весь текст программы, заранее разобранный на токены.
+ * Токены хранятся по столбцам: тип, смещение от начала текста и значение.
+ * Значение числа и символа хранится непосредственно, а значение идентификатора или
+ * строки - это номер текста в таблице уникальных текстов, поэтому одинаковые имена
+ * хранятся один раз. Тексты ссылаются на исходный текст лексера, который должен
+ * оставаться действительным, пока используется буфер
+ */
+class TokenBuffer {
+public:
+    // Считывает все токены лексера, начиная с текущего, до token_type::Eof включительно
+    explicit TokenBuffer(Lexer& lexer);
+
+    /*
+     * Разбирает текст source на токены в workers потоков.
+     * Текст делится на части по границам строк, начинающихся в первом столбце с оператора
+     * верхнего уровня. На такой границе все блоки закрыты, поэтому каждая часть разбирается
+     * независимо с нулевым отступом, а лексема Dedent, закрывающая блоки в конце части,
+     * совпадает с той, что выдал бы последовательный разбор. Части короче min_chunk_size
+     * байт не создаются. Результат совпадает с TokenBuffer(Lexer(source))
+     */
+    static TokenBuffer LexParallel(std::string_view source, size_t workers,
+                                   size_t min_chunk_size = DEFAULT_MIN_CHUNK_SIZE);
+
+    static constexpr size_t DEFAULT_MIN_CHUNK_SIZE = 64 * 1024;
+
+    [[nodiscard]] size_t Size() const;
+
+    // Номер типа токена index в варианте Token (см. TokenKind)
+    [[nodiscard]] uint8_t Kind(size_t index) const;
+    // Смещение начала токена index от начала текста
+    [[nodiscard]] uint32_t Offset(size_t index) const;
+    // Значение числа или символа, номер символа runtime::Symbol идентификатора
+    // либо номер текста строки
+    [[nodiscard]] uint32_t Value(size_t index) const;
+
+    // Количество уникальных текстов строк
+    [[nodiscard]] size_t TextCount() const;
+    [[nodiscard]] std::string_view Text(uint32_t text_index) const;
+
+    // Восстанавливает токен index
+    [[nodiscard]] Token At(size_t index) const;
+
+    /*
+     * Записывает буфер в двоичный образ: столбцы токенов, имена идентификаторов и тексты
+     * строк. Номера символов действительны только внутри процесса, поэтому идентификаторы
+     * записываются именами
+     */
+    void SaveImage(std::ostream& out) const;
+
+    // Восстанавливает буфер из образа image, записанного SaveImage. Тексты строк ссылаются
+    // на image, который должен оставаться действительным, пока используется буфер.
+    // Если образ повреждён, выбрасывает std::runtime_error
+    static TokenBuffer LoadImage(std::string_view image);
+
+private:
+    TokenBuffer() = default;
+
+    uint32_t Intern(const TokenText& text);
+    void Append(uint8_t kind, size_t offset, uint32_t value);
+
+    std::vector<uint8_t> kinds_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> values_;
+
+    std::vector<std::string_view> texts_;
+    std::unordered_map<std::string_view, uint32_t> text_ids_;
+    // строки с escape-последовательностями, не имеющие среза в исходном тексте
+    std::deque<std::string> owned_texts_;
+};
+
+// Последовательный просмотр буфера токенов по номерам
+class TokenCursor : public TokenSource {
+public:
+    explicit TokenCursor(const TokenBuffer& buffer);
+    // Курсор, текущим токеном которого является токен position
+    TokenCursor(const TokenBuffer& buffer, size_t position);
+
+    const Token& NextToken() override;
+
+    // Номер текущего токена в буфере
+    [[nodiscard]] size_t Position() const;
+
+    // Проверяет, что токен, расположенный на ahead позиций после текущего, имеет тип T.
+    // За концом буфера находится token_type::Eof
+    template <typename T>
+    [[nodiscard]] bool PeekIs(size_t ahead) const {
+        const size_t index = std::min(position_ + ahead, buffer_.Size() - 1);
+        return buffer_.Kind(index) == TokenKind<T>();
+    }
+
+private:
+    const TokenBuffer& buffer_;
+    size_t position_ = 0;
+};
+
+}  // namespace parse
@@ -0,0 +1,188 @@
+#include "parse.h"
+#include "statement.h"
+#include "test_runner_p.h"
+#include "token_buffer.h"
+
+#include <string>
+
+using namespace std;
+
+namespace parse {
+
+namespace {
+
+void TestBufferColumns() {
+    const string source = "x = 'a\\tb'\nprint x, x, 12\n"s;
+    Lexer lexer(string_view{source});
+    TokenBuffer buffer(lexer);
+
+    // x = 'a\tb' \n print x , x , 12 \n Eof
+    ASSERT_EQUAL(buffer.Size(), 12U);
+    ASSERT_EQUAL(buffer.Kind(0), TokenKind<token_type::Id>());
+    ASSERT_EQUAL(buffer.Kind(1), TokenKind<token_type::Char>());
+    ASSERT_EQUAL(buffer.Kind(4), TokenKind<token_type::Print>());
+    ASSERT_EQUAL(buffer.Kind(11), TokenKind<token_type::Eof>());
+
+    ASSERT_EQUAL(buffer.Offset(0), 0U);
+    ASSERT_EQUAL(buffer.Offset(2), 4U);
+    ASSERT_EQUAL(buffer.Offset(4), source.find("print"s));
+    ASSERT_EQUAL(buffer.Value(9), 12U);
+
+    // Идентификаторы хранятся номерами символов, тексты - только у строк
+    ASSERT_EQUAL(buffer.Value(0), runtime::Symbol("x"sv).GetId());
+    ASSERT_EQUAL(buffer.Value(5), buffer.Value(7));
+    ASSERT_EQUAL(buffer.TextCount(), 1U);
+    ASSERT_EQUAL(buffer.Text(buffer.Value(2)), "a\tb"sv);
+
+    ASSERT_EQUAL(buffer.At(0), Token(token_type::Id{"x"s}));
+    ASSERT_EQUAL(buffer.At(0).As<token_type::Id>().symbol, runtime::Symbol("x"sv));
+    ASSERT_EQUAL(buffer.At(2), Token(token_type::String{"a\tb"s}));
+    ASSERT_EQUAL(buffer.At(9), Token(token_type::Number{12}));
+    ASSERT_EQUAL(buffer.At(10), Token(token_type::Newline{}));
+}
+
+void TestCursorMatchesLexer() {
+    const string source = R"(
+class A:
+  def f(n):
+    if n <= 1:
+      return "one"
+    return 'many'
+
+a = A()
+print a.f(1), a.f(2)
+)"s;
+    Lexer reference(string_view{source});
+    Lexer lexer(string_view{source});
+    TokenBuffer buffer(lexer);
+    TokenCursor cursor(buffer);
+
+    while (true) {
+        ASSERT_EQUAL(cursor.CurrentToken(), reference.CurrentToken());
+        if (reference.CurrentToken().Is<token_type::Eof>()) {
+            break;
+        }
+        cursor.NextToken();
+        reference.NextToken();
+    }
+    ASSERT_EQUAL(cursor.NextToken(), Token(token_type::Eof{}));
+}
+
+void TestCursorLookahead() {
+    Lexer lexer(string_view{"x.y = 1"});
+    TokenBuffer buffer(lexer);
+    TokenCursor cursor(buffer);
+
+    ASSERT(cursor.PeekIs<token_type::Id>(0));
+    ASSERT(cursor.PeekIs<token_type::Char>(1));
+    ASSERT(cursor.PeekIs<token_type::Id>(2));
+    ASSERT(cursor.PeekIs<token_type::Number>(4));
+    ASSERT(cursor.PeekIs<token_type::Eof>(100));
+
+    cursor.ExpectNext<token_type::Char>('.');
+    ASSERT_EQUAL(cursor.Position(), 1U);
+    ASSERT(cursor.PeekIs<token_type::Char>(2));
+}
+
+void TestPretokenizedParsing() {
+    const string program = R"(
+class Counter:
+  def __init__(start):
+    self.value = start
+
+  def add(n):
+    if n > 0 and not n == 13:
+      self.value = self.value + n
+    else:
+      print "skip", n
+    return self.value
+
+c = Counter(10)
+c.add(5)
+c.add(13)
+print c.add(-1 * -2), len("abc")
+)"s;
+
+    auto run = [&program](bool pretokenize) {
+        Lexer lexer(string_view{program});
+        ParseOptions options;
+        options.pretokenize = pretokenize;
+        auto tree = ParseProgram(lexer, options);
+
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        tree->Execute(closure, context);
+        return context.output.str();
+    };
+
+    ASSERT_EQUAL(run(true), "skip 13\n17 3\n"s);
+    ASSERT_EQUAL(run(true), run(false));
+}
+
+void AssertSameTokens(const TokenBuffer& lhs, const TokenBuffer& rhs) {
+    ASSERT_EQUAL(lhs.Size(), rhs.Size());
+    for (size_t i = 0; i < lhs.Size(); ++i) {
+        const string hint = "token "s + to_string(i);
+        AssertEqual(lhs.At(i), rhs.At(i), hint);
+        AssertEqual(lhs.Offset(i), rhs.Offset(i), hint);
+    }
+}
+
+void TestParallelLexingMatchesSequential() {
+    string source;
+    for (int i = 0; i < 200; ++i) {
+        const string n = to_string(i);
+        source += "class C"s + n + ":\n"s;
+        source += "  def f(x):\n"s;
+        source += "    if x > "s + n + ":\n"s;
+        source += "      return 'big\\t"s + n + "'\n"s;
+        source += "\n    # comment\n"s;
+        source += "    return x\n"s;
+        source += "# top-level comment\n"s;
+        source += "c"s + n + " = C"s + n + "()\n"s;
+        source += "if c"s + n + ".f(1) == 1:\n  print 'x'\nelse:\n  print 'y'\n"s;
+    }
+    // последняя строка без перевода строки внутри блока
+    source += "if True:\n  print 1"s;
+
+    Lexer lexer(string_view{source});
+    TokenBuffer sequential(lexer);
+
+    for (size_t workers : {1U, 2U, 3U, 8U, 64U}) {
+        TokenBuffer parallel = TokenBuffer::LexParallel(source, workers, 1);
+        AssertSameTokens(parallel, sequential);
+        ASSERT_EQUAL(parallel.TextCount(), sequential.TextCount());
+    }
+}
+
+void TestParallelLexingReportsFirstError() {
+    string source;
+    for (int i = 0; i < 100; ++i) {
+        source += "x = "s + to_string(i) + "\n"s;
+    }
+    source += "y = 'unterminated\n"s;
+    for (int i = 0; i < 100; ++i) {
+        source += "z = 99999999999999999999\n"s;
+    }
+    // Ошибки есть в нескольких частях; выдаётся та, что встречается раньше в тексте
+    string message;
+    try {
+        static_cast<void>(TokenBuffer::LexParallel(source, 4, 1));
+    } catch (const LexerError& e) {
+        message = e.what();
+    }
+    ASSERT_EQUAL(message, "Unexpected end of line"s);
+}
+
+}  // namespace
+
+void RunTokenBufferTests(TestRunner& tr) {
+    RUN_TEST(tr, TestBufferColumns);
+    RUN_TEST(tr, TestCursorMatchesLexer);
+    RUN_TEST(tr, TestCursorLookahead);
+    RUN_TEST(tr, TestPretokenizedParsing);
+    RUN_TEST(tr, TestParallelLexingMatchesSequential);
+    RUN_TEST(tr, TestParallelLexingReportsFirstError);
+}
+
+}  // namespace parse
@@ -0,0 +1,133 @@
+#include "token_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+#include <unistd.h>
+
+using namespace std;
+
+namespace parse {
+
+namespace {
+
+// Заголовок файла образа. За ним следуют текст, для которого записан образ, и образ
+// буфера токенов. Хеш определяет только имя файла и может совпасть у разных текстов,
+// поэтому образ принимается, лишь если записанный в нём текст совпадает с разбираемым
+struct ImageHeader {
+    char magic[8];
+    uint64_t source_size;
+};
+
+constexpr char IMAGE_MAGIC[8] = {'M', 'Y', 'T', 'O', 'K', 'E', 'N', '2'};
+
+// FNV-1a: хеш не зависит от реализации стандартной библиотеки, поэтому имя образа
+// совпадает у разных сборок интерпретатора
+uint64_t HashText(string_view text) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : text) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+}  // namespace
+
+TokenCache::TokenCache(std::string directory)
+    : directory_(std::move(directory)) {
+}
+
+std::string TokenCache::DefaultDirectory() {
+    if (const char* dir = getenv("MYTHON_CACHE_DIR")) {
+        return dir;
+    }
+    if (const char* dir = getenv("XDG_CACHE_HOME"); dir && *dir) {
+        return string(dir) + "/mython"s;
+    }
+    if (const char* dir = getenv("HOME"); dir && *dir) {
+        return string(dir) + "/.cache/mython"s;
+    }
+    return {};
+}
+
+std::string TokenCache::ImagePath(std::string_view source) const {
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(HashText(source)));
+    return directory_ + "/"s + name + ".tokens"s;
+}
+
+const TokenBuffer& TokenCache::Tokenize(std::string_view source, size_t workers) {
+    tokens_.reset();
+    image_.reset();
+    hit_ = false;
+    if (directory_.empty()) {
+        return tokens_.emplace(TokenBuffer::LexParallel(source, workers));
+    }
+
+    const string path = ImagePath(source);
+    try {
+        MappedFile image(path);
+        const string_view data = image.Text();
+        ImageHeader header{};
+        if (data.size() >= sizeof(header)) {
+            memcpy(&header, data.data(), sizeof(header));
+        }
+        // сравнение текста дешевле его разбора: это одно последовательное чтение памяти
+        if (data.size() >= sizeof(header) + source.size()
+            && memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) == 0
+            && header.source_size == source.size()
+            && data.substr(sizeof(header), source.size()) == source) {
+            tokens_.emplace(TokenBuffer::LoadImage(data.substr(sizeof(header) + source.size())));
+            image_.emplace(std::move(image));
+            hit_ = true;
+            return *tokens_;
+        }
+    } catch (const runtime_error&) {
+        // образа нет или он повреждён: текст разбирается заново
+    }
+
+    tokens_.emplace(TokenBuffer::LexParallel(source, workers));
+    Save(source, path);
+    return *tokens_;
+}
+
+bool TokenCache::LastWasHit() const {
+    return hit_;
+}
+
+void TokenCache::Save(std::string_view source, const std::string& path) const {
+    error_code error;
+    filesystem::create_directories(directory_, error);
+    if (error) {
+        return;
+    }
+    // образ записывается во временный файл и переименовывается, чтобы параллельно
+    // запущенные интерпретаторы не прочитали его недописанным
+    const string temp_path = path + ".tmp"s + to_string(getpid());
+    {
+        ofstream out(temp_path, ios::binary | ios::trunc);
+        ImageHeader header{};
+        memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+        header.source_size = source.size();
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(source.data(), static_cast<streamsize>(source.size()));
+        tokens_->SaveImage(out);
+        if (!out) {
+            out.close();
+            filesystem::remove(temp_path, error);
+            return;
+        }
+    }
+    filesystem::rename(temp_path, path, error);
+    if (error) {
+        filesystem::remove(temp_path, error);
+    }
+}
+
+}  // namespace parse
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "lexer.h"
+#include "token_buffer.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace parse {
+
+/*
+ * Кэш токенов: каталог образов буферов токенов (см. TokenBuffer::SaveImage) для ранее
+ * разобранных текстов. Имя образа - хеш содержимого текста, поэтому при повторном запуске
+ * той же программы образ отображается в память и текст не разбирается на токены заново.
+ * Образ хранит копию текста и используется, только если она совпадает с source:
+ *
+ * parse::TokenCache cache(parse::TokenCache::DefaultDirectory());
+ * auto tree = ParseProgram(cache.Tokenize(source, workers), options);
+ *
+ * Кэш - только ускорение: повреждённый или чужой образ игнорируется, а ошибки чтения и
+ * записи образов не прерывают разбор.
+ *
+ * Кэшируется только лексический анализ. Синтаксический анализ выполняется при каждом
+ * запуске заново: дерево программы ссылается на объекты классов и встроенные функции
+ * по адресам, и кэш разобранного дерева, который связывал бы их при загрузке, не реализован
+ */
+class TokenCache {
+public:
+    // Образы хранятся в каталоге directory, который создаётся при записи первого образа.
+    // Пустой directory отключает кэш
+    explicit TokenCache(std::string directory);
+
+    // Каталог из переменной окружения MYTHON_CACHE_DIR, иначе $XDG_CACHE_HOME/mython,
+    // иначе $HOME/.cache/mython. Пустая строка, если каталог определить нельзя
+    // или MYTHON_CACHE_DIR задана пустой
+    [[nodiscard]] static std::string DefaultDirectory();
+
+    /*
+     * Возвращает токены текста source: из образа, если он записан для того же текста,
+     * иначе разбирает текст TokenBuffer::LexParallel в workers потоков и записывает образ.
+     * Ошибки разбора текста выбрасываются как обычно. Буфер действителен, пока существуют
+     * кэш и текст source, и до следующего вызова Tokenize
+     */
+    const TokenBuffer& Tokenize(std::string_view source, size_t workers);
+
+    // Возвращает true, если последний вызов Tokenize прочитал токены из образа
+    [[nodiscard]] bool LastWasHit() const;
+
+    // Путь к образу для текста source
+    [[nodiscard]] std::string ImagePath(std::string_view source) const;
+
+private:
+    void Save(std::string_view source, const std::string& path) const;
+
+    std::string directory_;
+    std::optional<MappedFile> image_;
+    std::optional<TokenBuffer> tokens_;
+    bool hit_ = false;
+};
+
+}  // namespace parse
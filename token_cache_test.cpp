@@ -0,0 +1,173 @@
+#include "parse.h"
+#include "test_runner_p.h"
+#include "token_cache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace std;
+
+namespace parse {
+
+namespace {
+
+const string PROGRAM = R"(
+class Greeter:
+  def greet(name):
+    return 'hello, ' + name + "\t!"
+
+g = Greeter()
+if g.greet('x') != 'hi':
+  print g.greet("world"), 42
+)"s;
+
+void AssertSameTokens(const TokenBuffer& lhs, const TokenBuffer& rhs) {
+    ASSERT_EQUAL(lhs.Size(), rhs.Size());
+    for (size_t i = 0; i < lhs.Size(); ++i) {
+        const string hint = "token "s + to_string(i);
+        AssertEqual(lhs.At(i), rhs.At(i), hint);
+        AssertEqual(lhs.Offset(i), rhs.Offset(i), hint);
+    }
+}
+
+string Run(const TokenBuffer& tokens) {
+    auto tree = ParseProgram(tokens, ParseOptions{});
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    tree->Execute(closure, context);
+    return context.output.str();
+}
+
+// Временный каталог, удаляемый вместе с содержимым
+class TempDirectory {
+public:
+    TempDirectory()
+        : path_(filesystem::temp_directory_path()
+                / ("mython_cache_test_"s + to_string(getpid()))) {
+        filesystem::remove_all(path_);
+    }
+
+    ~TempDirectory() {
+        error_code error;
+        filesystem::remove_all(path_, error);
+    }
+
+    [[nodiscard]] string Path() const {
+        return path_.string();
+    }
+
+private:
+    filesystem::path path_;
+};
+
+void TestImageRoundTrip() {
+    Lexer lexer(string_view{PROGRAM});
+    TokenBuffer tokens(lexer);
+
+    ostringstream out;
+    tokens.SaveImage(out);
+    const string image = out.str();
+    TokenBuffer loaded = TokenBuffer::LoadImage(image);
+
+    AssertSameTokens(loaded, tokens);
+    ASSERT_EQUAL(loaded.TextCount(), tokens.TextCount());
+    ASSERT_EQUAL(Run(loaded), "hello, world\t! 42\n"s);
+}
+
+void TestDamagedImagesAreRejected() {
+    Lexer lexer(string_view{PROGRAM});
+    TokenBuffer tokens(lexer);
+    ostringstream out;
+    tokens.SaveImage(out);
+    const string image = out.str();
+
+    for (size_t size : {size_t{0}, size_t{3}, size_t{20}, image.size() / 2, image.size() - 1}) {
+        ASSERT_THROWS(TokenBuffer::LoadImage(string_view(image).substr(0, size)), runtime_error);
+    }
+    string other_version = image;
+    other_version[0] = static_cast<char>(other_version[0] + 1);
+    ASSERT_THROWS(TokenBuffer::LoadImage(other_version), runtime_error);
+}
+
+void TestCacheReusesImages() {
+    TempDirectory directory;
+    string expected;
+    {
+        TokenCache cache(directory.Path());
+        expected = Run(cache.Tokenize(PROGRAM, 2));
+        ASSERT(!cache.LastWasHit());
+        ASSERT(filesystem::exists(cache.ImagePath(PROGRAM)));
+    }
+
+    TokenCache cache(directory.Path());
+    const TokenBuffer& cached = cache.Tokenize(PROGRAM, 2);
+    ASSERT(cache.LastWasHit());
+    Lexer lexer(string_view{PROGRAM});
+    AssertSameTokens(cached, TokenBuffer(lexer));
+    ASSERT_EQUAL(Run(cached), expected);
+
+    // изменённый текст получает свой образ
+    const string changed = PROGRAM + "print 1\n"s;
+    ASSERT(cache.ImagePath(changed) != cache.ImagePath(PROGRAM));
+    ASSERT_EQUAL(Run(cache.Tokenize(changed, 1)), expected + "1\n"s);
+    ASSERT(!cache.LastWasHit());
+    cache.Tokenize(changed, 1);
+    ASSERT(cache.LastWasHit());
+
+    // повреждённый образ разбирается заново и перезаписывается
+    ofstream(cache.ImagePath(PROGRAM), ios::binary | ios::trunc) << "garbage"s;
+    ASSERT_EQUAL(Run(cache.Tokenize(PROGRAM, 1)), expected);
+    ASSERT(!cache.LastWasHit());
+    cache.Tokenize(PROGRAM, 1);
+    ASSERT(cache.LastWasHit());
+
+    // образ другого текста под тем же именем, как при совпадении хешей, не используется
+    string same_size = PROGRAM;
+    same_size.replace(same_size.find("42"s), 2, "17"s);
+    filesystem::copy_file(cache.ImagePath(PROGRAM), cache.ImagePath(same_size),
+                          filesystem::copy_options::overwrite_existing);
+    ASSERT_EQUAL(Run(cache.Tokenize(same_size, 1)), "hello, world\t! 17\n"s);
+    ASSERT(!cache.LastWasHit());
+
+    // ошибки разбора не оставляют образа
+    const string bad = "x = 'unterminated\n"s;
+    ASSERT_THROWS(cache.Tokenize(bad, 1), LexerError);
+    ASSERT(!filesystem::exists(cache.ImagePath(bad)));
+}
+
+void TestCachedTokensAreParsedAgain() {
+    TempDirectory directory;
+    // текст без лексических ошибок, но с синтаксической
+    const string bad = "x = unknown(1)\n"s;
+    TokenCache cache(directory.Path());
+    ASSERT_THROWS(Run(cache.Tokenize(bad, 1)), ParseError);
+    ASSERT(!cache.LastWasHit());
+
+    // кэшируются только токены: программа из образа разбирается заново
+    const TokenBuffer& cached = cache.Tokenize(bad, 1);
+    ASSERT(cache.LastWasHit());
+    ASSERT_THROWS(Run(cached), ParseError);
+}
+
+void TestEmptyDirectoryDisablesCache() {
+    TokenCache cache(""s);
+    ASSERT_EQUAL(Run(cache.Tokenize(PROGRAM, 1)), "hello, world\t! 42\n"s);
+    cache.Tokenize(PROGRAM, 1);
+    ASSERT(!cache.LastWasHit());
+}
+
+}  // namespace
+
+void RunTokenCacheTests(TestRunner& tr) {
+    RUN_TEST(tr, TestImageRoundTrip);
+    RUN_TEST(tr, TestDamagedImagesAreRejected);
+    RUN_TEST(tr, TestCacheReusesImages);
+    RUN_TEST(tr, TestCachedTokensAreParsedAgain);
+    RUN_TEST(tr, TestEmptyDirectoryDisablesCache);
+}
+
+}  // namespace parse
@@ -0,0 +1,156 @@
+#include "token_pipeline.h"
+
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <optional>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace parse {
+
+TokenPipeline::TokenPipeline(std::istream& input)
+    : producer_([this, &input] {
+        Produce(input);
+    }) {
+    try {
+        NextToken();
+    } catch (...) {
+        Stop();
+        throw;
+    }
+}
+
+TokenPipeline::TokenPipeline(int fd) {
+    int wake[2];
+    if (pipe2(wake, O_CLOEXEC) != 0) {
+        throw runtime_error("Cannot create pipe: "s + strerror(errno));
+    }
+    wake_read_ = wake[0];
+    wake_write_ = wake[1];
+    producer_ = thread([this, fd]() mutable {
+        Produce(fd);
+    });
+    try {
+        NextToken();
+    } catch (...) {
+        Stop();
+        throw;
+    }
+}
+
+TokenPipeline::~TokenPipeline() {
+    Stop();
+}
+
+void TokenPipeline::Stop() {
+    {
+        lock_guard lock(ring_mutex_);
+        stopped_.store(true, memory_order_relaxed);
+    }
+    ring_changed_.notify_all();
+    if (wake_write_ >= 0) {
+        const char byte = 0;
+        while (write(wake_write_, &byte, 1) < 0 && errno == EINTR) {
+        }
+    }
+    if (producer_.joinable()) {
+        producer_.join();
+    }
+    for (int* wake : {&wake_read_, &wake_write_}) {
+        if (*wake >= 0) {
+            close(*wake);
+            *wake = -1;
+        }
+    }
+}
+
+Lexer TokenPipeline::MakeLexer(std::istream& input) {
+    return Lexer(input);
+}
+
+Lexer TokenPipeline::MakeLexer(int fd) const {
+    return Lexer(fd, Lexer::DEFAULT_BUFFER_SIZE, wake_read_);
+}
+
+template <typename Input>
+void TokenPipeline::Produce(Input& input) {
+    Batch batch;
+    batch.tokens.reserve(BATCH_SIZE);
+    try {
+        // токены лексера, читающего поток, не ссылаются на его буфер,
+        // поэтому лексер не обязан пережить переданные пакеты
+        Lexer lexer = MakeLexer(input);
+        while (!stopped_.load(memory_order_relaxed)) {
+            const Token& token = lexer.CurrentToken();
+            const bool eof = token.Is<token_type::Eof>();
+            batch.tokens.push_back(token);
+            if (eof) {
+                break;
+            }
+            // без передачи неполного пакета читатель ждал бы, пока писатель дочитает
+            // ввод, например строки, которые пользователь ещё не набрал
+            if (batch.tokens.size() == BATCH_SIZE || lexer.NeedsInput()) {
+                if (!Push(std::move(batch))) {
+                    return;
+                }
+                batch = Batch{};
+                batch.tokens.reserve(BATCH_SIZE);
+            }
+            lexer.NextToken();
+        }
+    } catch (...) {
+        batch.error = current_exception();
+    }
+    Push(std::move(batch));
+}
+
+bool TokenPipeline::Push(Batch&& batch) {
+    {
+        unique_lock lock(ring_mutex_);
+        // TryPush не трогает batch, если очередь заполнена
+        ring_changed_.wait(lock, [this, &batch] {
+            return stopped_.load(memory_order_relaxed) || ring_.TryPush(std::move(batch));
+        });
+        if (stopped_.load(memory_order_relaxed)) {
+            return false;
+        }
+    }
+    ring_changed_.notify_one();
+    return true;
+}
+
+void TokenPipeline::Pop() {
+    optional<Batch> batch;
+    {
+        unique_lock lock(ring_mutex_);
+        ring_changed_.wait(lock, [this, &batch] {
+            batch = ring_.TryPop();
+            return batch.has_value();
+        });
+    }
+    ring_changed_.notify_one();
+    batch_ = std::move(*batch);
+    position_ = 0;
+}
+
+const Token& TokenPipeline::NextToken() {
+    if (finished_) {
+        return currentToken;
+    }
+    while (position_ == batch_.tokens.size()) {
+        if (batch_.error) {
+            rethrow_exception(batch_.error);
+        }
+        Pop();
+    }
+    currentToken = std::move(batch_.tokens[position_++]);
+    finished_ = currentToken.Is<token_type::Eof>();
+    return currentToken;
+}
+
+}  // namespace parse
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "lexer.h"
+#include "spsc_ring.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <iosfwd>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parse {
+
+/*
+ * Источник токенов, лексический анализ которого выполняется в отдельном потоке.
+ * Поток-лексер передаёт токены пакетами через очередь SpscRing, а синтаксический
+ * анализатор читает их в своём потоке, так что разбор на токены и построение дерева
+ * программы идут одновременно. Лексер читает текст буфером ограниченного размера, и чтение
+ * ввода тоже совмещается с разбором. Ошибка лексического анализа передаётся через очередь
+ * и выбрасывается при достижении токена, на котором она произошла
+ */
+class TokenPipeline : public TokenSource {
+public:
+    explicit TokenPipeline(std::istream& input);
+    // Читает текст из файлового дескриптора fd (см. Lexer(int, size_t)). Остановка
+    // конвейера прерывает ожидание ввода, поэтому ошибка разбора сообщается сразу,
+    // даже если источник текста ещё не закрыт
+    explicit TokenPipeline(int fd);
+    ~TokenPipeline() override;
+
+    TokenPipeline(const TokenPipeline&) = delete;
+    TokenPipeline& operator=(const TokenPipeline&) = delete;
+
+    const Token& NextToken() override;
+
+    // Количество токенов в одном пакете
+    static constexpr size_t BATCH_SIZE = 256;
+
+private:
+    struct Batch {
+        std::vector<Token> tokens;
+        // ошибка лексического анализа после последнего токена пакета
+        std::exception_ptr error;
+    };
+
+    // Разбирает текст источника input (поток или файловый дескриптор) в потоке-писателе.
+    // Неполный пакет передаётся читателю перед ожиданием ввода
+    template <typename Input>
+    void Produce(Input& input);
+    static Lexer MakeLexer(std::istream& input);
+    Lexer MakeLexer(int fd) const;
+    // Передаёт пакет читателю, ожидая места в очереди. Возвращает false, если читатель
+    // завершил работу
+    bool Push(Batch&& batch);
+    // Ожидает следующий пакет писателя
+    void Pop();
+    // Останавливает поток-писатель и дожидается его завершения. Писатель, ожидающий
+    // чтения дескриптора, будится записью в wake_write_
+    void Stop();
+
+    SpscRing<Batch, 64> ring_;
+    std::atomic<bool> stopped_{false};
+    // Ожидающая сторона спит на ring_changed_, а не занимает ядро: писатель - пока
+    // очередь заполнена, читатель - пока она пуста. Каждая вставка и извлечение будят
+    // другую сторону
+    std::mutex ring_mutex_;
+    std::condition_variable ring_changed_;
+
+    // канал для пробуждения писателя, ожидающего ввода из файлового дескриптора
+    int wake_read_ = -1;
+    int wake_write_ = -1;
+
+    Batch batch_;
+    size_t position_ = 0;
+    bool finished_ = false;
+
+    std::thread producer_;
+};
+
+}  // namespace parse
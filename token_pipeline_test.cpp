@@ -0,0 +1,129 @@
+#include "parse.h"
+#include "spsc_ring.h"
+#include "statement.h"
+#include "test_runner_p.h"
+#include "token_pipeline.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace std;
+
+namespace parse {
+
+namespace {
+
+void TestSpscRing() {
+    SpscRing<int, 4> ring;
+    ASSERT(!ring.TryPop().has_value());
+    for (int i = 0; i < 4; ++i) {
+        ASSERT(ring.TryPush(int{i}));
+    }
+    ASSERT(!ring.TryPush(4));
+    ASSERT_EQUAL(*ring.TryPop(), 0);
+    ASSERT(ring.TryPush(4));
+
+    // Значения доходят до читателя в том же порядке
+    SpscRing<int, 8> channel;
+    const int count = 100000;
+    thread writer([&channel] {
+        for (int i = 0; i < count; ++i) {
+            while (!channel.TryPush(int{i})) {
+                this_thread::yield();
+            }
+        }
+    });
+    int expected = 0;
+    bool ordered = true;
+    while (expected < count) {
+        if (auto value = channel.TryPop()) {
+            ordered = ordered && *value == expected;
+            ++expected;
+        } else {
+            this_thread::yield();
+        }
+    }
+    writer.join();
+    ASSERT(ordered);
+}
+
+void TestPipelineMatchesLexer() {
+    string source;
+    for (int i = 0; i < 500; ++i) {
+        source += "class C"s + to_string(i) + ":\n  def f(x):\n    return x + 'a'\n\n"s;
+    }
+    istringstream pipeline_input(source);
+    TokenPipeline pipeline(pipeline_input);
+    Lexer lexer(string_view{source});
+
+    size_t count = 0;
+    while (true) {
+        ASSERT_EQUAL(pipeline.CurrentToken(), lexer.CurrentToken());
+        ++count;
+        if (lexer.CurrentToken().Is<token_type::Eof>()) {
+            break;
+        }
+        pipeline.NextToken();
+        lexer.NextToken();
+    }
+    ASSERT(count > TokenPipeline::BATCH_SIZE * 4);
+    ASSERT_EQUAL(pipeline.NextToken(), Token(token_type::Eof{}));
+}
+
+void TestPipelineErrors() {
+    // Ошибка лексического анализа выбрасывается там, где её встретил бы анализатор
+    istringstream input("x = 1\ny = 'broken\n"s);
+    TokenPipeline pipeline(input);
+    ASSERT_EQUAL(pipeline.CurrentToken(), Token(token_type::Id{"x"s}));
+    for (int i = 0; i < 4; ++i) {
+        pipeline.NextToken();
+    }
+    ASSERT_EQUAL(pipeline.CurrentToken(), Token(token_type::Id{"y"s}));
+    pipeline.ExpectNext<token_type::Char>('=');
+    ASSERT_THROWS(pipeline.NextToken(), LexerError);
+
+    // Конвейер корректно останавливается, если разбор прекращён раньше конца текста
+    string long_source;
+    for (int i = 0; i < 100000; ++i) {
+        long_source += "x = 1\n"s;
+    }
+    istringstream long_input(long_source);
+    auto stop_early = [&long_input] {
+        TokenPipeline tokens(long_input);
+        tokens.NextToken();
+    };
+    ASSERT_DOESNT_THROW(stop_early());
+
+    istringstream bad_program("x = (1\n"s);
+    TokenPipeline tokens(bad_program);
+    ASSERT_THROWS(ParseProgram(tokens, ParseOptions{}), ParseError);
+}
+
+void TestPipelineOnOpenPipe() {
+    // Синтаксическая ошибка сообщается, не дожидаясь закрытия канала: писатель передаёт
+    // разобранные строки до конца текста, а остановка конвейера прерывает ожидание ввода
+    int fds[2];
+    ASSERT_EQUAL(pipe(fds), 0);
+    const string source = "x = 1\nprint x +\n"s;
+    ASSERT_EQUAL(write(fds[1], source.data(), source.size()), static_cast<ssize_t>(source.size()));
+    {
+        TokenPipeline tokens(fds[0]);
+        ASSERT_THROWS(ParseProgram(tokens, ParseOptions{}), ParseError);
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
+
+}  // namespace
+
+void RunTokenPipelineTests(TestRunner& tr) {
+    RUN_TEST(tr, TestSpscRing);
+    RUN_TEST(tr, TestPipelineMatchesLexer);
+    RUN_TEST(tr, TestPipelineErrors);
+    RUN_TEST(tr, TestPipelineOnOpenPipe);
+}
+
+}  // namespace parse